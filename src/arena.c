@@ -0,0 +1,131 @@
+/***************************************************************************************
+ * @file    arena.c
+ * @date    October 18th 2026
+ *
+ * @brief   Bump pointer arena. Allocations are carved from large blocks and
+ *          are never freed individually; releasing the arena returns every
+ *          block to the heap at once. When a block fills up a larger one is
+ *          chained in front of it.
+ *
+ ****************************************************************************************/
+
+#include <stdlib.h>
+
+#include "main.h"
+#include "arena.h"
+
+//********************* Local function prototypes ****************************//
+STATIC arenaBlock_t* addBlock(arena_t* arena, size_t size);
+
+//************************* Function pointers ********************************//
+STATIC void* (*blockMalloc_ptr)(size_t) = malloc;     //function ptr for mocking
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Arena initialization
+ **     Take the first block from the heap
+ **
+ ** @param arena: arena to initialize
+ ** @param size: expected number of bytes to be allocated
+ **
+ ** @return error code
+******************************************************************************/
+error_t ARN_init(arena_t* arena, size_t size)
+{
+    arena->head = NULL;
+    arena->blockSize = (size > ARN_MIN_BLOCK) ? size : ARN_MIN_BLOCK;
+    arena->allocated = 0;
+    arena->blocks = 0;
+    
+    if(!addBlock(arena, arena->blockSize))
+    {
+        return ERR_mem;
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Arena allocation
+ **     Allocate aligned memory from the arena, adding a block if the current
+ **     one is full
+ **
+ ** @param arena: arena to allocate from
+ ** @param size: number of bytes
+ **
+ ** @return allocated memory, NULL if a block could not be added
+******************************************************************************/
+void* ARN_alloc(arena_t* arena, size_t size)
+{
+    arenaBlock_t* block = arena->head;
+    void* memory;
+    
+    //round up so the next allocation stays aligned
+    size = (size + ARN_ALIGN - 1) & ~(ARN_ALIGN - 1);
+    
+    if(!block || (block->size - block->used < size))
+    {
+        //grow geometrically so a badly sized arena needs few blocks
+        arena->blockSize *= 2;
+        block = addBlock(arena, (size > arena->blockSize) ? size : arena->blockSize);
+        if(!block)
+        {
+            return NULL;
+        }
+    }
+    
+    memory = &block->data[block->used];
+    block->used += size;
+    arena->allocated += size;
+    
+    return memory;
+}
+
+ /*****************************************************************************
+ ** @brief Arena release
+ **     Return every block to the heap, invalidating all allocations
+ **
+ ** @param arena: arena to release
+ **
+ ** @return none
+******************************************************************************/
+void ARN_release(arena_t* arena)
+{
+    arenaBlock_t* block;
+    while(arena->head)
+    {
+        block = arena->head;
+        arena->head = block->next;
+        free(block);
+    }
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Add block
+ **     Take a block from the heap and make it the one allocations come from
+ **
+ ** @param arena: arena to grow
+ ** @param size: usable bytes in the block
+ **
+ ** @return new block, NULL if out of memory
+******************************************************************************/
+STATIC arenaBlock_t* addBlock(arena_t* arena, size_t size)
+{
+    arenaBlock_t* block = blockMalloc_ptr(sizeof(arenaBlock_t) + size);
+    
+    if(!block)
+    {
+        return NULL;
+    }
+    
+    block->next = arena->head;
+    block->size = size;
+    block->used = 0;
+    arena->head = block;
+    arena->blocks++;
+    
+    return block;
+}
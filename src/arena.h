@@ -0,0 +1,44 @@
+/***************************************************************************************
+ * @file    arena.h
+ * @date    October 18th 2026
+ *
+ * @brief   Bump pointer arena header
+ *
+ ****************************************************************************************/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+
+#include "main.h"
+
+#define ARN_ALIGN               _Alignof(max_align_t)   //alignment of every allocation
+#define ARN_MIN_BLOCK           4096                    //smallest block taken from the heap
+
+//block of memory carved up by an arena
+typedef struct arenablock
+{
+    struct arenablock* next;        //previously filled block
+    size_t size;                    //usable bytes in the block
+    size_t used;                    //bytes handed out from the block
+    _Alignas(max_align_t) unsigned char data[];
+} arenaBlock_t;
+
+//allocator whose memory is all released at once
+typedef struct arena
+{
+    arenaBlock_t* head;             //block allocations are taken from
+    size_t blockSize;               //size of the next block added when the head is full
+    size_t allocated;               //bytes handed out since the arena was initialized
+    uint32_t blocks;                //blocks taken from the heap
+} arena_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t ARN_init(arena_t* arena, size_t size);
+void* ARN_alloc(arena_t* arena, size_t size);
+void ARN_release(arena_t* arena);
+
+
+#endif //_ARENA_H_
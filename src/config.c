@@ -5,200 +5,1742 @@
  * @brief   Configuration management for an intersection
  *
  ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for fileno, fstat and mmap
 
 #include <strings.h>
+#include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "main.h"
 #include "config.h"
+#include "configParser.h"
+#include "configFleet.h"
+#include "configCache.h"
+#include "arena.h"
+#include "image.h"
+#include "patternPool.h"
 #include "cJSON/cJSON.h"
 
-//*********************** Static variables ***********************************//
-STATIC lightSet_t lightConfigs[INT_DIRECTIONS] = UNUSED_CONFIG;     //intersection config source of truth
-
 //********************* Local function prototypes ****************************//
-STATIC error_t parseConfig(const char* json);
-STATIC error_t parseDirection(const cJSON* direction);
+STATIC error_t loadConfig(intConfig_t* config, const char* filepath, bool fallback, bool map);
+STATIC error_t readConfigFile(FILE* file, size_t fileSize, char** json, size_t* length);
+STATIC error_t loadImage(intConfig_t* config, const void* image, size_t length);
+STATIC error_t parseConfigTree(intConfig_t* config, const char* json, size_t length);
+STATIC void installArenaHooks(void);
+STATIC void* arenaMalloc(size_t size);
+STATIC void arenaFree(void* pointer);
+STATIC error_t streamConfig(intConfig_t* config, const char* json, size_t length);
+STATIC error_t streamRootMember(cfgStream_t* stream, const char* key);
+STATIC error_t streamFleetMember(cfgStream_t* stream, const char* key);
+STATIC error_t streamDirection(cfgStream_t* stream, uint32_t index);
+STATIC error_t streamDirectionMember(cfgStream_t* stream, const char* key);
+STATIC error_t streamLight(cfgStream_t* stream, uint32_t index);
+STATIC error_t streamStep(cfgStream_t* stream, uint32_t index);
+STATIC error_t streamStepMember(cfgStream_t* stream, const char* key);
+STATIC error_t streamObject(cfgStream_t* stream, cfgMemberHandler_t handler);
+STATIC error_t streamArray(cfgStream_t* stream, cfgElementHandler_t handler);
+STATIC error_t streamString(cfgStream_t* stream, char* buffer, size_t size, size_t* decoded);
+STATIC error_t streamCodePoint(cfgStream_t* stream, uint32_t* codePoint);
+STATIC error_t streamNumber(cfgStream_t* stream, double* number);
+STATIC error_t skipValue(cfgStream_t* stream);
+STATIC void skipWhitespace(cfgStream_t* stream);
+STATIC char peekByte(cfgStream_t* stream);
+STATIC bool consumeByte(cfgStream_t* stream, char expected);
+STATIC bool setFormatError(cfgStream_t* stream);
+STATIC bool claimKey(cfgStream_t* stream, cfgKey_t id, const char* key);
+STATIC error_t skipUnknownKey(cfgStream_t* stream, const char* key);
+STATIC void printParseError(const char* json, size_t length, const char* errorPtr);
+STATIC void assignStep(lightSetStep_t* steps, uint8_t stepIdx, lightSetState_t stepState, int time);
+STATIC int getTimeFromNumber(double number);
+STATIC error_t getMembers(const cJSON* object, const cJSON* members[CK_unknown], uint32_t keys);
+STATIC error_t parseDirection(intConfig_t* config, const cJSON* direction);
 STATIC error_t parseLights(lightSet_t* lightConfig, const cJSON* lights);
 STATIC error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps);
+STATIC cfgKey_t getKeyFromString(const char* key);
 STATIC intDirection_t getDirectionIdxFromString(char* dir);
 STATIC lightDisplayType_t getLightTypeFromString(char* type);
 STATIC lightSetState_t getStepStateFromString(char* state);
+STATIC char toLowerAscii(char c);
 
 //************************* Function pointers ********************************//
 STATIC void* (*malloc_ptr)(size_t) = malloc;                        //function ptr for mocking
 STATIC size_t (*fread_ptr)(void*, size_t, size_t, FILE*) = fread;   //function ptr for mocking
+STATIC void* (*mmap_ptr)(void*, size_t, int, int, int, off_t) = mmap;  //function ptr for mocking
+
+//*********************** Global variables ***********************************//
+const setPattern_t CFG_advGreenPattern = PATTERN_ADV_GRN;   //pattern of the default light sets
+
+//************************* Local variables **********************************//
+#ifdef STATIC_CONFIG
+STATIC const intConfig_t* const defaultConfig = &CFG_staticConfig;    //config generated at build time
+#else
+STATIC const intConfig_t builtInConfig = {.lightSets = DEFAULT_CONFIG};
+STATIC const intConfig_t* const defaultConfig = &builtInConfig;      //config used without a valid config file
+#endif
+STATIC cfgParser_t configParser = CP_stream;    //parser used by CFG_init
+STATIC _Thread_local arena_t* parseArena = NULL; //arena backing cJSON allocations of this thread's tree parse
+static pthread_once_t arenaHooksOnce = PTHREAD_ONCE_INIT;
+
+//************************ Public functions *********************************//
+ 
+ /*****************************************************************************
+ ** @brief Configuration initialization
+ **     Init the stored config with the contents of the provided file path, if
+ **     loading of that config fails, use default values. The file may be a
+ **     JSON config or a precompiled image.
+ **
+ ** @param config: intersection config to initialize
+ ** @param filepath: path to config file, NULL to use the defaults
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_init(intConfig_t* config, char* filepath)
+{
+    return loadConfig(config, filepath, true, true);
+}
+
+ /*****************************************************************************
+ ** @brief Load configuration
+ **     Load the contents of the provided file path into the config, leaving
+ **     whatever was loaded on failure instead of using default values. The
+ **     file is read into a buffer rather than mapped, as a file being edited
+ **     live can be truncated while it is parsed, which would fault a mapping.
+ **
+ ** @param config: intersection config to load into
+ ** @param filepath: path to config file
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_load(intConfig_t* config, const char* filepath)
+{
+    return loadConfig(config, filepath, false, false);
+}
+
+ /*****************************************************************************
+ ** @brief Validate configuration
+ **     Check that a loaded config can be run: every used pattern has an end
+ **     step and each direction pair has at least one used pattern. Parsing
+ **     alone does not check either.
+ **
+ ** @param config: intersection config to check
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_validate(const intConfig_t* config)
+{
+    const lightSet_t* set;
+    bool used[INT_DIRECTIONS];
+    bool ended;
+    
+    for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+    {
+        set = &config->lightSets[direction];
+        used[direction] = (set->pattern->count != 0);
+        
+        ended = !used[direction];
+        for(uint8_t i = 0; (i < set->pattern->count) && !ended; i++)
+        {
+            ended = (set->pattern->states[i] == LSS_end);
+        }
+        if(!ended)
+        {
+            printf("Pattern %u has no end step\n", direction);
+            return ERR_format;
+        }
+    }
+    
+    if(!(used[ID_north] || used[ID_south]) || !(used[ID_east] || used[ID_west]))
+    {
+        printf("Config leaves a direction pair without a pattern\n");
+        return ERR_value;
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Apply configuration
+ **     Copy the lights and pattern of every direction from an updated config,
+ **     leaving the step each set starts from alone. Only safe between
+ **     patterns, when no set is part way through its steps.
+ **
+ ** @param config: intersection config in use
+ ** @param update: updated config
+ **
+ ** @return none
+******************************************************************************/
+void CFG_apply(intConfig_t* config, const intConfig_t* update)
+{
+    for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+    {
+        memcpy(config->lightSets[direction].lights, update->lightSets[direction].lights, sizeof(config->lightSets[direction].lights));
+        config->lightSets[direction].pattern = update->lightSets[direction].pattern;
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Set config parser
+ **     Select the parser used for configs loaded from then on
+ **
+ ** @param parser: streaming parser (default) or cJSON document tree
+ **
+ ** @return none
+******************************************************************************/
+void CFG_setParser(cfgParser_t parser)
+{
+    configParser = parser;
+}
+
+ /*****************************************************************************
+ ** @brief Load default config values
+ **     Load the built in config, or the config generated from JSON at build
+ **     time in builds with STATIC_CONFIG
+ **
+ ** @param config: intersection config to reset
+ **
+ ** @return none
+******************************************************************************/
+void CFG_loadDefaults(intConfig_t* config)
+{
+    *config = *defaultConfig;
+}
+
+ /*****************************************************************************
+ ** @brief Get a light set
+ **     Get the saved configation for a given direction
+ **
+ ** @param config: intersection config
+ ** @param direction: direction of requested light set
+ **
+ ** @return pointer to light set
+******************************************************************************/
+lightSet_t* CFG_getLightSet(intConfig_t* config, intDirection_t direction)
+{
+    if(!config || (direction >= ID_numDirections))
+    {
+        return NULL;
+    }
+    
+    return &config->lightSets[direction];
+}
+
+ /*****************************************************************************
+ ** @brief Open config file
+ **     Get the contents of a config file. Regular files are mapped and parsed
+ **     in place if asked to; other files, or files that cannot be mapped, are
+ **     read into a buffer. A mapping faults if the file shrinks under it, so
+ **     only files that are not being edited should be mapped.
+ **
+ ** @param filepath: path to config file
+ ** @param map: map regular files instead of reading them into a buffer
+ ** @param contents: destination for the contents, released with CFG_closeFile
+ ** @param length: destination for the length of the contents
+ ** @param mapped: destination for whether the contents are mapped
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_openFile(const char* filepath, bool map, char** contents, size_t* length, bool* mapped)
+{
+    FILE* file;
+    struct stat info;
+    size_t fileSize = 0;
+    error_t result;
+    
+    *contents = NULL;
+    *length = 0;
+    *mapped = false;
+    
+    //open file
+    file = fopen(filepath, "r");
+    if(!file)
+    {
+        printf("Failed to open %s\n", filepath);
+        return ERR_file;
+    }
+
+    //map regular files; the mapping stays valid once the file is closed
+    if(!fstat(fileno(file), &info) && S_ISREG(info.st_mode) && (info.st_size > 0))
+    {
+        fileSize = (size_t)info.st_size;
+    }
+    if(map && fileSize)
+    {
+        *contents = mmap_ptr(NULL, fileSize, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+        if(*contents != MAP_FAILED)
+        {
+            posix_madvise(*contents, fileSize, POSIX_MADV_SEQUENTIAL);
+            *length = fileSize;
+            *mapped = true;
+        }
+    }
+    
+    if(!*mapped)
+    {
+        result = readConfigFile(file, fileSize, contents, length);
+        if(result != ERR_success)
+        {
+            fclose(file);
+            return result;
+        }
+    }
+
+    fclose(file);
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Close config file
+ **     Release the contents returned by CFG_openFile
+ **
+ ** @param contents: contents of the config file
+ ** @param length: length of the contents
+ ** @param mapped: whether the contents are mapped
+ **
+ ** @return none
+******************************************************************************/
+void CFG_closeFile(char* contents, size_t length, bool mapped)
+{
+    if(mapped)
+    {
+        munmap(contents, length);
+    }
+    else
+    {
+        free(contents);
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Parse a JSON string
+ **     Extract an intersection configuration from the provided JSON buffer,
+ **     which does not have to be null terminated, with the selected parser.
+ **     Any deviation from the expected format will result in a failure.
+ **
+ ** @param config: intersection config into which the directions should be saved
+ ** @param json: json buffer containing an intersection config
+ ** @param length: length of the json buffer
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_parse(intConfig_t* config, const char* json, size_t length)
+{
+    if(configParser == CP_tree)
+    {
+        return parseConfigTree(config, json, length);
+    }
+    
+    return streamConfig(config, json, length);
+}
+
+ /*****************************************************************************
+ ** @brief Stream fleet entry
+ **     Parse one intersection of a fleet config, which must be the whole
+ **     buffer
+ **
+ ** @param config: intersection config into which the directions should be saved
+ ** @param name: destination for the intersection name, CFG_MAX_NAME bytes
+ ** @param json: json buffer containing the intersection's object
+ ** @param length: length of the json buffer
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_streamFleetEntry(intConfig_t* config, char* name, const char* json, size_t length)
+{
+    cfgStream_t stream = {.json = json, .length = length, .result = ERR_success, .config = config, .name = name};
+    error_t result;
+    
+    if(peekByte(&stream) == '{')
+    {
+        result = streamObject(&stream, streamFleetMember);
+    }
+    else
+    {
+        //valid JSON, but not an object
+        result = skipValue(&stream);
+        if((result == ERR_success) && setFormatError(&stream))
+        {
+            printf("Fleet intersection is not an object!\n");
+        }
+    }
+    
+    //values run together without a comma
+    skipWhitespace(&stream);
+    if((result == ERR_success) && (stream.offset < length))
+    {
+        result = ERR_json;
+    }
+    
+    if(result != ERR_success)
+    {
+        printParseError(json, length, json + stream.offset);
+        return result;
+    }
+    
+    if(!(stream.seen & CFG_SEEN_INTERSECTION) && setFormatError(&stream))
+    {
+        printf("Failed to extract intersection array object!\n");
+    }
+    
+    return stream.result;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Load config file
+ **     Load the contents of the provided file path into the config. The file
+ **     may be a JSON config or a precompiled image, and is mapped or read as
+ **     CFG_openFile() does. JSON is parsed over unused light sets
+ **     and then applied, with or without the cache, so the result does not
+ **     depend on what the config held before.
+ **
+ ** @param config: intersection config to load into
+ ** @param filepath: path to config file
+ ** @param fallback: use default values if the contents cannot be loaded
+ ** @param map: map regular files instead of reading them into a buffer
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t loadConfig(intConfig_t* config, const char* filepath, bool fallback, bool map)
+{
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t parsed;
+    char* contents;
+    size_t length;
+    bool mapped;
+    error_t result;
+    
+    //without a file, the defaults are the config
+    if(!filepath)
+    {
+        if(!fallback)
+        {
+            return ERR_file;
+        }
+        CFG_loadDefaults(config);
+        return ERR_success;
+    }
+    
+    result = CFG_openFile(filepath, map, &contents, &length, &mapped);
+    if(result == ERR_success)
+    {
+        //precompiled images are copied in without parsing
+        if(IMG_isImage(contents, length))
+        {
+            result = loadImage(config, contents, length);
+        }
+        else
+        {
+            parsed = unusedConfig;
+            result = CFG_loadCached(&parsed, contents, length);
+            if(result == ERR_success)
+            {
+                CFG_apply(config, &parsed);
+            }
+        }
+        
+        CFG_closeFile(contents, length, mapped);
+    }
+    
+    if((result != ERR_success) && fallback)
+    {
+        printf("Failed to load config, using default values\n");
+        CFG_loadDefaults(config);
+    }
+    
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Read config file
+ **     Read a config file into a newly allocated buffer. Files of a known
+ **     size are read in one go; streams are read in growing chunks until EOF.
+ **
+ ** @param file: open config file
+ ** @param fileSize: size of the file, 0 if unknown
+ ** @param json: destination for the buffer, to be freed by the caller
+ ** @param length: destination for the number of bytes read
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t readConfigFile(FILE* file, size_t fileSize, char** json, size_t* length)
+{
+    size_t capacity = fileSize ? fileSize : CFG_READ_CHUNK;
+    size_t readBytes;
+    char* buffer;
+    char* grown;
+    
+    //malloc space for file contents
+    buffer = (char *)malloc_ptr(capacity + 1);  // +1 for null terminator
+    if(!buffer)
+    {
+        printf("Failed to allocate memory for JSON content\n");
+        return ERR_mem;
+    }
+    
+    if(fileSize)
+    {
+        readBytes = fread_ptr(buffer, 1, fileSize, file);
+        if(readBytes != fileSize)
+        {
+            printf("Failed to read all bytes from file (%zu of %zu)\n", readBytes, fileSize);
+            free(buffer);
+            return ERR_other;
+        }
+    }
+    else
+    {
+        readBytes = 0;
+        while(1)
+        {
+            readBytes += fread_ptr(buffer + readBytes, 1, capacity - readBytes, file);
+            if(readBytes < capacity)
+            {
+                break;
+            }
+            
+            //buffer full; grow it and keep reading
+            capacity *= 2;
+            grown = realloc(buffer, capacity + 1);
+            if(!grown)
+            {
+                printf("Failed to allocate memory for JSON content\n");
+                free(buffer);
+                return ERR_mem;
+            }
+            buffer = grown;
+        }
+        if(ferror(file))
+        {
+            printf("Failed to read from file\n");
+            free(buffer);
+            return ERR_other;
+        }
+    }
+    
+    //null terminate the resulting string, just in case
+    buffer[readBytes] = '\0';
+    *json = buffer;
+    *length = readBytes;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Load image
+ **     Copy the intersection of a precompiled image into the config. Images
+ **     of several intersections are fleets, loaded with CFG_loadFleet().
+ **
+ ** @param config: intersection config into which the light sets are saved
+ ** @param image: image contents
+ ** @param length: length of the image
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t loadImage(intConfig_t* config, const void* image, size_t length)
+{
+    uint32_t count;
+    error_t result;
+    
+    result = IMG_check(image, length, &count);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    if(count != 1)
+    {
+        printf("Image holds %u intersections, not one\n", count);
+        return ERR_value;
+    }
+    
+    return IMG_decode(image, 0, config);
+}
+
+ /*****************************************************************************
+ ** @brief Parse a JSON tree
+ **     Build a cJSON tree from the JSON buffer, then extract an intersection
+ **     configuration from it. The tree is built in an arena sized from the
+ **     buffer length and released in one go, without walking the tree.
+ **
+ ** @param config: intersection config into which the directions should be saved
+ ** @param json: json buffer containing an intersection config
+ ** @param length: length of the json buffer
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t parseConfigTree(intConfig_t* config, const char* json, size_t length)
+{
+    error_t result = ERR_success;
+    arena_t arena;                      //memory of the cJSON tree
+    cJSON* root;                        //json root object
+    const cJSON* intersection = NULL;   //intersection object
+    const cJSON* direction = NULL;      //direction object
+    const cJSON* members[CK_unknown];   //root members by key
+    
+    pthread_once(&arenaHooksOnce, installArenaHooks);
+    if(ARN_init(&arena, length * CFG_ARENA_RATIO) != ERR_success)
+    {
+        printf("Failed to allocate memory for JSON content\n");
+        return ERR_mem;
+    }
+    parseArena = &arena;
+    
+    //convert JSON buffer to cJSON object
+    root = cJSON_ParseWithLength(json, length);
+    if (!root) 
+    {
+        printParseError(json, length, cJSON_GetErrorPtr());
+        result = ERR_json;
+    }
+    else
+    {
+        //get intersection object
+        result = getMembers(root, members, CFG_SEEN_INTERSECTION);
+        intersection = members[CK_intersection];
+        if(result != ERR_success)
+        {
+            //duplicate key
+        }
+        else if(!cJSON_IsArray(intersection))
+        {
+            printf("Failed to extract intersection array object!\n");
+            result = ERR_format;
+        }
+        else
+        {
+            //for each direction in intersection...
+            cJSON_ArrayForEach(direction, intersection)
+            {
+                result = parseDirection(config, direction);
+                if(result != ERR_success)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    
+    //free memory for cJSON object
+    parseArena = NULL;
+    ARN_release(&arena);
+    
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Install arena hooks
+ **     Route cJSON's allocations through the arena of the calling thread.
+ **     Run once; the hooks are shared by every thread.
+ **
+ ** @return none
+******************************************************************************/
+STATIC void installArenaHooks(void)
+{
+    cJSON_Hooks hooks = {.malloc_fn = arenaMalloc, .free_fn = arenaFree};
+    
+    cJSON_InitHooks(&hooks);
+}
+
+ /*****************************************************************************
+ ** @brief Arena malloc
+ **     cJSON allocation hook; uses the heap outside of a tree parse
+ **
+ ** @param size: number of bytes
+ **
+ ** @return allocated memory
+******************************************************************************/
+STATIC void* arenaMalloc(size_t size)
+{
+    if(parseArena)
+    {
+        return ARN_alloc(parseArena, size);
+    }
+    
+    return malloc(size);
+}
+
+ /*****************************************************************************
+ ** @brief Arena free
+ **     cJSON free hook; memory from the arena is released with the arena, so
+ **     cJSON_Delete does nothing during a tree parse
+ **
+ ** @param pointer: memory to free
+ **
+ ** @return none
+******************************************************************************/
+STATIC void arenaFree(void* pointer)
+{
+    if(!parseArena)
+    {
+        free(pointer);
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Stream a JSON config
+ **     Extract an intersection configuration in a single pass over the JSON
+ **     buffer, without building a tree or allocating memory. Directions are
+ **     saved to the config as soon as their object closes. After a format
+ **     error the rest of the buffer is only checked for valid JSON, so
+ **     ERR_json and ERR_format are reported as they are by the tree parser.
+ **
+ ** @param config: intersection config into which the directions should be saved
+ ** @param json: json buffer containing an intersection config
+ ** @param length: length of the json buffer
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t streamConfig(intConfig_t* config, const char* json, size_t length)
+{
+    cfgStream_t stream = {.json = json, .length = length, .result = ERR_success, .config = config};
+    error_t result;
+    
+    //skip the UTF-8 byte order mark
+    if((length > 3) && !memcmp(json, "\xEF\xBB\xBF", 3))
+    {
+        stream.offset = 3;
+    }
+    
+    skipWhitespace(&stream);
+    if(peekByte(&stream) == '{')
+    {
+        result = streamObject(&stream, streamRootMember);
+    }
+    else
+    {
+        //valid JSON, but not an object
+        result = skipValue(&stream);
+        if((result == ERR_success) && setFormatError(&stream))
+        {
+            printf("Failed to extract intersection array object!\n");
+        }
+    }
+    
+    if(result != ERR_success)
+    {
+        printParseError(json, length, json + stream.offset);
+        return result;
+    }
+    
+    if(!(stream.seen & CFG_SEEN_INTERSECTION) && setFormatError(&stream))
+    {
+        printf("Failed to extract intersection array object!\n");
+    }
+    
+    return stream.result;
+}
+
+ /*****************************************************************************
+ ** @brief Stream root member
+ **     Handle a member of the root object; only the intersection array is used
+ **
+ ** @param stream: streaming parser, positioned at the member value
+ ** @param key: member key
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamRootMember(cfgStream_t* stream, const char* key)
+{
+    cfgKey_t id = getKeyFromString(key);
+    
+    if(id != CK_intersection)
+    {
+        return skipUnknownKey(stream, key);
+    }
+    if(!claimKey(stream, id, key))
+    {
+        return skipValue(stream);
+    }
+    
+    if(peekByte(stream) != '[')
+    {
+        setFormatError(stream);
+        printf("Failed to extract intersection array object!\n");
+        return skipValue(stream);
+    }
+    
+    return streamArray(stream, streamDirection);
+}
+
+ /*****************************************************************************
+ ** @brief Stream fleet member
+ **     Handle a member of a fleet intersection: its name, or any member of the
+ **     single intersection root object
+ **
+ ** @param stream: streaming parser, positioned at the member value
+ ** @param key: member key
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamFleetMember(cfgStream_t* stream, const char* key)
+{
+    cfgKey_t id = getKeyFromString(key);
+    
+    if(id != CK_name)
+    {
+        return streamRootMember(stream, key);
+    }
+    if(!claimKey(stream, id, key))
+    {
+        return skipValue(stream);
+    }
+    
+    if(peekByte(stream) != '"')
+    {
+        setFormatError(stream);
+        printf("Intersection name not a string!\n");
+        return skipValue(stream);
+    }
+    
+    //long names are truncated
+    return streamString(stream, stream->name, CFG_MAX_NAME, NULL);
+}
+
+ /*****************************************************************************
+ ** @brief Stream direction
+ **     Parse a direction object and save it to the config once it closes
+ **
+ ** @param stream: streaming parser, positioned at the direction
+ ** @param index: index of the direction in the intersection array
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamDirection(cfgStream_t* stream, uint32_t index)
+{
+    lightSet_t* lightConfig;
+    const setPattern_t* pattern;
+    error_t result;
+    
+    (void)index;
+    
+    if(peekByte(stream) != '{')
+    {
+        setFormatError(stream);
+        printf("Direction value not a string!\n");
+        return skipValue(stream);
+    }
+    
+    stream->seen &= ~(CFG_SEEN_DIRECTION | CFG_SEEN_LIGHTS | CFG_SEEN_STEPS);
+    stream->lightCount = 0;
+    stream->stepCount = 0;
+    
+    result = streamObject(stream, streamDirectionMember);
+    if((result != ERR_success) || (stream->result != ERR_success))
+    {
+        return result;
+    }
+    
+    //check for missing keys
+    if(!(stream->seen & CFG_SEEN_DIRECTION))
+    {
+        setFormatError(stream);
+        printf("Direction value not a string!\n");
+        return ERR_success;
+    }
+    if(!(stream->seen & CFG_SEEN_LIGHTS))
+    {
+        setFormatError(stream);
+        printf("Invalid light config array\n");
+        return ERR_success;
+    }
+    if(!(stream->seen & CFG_SEEN_STEPS))
+    {
+        setFormatError(stream);
+        printf("Invalid step config array\n");
+        return ERR_success;
+    }
+    
+    pattern = PAT_intern(PAT_getDefault(), stream->steps, stream->stepCount);
+    if(!pattern)
+    {
+        stream->result = ERR_mem;
+        return ERR_success;
+    }
+    
+    //save the lights that were given, leaving the rest as they were, and the pattern of exactly the given steps
+    lightConfig = &stream->config->lightSets[stream->direction];
+    memcpy(lightConfig->lights, stream->lights, stream->lightCount * sizeof(light_t));
+    lightConfig->pattern = pattern;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stream direction member
+ **     Handle a member of a direction object
+ **
+ ** @param stream: streaming parser, positioned at the member value
+ ** @param key: member key
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamDirectionMember(cfgStream_t* stream, const char* key)
+{
+    char value[CFG_MAX_TOKEN];
+    size_t length;
+    error_t result;
+    cfgKey_t id = getKeyFromString(key);
+    
+    if((id != CK_direction) && (id != CK_lights) && (id != CK_steps))
+    {
+        return skipUnknownKey(stream, key);
+    }
+    if(!claimKey(stream, id, key))
+    {
+        return skipValue(stream);
+    }
+    
+    switch(id)
+    {
+        case CK_direction:
+            if(peekByte(stream) != '"')
+            {
+                setFormatError(stream);
+                printf("Direction value not a string!\n");
+                return skipValue(stream);
+            }
+            
+            result = streamString(stream, value, sizeof(value), &length);
+            if(result != ERR_success)
+            {
+                return result;
+            }
+            
+            //convert heading to index value
+            stream->direction = (length < sizeof(value)) ? getDirectionIdxFromString(value) : ID_numDirections;
+            if(stream->direction >= ID_numDirections)
+            {
+                setFormatError(stream);
+                printf("Invalid direction string: %s\n", value);
+            }
+            return ERR_success;
+            
+        case CK_lights:
+            if(peekByte(stream) != '[')
+            {
+                setFormatError(stream);
+                printf("Invalid light config array\n");
+                return skipValue(stream);
+            }
+            return streamArray(stream, streamLight);
+            
+        default:
+            if(peekByte(stream) != '[')
+            {
+                setFormatError(stream);
+                printf("Invalid step config array\n");
+                return skipValue(stream);
+            }
+            return streamArray(stream, streamStep);
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Stream light
+ **     Parse a light type from the lights array
+ **
+ ** @param stream: streaming parser, positioned at the light
+ ** @param index: index of the light in the lights array
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamLight(cfgStream_t* stream, uint32_t index)
+{
+    char value[CFG_MAX_TOKEN];
+    error_t result;
+    
+    //check light index
+    if(index >= MAX_LIGHTS_IN_SET)
+    {
+        setFormatError(stream);
+        printf("Logic only supports %u lights per set\n", MAX_LIGHTS_IN_SET);
+        return skipValue(stream);
+    }
+    
+    //check value format
+    if(peekByte(stream) != '"')
+    {
+        setFormatError(stream);
+        printf("Light %u type value not a string!\n", index);
+        return skipValue(stream);
+    }
+    
+    //only the first character of the type is used
+    result = streamString(stream, value, sizeof(value), NULL);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
+    stream->lights[index].type = getLightTypeFromString(value);
+    stream->lights[index].state = LS_red;
+    stream->lightCount = index + 1;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stream step
+ **     Parse a step object from the steps array
+ **
+ ** @param stream: streaming parser, positioned at the step
+ ** @param index: index of the step in the steps array
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamStep(cfgStream_t* stream, uint32_t index)
+{
+    error_t result;
+    
+    //check steps index
+    if(index >= MAX_STEPS_IN_PATTERN)
+    {
+        setFormatError(stream);
+        printf("Logic only supports %u steps per pattern\n", MAX_STEPS_IN_PATTERN);
+        return skipValue(stream);
+    }
+    
+    if(peekByte(stream) != '{')
+    {
+        setFormatError(stream);
+        printf("Step state value not a string!\n");
+        return skipValue(stream);
+    }
+    
+    stream->seen &= ~(CFG_SEEN_STATE | CFG_SEEN_TIME);
+    
+    result = streamObject(stream, streamStepMember);
+    if((result != ERR_success) || (stream->result != ERR_success))
+    {
+        return result;
+    }
+    
+    //check for missing keys
+    if(!(stream->seen & CFG_SEEN_STATE))
+    {
+        setFormatError(stream);
+        printf("Step state value not a string!\n");
+        return ERR_success;
+    }
+    if(!(stream->seen & CFG_SEEN_TIME))
+    {
+        setFormatError(stream);
+        printf("Step time value not a number!\n");
+        return ERR_success;
+    }
+    
+    assignStep(stream->steps, (uint8_t)index, stream->stepState, getTimeFromNumber(stream->stepTime));
+    stream->stepCount = index + 1;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stream step member
+ **     Handle a member of a step object
+ **
+ ** @param stream: streaming parser, positioned at the member value
+ ** @param key: member key
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t streamStepMember(cfgStream_t* stream, const char* key)
+{
+    char value[CFG_MAX_TOKEN];
+    size_t length;
+    char first;
+    error_t result;
+    cfgKey_t id = getKeyFromString(key);
+    
+    if((id != CK_state) && (id != CK_time))
+    {
+        return skipUnknownKey(stream, key);
+    }
+    if(!claimKey(stream, id, key))
+    {
+        return skipValue(stream);
+    }
+    
+    if(id == CK_state)
+    {
+        if(peekByte(stream) != '"')
+        {
+            setFormatError(stream);
+            printf("Step state value not a string!\n");
+            return skipValue(stream);
+        }
+        
+        result = streamString(stream, value, sizeof(value), &length);
+        if(result != ERR_success)
+        {
+            return result;
+        }
+        
+        stream->stepState = (length < sizeof(value)) ? getStepStateFromString(value) : LSS_unused;
+        if(stream->stepState >= LSS_unused)
+        {
+            setFormatError(stream);
+            printf("Invalid step state string: %s\n", value);
+        }
+        return ERR_success;
+    }
+    
+    first = peekByte(stream);
+    if((first != '-') && ((first < '0') || (first > '9')))
+    {
+        setFormatError(stream);
+        printf("Step time value not a number!\n");
+        return skipValue(stream);
+    }
+    return streamNumber(stream, &stream->stepTime);
+}
+
+ /*****************************************************************************
+ ** @brief Stream object
+ **     Parse an object, passing each member value to the handler. Values are
+ **     skipped when there is no handler or a format error has been found.
+ **
+ ** @param stream: streaming parser, positioned at the object
+ ** @param handler: callback for each member, may be NULL
+ **
+ ** @return ERR_json if the object is not valid JSON
+******************************************************************************/
+STATIC error_t streamObject(cfgStream_t* stream, cfgMemberHandler_t handler)
+{
+    char key[CFG_MAX_TOKEN];
+    size_t length;
+    error_t result;
+    
+    if(!consumeByte(stream, '{') || (++stream->depth > CJSON_NESTING_LIMIT))
+    {
+        return ERR_json;
+    }
+    
+    skipWhitespace(stream);
+    if(!consumeByte(stream, '}'))
+    {
+        do
+        {
+            skipWhitespace(stream);
+            if(peekByte(stream) != '"')
+            {
+                return ERR_json;
+            }
+            result = streamString(stream, key, sizeof(key), &length);
+            if(result != ERR_success)
+            {
+                return result;
+            }
+            
+            //keys too long to be stored cannot match any known key
+            if(length >= sizeof(key))
+            {
+                key[0] = '\0';
+            }
+            
+            skipWhitespace(stream);
+            if(!consumeByte(stream, ':'))
+            {
+                return ERR_json;
+            }
+            skipWhitespace(stream);
+            
+            if(handler && (stream->result == ERR_success))
+            {
+                result = handler(stream, key);
+            }
+            else
+            {
+                result = skipValue(stream);
+            }
+            if(result != ERR_success)
+            {
+                return result;
+            }
+            skipWhitespace(stream);
+        } while(consumeByte(stream, ','));
+        
+        if(!consumeByte(stream, '}'))
+        {
+            return ERR_json;
+        }
+    }
+    
+    stream->depth--;
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stream array
+ **     Parse an array, passing each element to the handler. Elements are
+ **     skipped when there is no handler or a format error has been found.
+ **
+ ** @param stream: streaming parser, positioned at the array
+ ** @param handler: callback for each element, may be NULL
+ **
+ ** @return ERR_json if the array is not valid JSON
+******************************************************************************/
+STATIC error_t streamArray(cfgStream_t* stream, cfgElementHandler_t handler)
+{
+    uint32_t index = 0;
+    error_t result;
+    
+    if(!consumeByte(stream, '[') || (++stream->depth > CJSON_NESTING_LIMIT))
+    {
+        return ERR_json;
+    }
+    
+    skipWhitespace(stream);
+    if(!consumeByte(stream, ']'))
+    {
+        do
+        {
+            skipWhitespace(stream);
+            if(handler && (stream->result == ERR_success))
+            {
+                result = handler(stream, index);
+            }
+            else
+            {
+                result = skipValue(stream);
+            }
+            if(result != ERR_success)
+            {
+                return result;
+            }
+            index++;
+            skipWhitespace(stream);
+        } while(consumeByte(stream, ','));
+        
+        if(!consumeByte(stream, ']'))
+        {
+            return ERR_json;
+        }
+    }
+    
+    stream->depth--;
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stream string
+ **     Parse a string, decoding it into the buffer. Strings that do not fit
+ **     are truncated. \u escapes outside of ASCII are stored as a single 0x80
+ **     byte, which cannot match any config token.
+ **
+ ** @param stream: streaming parser, positioned at the opening quote
+ ** @param buffer: destination for the null terminated string, may be NULL
+ ** @param size: size of the buffer
+ ** @param decoded: destination for the untruncated length, may be NULL
+ **
+ ** @return ERR_json if the string is not valid JSON
+******************************************************************************/
+STATIC error_t streamString(cfgStream_t* stream, char* buffer, size_t size, size_t* decoded)
+{
+    size_t count = 0;
+    uint32_t codePoint;
+    error_t result;
+    char c;
+    
+    if(!consumeByte(stream, '"'))
+    {
+        return ERR_json;
+    }
+    
+    while(1)
+    {
+        if(stream->offset >= stream->length)
+        {
+            return ERR_json;
+        }
+        c = stream->json[stream->offset++];
+        if(c == '"')
+        {
+            break;
+        }
+        
+        if(c == '\\')
+        {
+            if(stream->offset >= stream->length)
+            {
+                return ERR_json;
+            }
+            c = stream->json[stream->offset++];
+            switch(c)
+            {
+                case 'b':
+                    c = '\b';
+                    break;
+                case 'f':
+                    c = '\f';
+                    break;
+                case 'n':
+                    c = '\n';
+                    break;
+                case 'r':
+                    c = '\r';
+                    break;
+                case 't':
+                    c = '\t';
+                    break;
+                case '"':
+                case '\\':
+                case '/':
+                    break;
+                case 'u':
+                    result = streamCodePoint(stream, &codePoint);
+                    if(result != ERR_success)
+                    {
+                        return result;
+                    }
+                    c = (codePoint < 0x80) ? (char)codePoint : (char)0x80;
+                    break;
+                default:
+                    return ERR_json;
+            }
+        }
+        
+        if(buffer && (count < size - 1))
+        {
+            buffer[count] = c;
+        }
+        count++;
+    }
+    
+    if(buffer)
+    {
+        buffer[(count < size - 1) ? count : size - 1] = '\0';
+    }
+    if(decoded)
+    {
+        *decoded = count;
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stream code point
+ **     Parse the hex digits of a \u escape, including the second half of a
+ **     UTF-16 surrogate pair
+ **
+ ** @param stream: streaming parser, positioned after the \u
+ ** @param codePoint: destination for the decoded code point
+ **
+ ** @return ERR_json if the escape is not valid
+******************************************************************************/
+STATIC error_t streamCodePoint(cfgStream_t* stream, uint32_t* codePoint)
+{
+    uint32_t units[2] = {0, 0};
+    uint8_t count = 1;
+    char c;
+    
+    for(uint8_t unit = 0; unit < count; unit++)
+    {
+        //the low surrogate must follow as a second escape
+        if(unit && (!consumeByte(stream, '\\') || !consumeByte(stream, 'u')))
+        {
+            return ERR_json;
+        }
+        if(stream->length - stream->offset < 4)
+        {
+            return ERR_json;
+        }
+        
+        for(uint8_t i = 0; i < 4; i++)
+        {
+            c = stream->json[stream->offset++];
+            units[unit] <<= 4;
+            if((c >= '0') && (c <= '9'))
+            {
+                units[unit] |= (uint32_t)(c - '0');
+            }
+            else if((c >= 'a') && (c <= 'f'))
+            {
+                units[unit] |= (uint32_t)(c - 'a' + 10);
+            }
+            else if((c >= 'A') && (c <= 'F'))
+            {
+                units[unit] |= (uint32_t)(c - 'A' + 10);
+            }
+            else
+            {
+                return ERR_json;
+            }
+        }
+        
+        //a high surrogate needs a low surrogate after it, which may not appear alone
+        if(!unit && (units[0] >= 0xD800) && (units[0] <= 0xDBFF))
+        {
+            count = 2;
+        }
+        else if(((units[unit] >= 0xDC00) && (units[unit] <= 0xDFFF)) != (unit == 1))
+        {
+            return ERR_json;
+        }
+    }
+    
+    *codePoint = (count == 1) ? units[0] : 0x10000 + (((units[0] & 0x3FF) << 10) | (units[1] & 0x3FF));
+    
+    return ERR_success;
+}
 
-//************************ Public functions *********************************//
- 
  /*****************************************************************************
- ** @brief Configuration initialization
- **     Init the stored config with the contents of the provided file path, if
- **     loading of that config fails, use default values.
+ ** @brief Stream number
+ **     Parse a number. The buffer may end right after it, so it is copied
+ **     before being converted.
  **
- ** @param filepath: path to config file
+ ** @param stream: streaming parser, positioned at the number
+ ** @param number: destination for the number, may be NULL
  **
- ** @return error code
+ ** @return ERR_json if the number is not valid
 ******************************************************************************/
-error_t CFG_init(char* filepath)
+STATIC error_t streamNumber(cfgStream_t* stream, double* number)
 {
-    FILE* file;
-    long fileSize;
-    char* json;
-    size_t readBytes;
-    error_t result;
+    char digits[64];
+    char* end;
+    double value;
+    size_t count;
+    char c;
     
-    //open file
-    file = fopen(filepath, "r");
-    if(!file)
+    for(count = 0; (count < sizeof(digits) - 1) && (stream->offset + count < stream->length); count++)
     {
-        printf("Failed to open file, using default values\n");
-        return ERR_file;
+        c = stream->json[stream->offset + count];
+        if(((c < '0') || (c > '9')) && (c != '+') && (c != '-') && (c != '.') && (c != 'e') && (c != 'E'))
+        {
+            break;
+        }
+        digits[count] = c;
+    }
+    digits[count] = '\0';
+    
+    value = strtod(digits, &end);
+    if(end == digits)
+    {
+        return ERR_json;
+    }
+    stream->offset += (size_t)(end - digits);
+    
+    if(number)
+    {
+        *number = value;
     }
+    
+    return ERR_success;
+}
 
-    //determine file size
-    fseek(file, 0, SEEK_END);
-    fileSize = ftell(file);
-    rewind(file);
+ /*****************************************************************************
+ ** @brief Skip value
+ **     Check the syntax of a value without using it
+ **
+ ** @param stream: streaming parser, positioned at the value
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t skipValue(cfgStream_t* stream)
+{
+    size_t remaining = stream->length - stream->offset;
+    const char* value = stream->json + stream->offset;
+    
+    switch(peekByte(stream))
+    {
+        case '{':
+            return streamObject(stream, NULL);
+        case '[':
+            return streamArray(stream, NULL);
+        case '"':
+            return streamString(stream, NULL, 0, NULL);
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return streamNumber(stream, NULL);
+        default:
+            break;
+    }
+    
+    //literals
+    if((remaining >= 4) && (!memcmp(value, "null", 4) || !memcmp(value, "true", 4)))
+    {
+        stream->offset += 4;
+        return ERR_success;
+    }
+    if((remaining >= 5) && !memcmp(value, "false", 5))
+    {
+        stream->offset += 5;
+        return ERR_success;
+    }
+    
+    return ERR_json;
+}
 
-    //malloc space for file contents
-    json = (char *)malloc_ptr(fileSize + 1);  // +1 for null terminator
-    if(!json)
+ /*****************************************************************************
+ ** @brief Skip whitespace
+ **     Skip whitespace and control characters
+ **
+ ** @param stream: streaming parser
+ **
+ ** @return none
+******************************************************************************/
+STATIC void skipWhitespace(cfgStream_t* stream)
+{
+    while((stream->offset < stream->length) && ((unsigned char)stream->json[stream->offset] <= ' '))
     {
-        printf("Failed to allocate memory for JSON content, using default values\n");
-        fclose(file);
-        return ERR_mem;
+        stream->offset++;
     }
+}
+
+ /*****************************************************************************
+ ** @brief Peek byte
+ **
+ ** @param stream: streaming parser
+ **
+ ** @return next unread byte, '\0' at the end of the buffer
+******************************************************************************/
+STATIC char peekByte(cfgStream_t* stream)
+{
+    return (stream->offset < stream->length) ? stream->json[stream->offset] : '\0';
+}
 
-    //read and null terminate the resulting string, just in case
-    readBytes = fread_ptr(json, 1, fileSize, file);
-    if((long)readBytes != fileSize)
+ /*****************************************************************************
+ ** @brief Consume byte
+ **     Move past the next byte if it is the expected one
+ **
+ ** @param stream: streaming parser
+ ** @param expected: expected byte
+ **
+ ** @return true if the byte was consumed
+******************************************************************************/
+STATIC bool consumeByte(cfgStream_t* stream, char expected)
+{
+    if(peekByte(stream) != expected)
     {
-        printf("Failed to read all bytes from file (%lu of %li), using default values\n", readBytes, fileSize);
-        fclose(file);
-        free(json);
-        return ERR_other;
+        return false;
     }
-    json[fileSize] = '\0';
+    
+    stream->offset++;
+    return true;
+}
 
-    fclose(file);
+ /*****************************************************************************
+ ** @brief Set format error
+ **     Record a format error; only the first one is kept
+ **
+ ** @param stream: streaming parser
+ **
+ ** @return true if this is the first format error
+******************************************************************************/
+STATIC bool setFormatError(cfgStream_t* stream)
+{
+    if(stream->result != ERR_success)
+    {
+        return false;
+    }
     
-    result = parseConfig(json);
-    if(result != ERR_success)
+    stream->result = ERR_format;
+    return true;
+}
+
+ /*****************************************************************************
+ ** @brief Claim key
+ **     Mark a key as found in the object being parsed. A key found twice is
+ **     a format error, the same as in the tree parser.
+ **
+ ** @param stream: streaming parser
+ ** @param id: key found
+ ** @param key: key as written, for the error message
+ **
+ ** @return true if this is the first time the key is found
+******************************************************************************/
+STATIC bool claimKey(cfgStream_t* stream, cfgKey_t id, const char* key)
+{
+    if(stream->seen & (1u << id))
     {
-        printf("Failed to load config, using default values\n");
-        CFG_loadDefaults();
+        setFormatError(stream);
+        printf("Duplicate key: %s\n", key);
+        return false;
     }
     
-    free(json);
+    stream->seen |= (1u << id);
+    return true;
+}
+
+ /*****************************************************************************
+ ** @brief Skip unknown key
+ **     Warn about a key not used by the object being parsed and skip its value
+ **
+ ** @param stream: streaming parser, positioned at the member value
+ ** @param key: member key
+ **
+ ** @return ERR_json if the value is not valid JSON
+******************************************************************************/
+STATIC error_t skipUnknownKey(cfgStream_t* stream, const char* key)
+{
+    printf("Ignoring unknown key: %s\n", key);
+    
+    return skipValue(stream);
+}
+
+ /*****************************************************************************
+ ** @brief Print parse error
+ **     Print the JSON following a syntax error. The buffer may not be null
+ **     terminated, so only a bounded part of what is left of it is printed.
+ **
+ ** @param json: json buffer
+ ** @param length: length of the json buffer
+ ** @param errorPtr: position of the error, may be NULL
+ **
+ ** @return none
+******************************************************************************/
+STATIC void printParseError(const char* json, size_t length, const char* errorPtr)
+{
+    int errorLength;    //bytes after the error
     
-    return result;
+    errorLength = (errorPtr && (errorPtr >= json) && (errorPtr <= json + length)) ? (int)(json + length - errorPtr) : 0;
+    printf("Failed to parse JSON config: %.*s\n", (errorLength < CFG_ERROR_CONTEXT) ? errorLength : CFG_ERROR_CONTEXT, errorLength ? errorPtr : "");
 }
 
  /*****************************************************************************
- ** @brief Load default config values
+ ** @brief Assign step
+ **     Save a step to a pattern. Users enter state start times but the config
+ **     expects state end times, so the time sets the end of the previous step.
  **
- ** @param none
+ ** @param steps: pattern into which the step is saved
+ ** @param stepIdx: index of the step in the pattern
+ ** @param stepState: state of the step
+ ** @param time: start time of the step
  **
  ** @return none
 ******************************************************************************/
-void CFG_loadDefaults(void)
+STATIC void assignStep(lightSetStep_t* steps, uint8_t stepIdx, lightSetState_t stepState, int time)
 {
-    lightSet_t defaultConfigs[INT_DIRECTIONS] = DEFAULT_CONFIG;
+    steps[stepIdx].state = stepState;
     
-    for(uint8_t i = 0; i < INT_DIRECTIONS; i++)
+    //set first to 0, last to never expire, and the rest to the time of the previous step
+    if(stepIdx == 0)    //first step
+    {
+        steps[stepIdx].expirationOffset = 0;
+    }
+    else if(stepState == LSS_end) //last step
+    {
+        steps[stepIdx - 1].expirationOffset = (uint64_t)time;
+        steps[stepIdx].expirationOffset = (uint64_t)-1;
+    }
+    else    //every step in between; its own expiration is set by the step after it
     {
-        lightConfigs[i] = defaultConfigs[i];
+        steps[stepIdx - 1].expirationOffset = (uint64_t)time;
+        steps[stepIdx].expirationOffset = 0;
     }
 }
 
  /*****************************************************************************
- ** @brief Get a light set
- **     Get the saved configation for a given direction
+ ** @brief Get time from number
+ **     Convert a JSON number to an integer time, saturating as cJSON does
  **
- ** @param direction: direction of requested light set
+ ** @param number: parsed number
  **
- ** @return pointer to light set
+ ** @return integer time
 ******************************************************************************/
-lightSet_t* CFG_getLightSet(intDirection_t direction)
+STATIC int getTimeFromNumber(double number)
 {
-    if(direction >= ID_numDirections)
+    if(number >= INT_MAX)
     {
-        return NULL;
+        return INT_MAX;
+    }
+    if(number <= (double)INT_MIN)
+    {
+        return INT_MIN;
     }
     
-    return &lightConfigs[direction];
+    return (int)number;
 }
 
-//************************* Local functions *********************************//
-
  /*****************************************************************************
- ** @brief Parse a JSON string
- **     Extract an intersection configuration from the provided JSON string. 
- **     Any deviation from the expected format will result in a failure.
+ ** @brief Get members
+ **     Sort the members of an object by key in a single pass, instead of
+ **     searching the object once per key. Keys not asked for are ignored with
+ **     a warning; a key found twice is a format error.
  **
- ** @param json: json string containing an intersection config
+ ** @param object: JSON object to search
+ ** @param members: filled with the member for each key, NULL if missing
+ ** @param keys: CFG_SEEN_x flags of the keys to find
  **
- ** @return error code
+ ** @return ERR_format for a duplicate key
 ******************************************************************************/
-STATIC error_t parseConfig(const char* json)
+STATIC error_t getMembers(const cJSON* object, const cJSON* members[CK_unknown], uint32_t keys)
 {
-    error_t result = ERR_success;
-    cJSON* root;                        //json root object
-    const cJSON* intersection = NULL;   //intersection object
-    const cJSON* direction = NULL;      //direction object
+    const cJSON* member = NULL;
+    cfgKey_t id;
     
-    //convert JSON string to cJSON object
-    root = cJSON_Parse(json);
-    if (!root) 
+    for(uint8_t i = 0; i < CK_unknown; i++)
     {
-        printf("Failed to parse JSON config: %s\n", cJSON_GetErrorPtr());
-        return ERR_json;
+        members[i] = NULL;
     }
     
-    //get intersection object
-    intersection = cJSON_GetObjectItem(root, "intersection");
-    
-    if(!cJSON_IsArray(intersection))
+    //array elements and scalars have no keyed members
+    if(!cJSON_IsObject(object))
     {
-        printf("Failed to extract intersection array object!\n");
-        return ERR_format;
+        return ERR_success;
     }
     
-    //for each direction in intersection...
-    cJSON_ArrayForEach(direction, intersection)
+    cJSON_ArrayForEach(member, object)
     {
-        result = parseDirection(direction);
-        if(result != ERR_success)
+        id = getKeyFromString(member->string);
+        if((id == CK_unknown) || !(keys & (1u << id)))
         {
-            break;
+            printf("Ignoring unknown key: %s\n", member->string);
+            continue;
+        }
+        if(members[id])
+        {
+            printf("Duplicate key: %s\n", member->string);
+            return ERR_format;
         }
+        members[id] = member;
     }
     
-    //free memory for cJSON object
-    cJSON_Delete(root);
-    
-    return result;
+    return ERR_success;
 }
 
  /*****************************************************************************
  ** @brief Parse direction object
  **     Parse a direction object within an intersection JSON config
  **
+ ** @param config: intersection config into which the direction should be saved
  ** @param directon: pointer to direction JSON object to parse
  **
  ** @return error code
 ******************************************************************************/
-STATIC error_t parseDirection(const cJSON* direction)
+STATIC error_t parseDirection(intConfig_t* config, const cJSON* direction)
 {
     const cJSON* lights = NULL;     //lights array JSON object
     const cJSON* steps = NULL;      //steps array JSON object
     const cJSON* value = NULL;      //generic JSON object
+    const cJSON* members[CK_unknown];   //direction members by key
     intDirection_t directionIdx;    //direction index
     error_t result = ERR_success;   
     
+    //find every member in one pass over the object
+    result = getMembers(direction, members, CFG_SEEN_DIRECTION | CFG_SEEN_LIGHTS | CFG_SEEN_STEPS);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
     //get direction heading (north/south/east/west) from direction object
-    value = cJSON_GetObjectItem(direction, "direction");
+    value = members[CK_direction];
     if(!cJSON_IsString(value))
     {
         printf("Direction value not a string!\n");
@@ -214,7 +1756,7 @@ STATIC error_t parseDirection(const cJSON* direction)
     //printf("\n%s\n", value->valuestring);
     
     //get lights array
-    lights = cJSON_GetObjectItem(direction, "lights");
+    lights = members[CK_lights];
     if(!cJSON_IsArray(lights))
     {
         printf("Invalid light config array\n");
@@ -222,14 +1764,14 @@ STATIC error_t parseDirection(const cJSON* direction)
     }
     
     //parse light types
-    result = parseLights(&lightConfigs[directionIdx], lights);
+    result = parseLights(&config->lightSets[directionIdx], lights);
     if(result != ERR_success)
     {
         return result;
     }
     
     //get steps array
-    steps = cJSON_GetObjectItem(direction, "steps");
+    steps = members[CK_steps];
     if(!cJSON_IsArray(steps))
     {
         printf("Invalid step config array\n");
@@ -237,7 +1779,7 @@ STATIC error_t parseDirection(const cJSON* direction)
     }
     
     //parse steps
-    result = parseSteps(&lightConfigs[directionIdx], steps);
+    result = parseSteps(&config->lightSets[directionIdx], steps);
     if(result != ERR_success)
     {
         return result;
@@ -292,9 +1834,10 @@ STATIC error_t parseLights(lightSet_t* lightConfig, const cJSON* lights)
 
  /*****************************************************************************
  ** @brief Parse steps array
- **     Parse JSON array of light pattern steps
+ **     Parse JSON array of light pattern steps and intern them as the set's
+ **     pattern
  **
- ** @param lightConfig: pointer to config into which steps array should be saved
+ ** @param lightConfig: pointer to config into which the pattern should be saved
  ** @param steps: JSON steps array object to parse
  **
  ** @return error code
@@ -303,8 +1846,12 @@ STATIC error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps)
 {
     const cJSON* step = NULL;
     const cJSON* value = NULL;
+    const cJSON* members[CK_unknown];   //step members by key
+    lightSetStep_t pattern[MAX_STEPS_IN_PATTERN];
+    const setPattern_t* interned;
     uint8_t stepIdx;
     lightSetState_t stepState;
+    error_t result;
     
     //for each step...
     stepIdx = 0;
@@ -317,8 +1864,15 @@ STATIC error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps)
             return ERR_format;
         }
         
+        //find state and time in one pass over the step
+        result = getMembers(step, members, CFG_SEEN_STATE | CFG_SEEN_TIME);
+        if(result != ERR_success)
+        {
+            return result;
+        }
+        
         //get and validate state
-        value = cJSON_GetObjectItem(step, "state");
+        value = members[CK_state];
         if(!cJSON_IsString(value))
         {
             printf("Step state value not a string!\n");
@@ -333,7 +1887,7 @@ STATIC error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps)
         //printf("%s\n", value->valuestring);
         
         //get and validate time
-        value = cJSON_GetObjectItem(step, "time");
+        value = members[CK_time];
         if(!cJSON_IsNumber(value))
         {
             printf("Step time value not a number!\n");
@@ -342,56 +1896,117 @@ STATIC error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps)
         //printf("%d\n", value->valueint);
         
         //assign step state and time values
-        lightConfig->steps[stepIdx].state = stepState;
-        
-        //users enter state start times but config expects state end times, so set first to 0, last to never expire, and the rest to the time of the previous step
-        if(stepIdx == 0)    //first step
-        {
-            lightConfig->steps[stepIdx].expirationOffset = 0;
-        }
-        else if(stepState == LSS_end) //last step
-        {
-            lightConfig->steps[stepIdx - 1].expirationOffset = (uint64_t)value->valueint;
-            lightConfig->steps[stepIdx].expirationOffset = (uint64_t)-1;
-        }
-        else    //every step in between
-        {
-            lightConfig->steps[stepIdx - 1].expirationOffset = (uint64_t)value->valueint;
-        }
+        assignStep(pattern, stepIdx, stepState, value->valueint);
         
         stepIdx++;
     }
     
+    interned = PAT_intern(PAT_getDefault(), pattern, stepIdx);
+    if(!interned)
+    {
+        return ERR_mem;
+    }
+    lightConfig->pattern = interned;
+    
     return ERR_success;
 }
 
  /*****************************************************************************
- ** @brief Get direction index from string
- **     Convert a direction string to a direction index
+ ** @brief Get key from string
+ **     Convert an object key to a key index. The length with the first and
+ **     last letters select the only possible match, so at most one case
+ **     insensitive comparison is made.
  **
- ** @param dir: direction heading string
+ ** @param key: object key string
  **
- ** @return direction index
+ ** @return key index, CK_unknown if the key is not a config key
 ******************************************************************************/
-STATIC intDirection_t getDirectionIdxFromString(char* dir)
+STATIC cfgKey_t getKeyFromString(const char* key)
 {
-    if(!strcasecmp(CFG_DIR_STR_NORTH, dir))
-    {
-        return ID_north;
-    }
-    else if(!strcasecmp(CFG_DIR_STR_EAST, dir))
+    const char* candidate;
+    cfgKey_t id;
+    size_t length = strlen(key);
+    
+    if(!length)
     {
-        return ID_east;
+        return CK_unknown;
     }
-    else if(!strcasecmp(CFG_DIR_STR_SOUTH, dir))
+    
+    switch((length << 16) | ((unsigned)(unsigned char)toLowerAscii(key[0]) << 8) | (unsigned char)toLowerAscii(key[length - 1]))
     {
-        return ID_south;
+        case (sizeof(CFG_KEY_INTERSECTION) - 1) << 16 | 'i' << 8 | 'n':
+            candidate = CFG_KEY_INTERSECTION;
+            id = CK_intersection;
+            break;
+        case (sizeof(CFG_KEY_DIRECTION) - 1) << 16 | 'd' << 8 | 'n':
+            candidate = CFG_KEY_DIRECTION;
+            id = CK_direction;
+            break;
+        case (sizeof(CFG_KEY_LIGHTS) - 1) << 16 | 'l' << 8 | 's':
+            candidate = CFG_KEY_LIGHTS;
+            id = CK_lights;
+            break;
+        case (sizeof(CFG_KEY_STEPS) - 1) << 16 | 's' << 8 | 's':
+            candidate = CFG_KEY_STEPS;
+            id = CK_steps;
+            break;
+        case (sizeof(CFG_KEY_STATE) - 1) << 16 | 's' << 8 | 'e':
+            candidate = CFG_KEY_STATE;
+            id = CK_state;
+            break;
+        case (sizeof(CFG_KEY_TIME) - 1) << 16 | 't' << 8 | 'e':
+            candidate = CFG_KEY_TIME;
+            id = CK_time;
+            break;
+        case (sizeof(CFG_KEY_NAME) - 1) << 16 | 'n' << 8 | 'e':
+            candidate = CFG_KEY_NAME;
+            id = CK_name;
+            break;
+        default:
+            return CK_unknown;
     }
-    else if(!strcasecmp(CFG_DIR_STR_WEST, dir))
+    
+    return strcasecmp(candidate, key) ? CK_unknown : id;
+}
+
+ /*****************************************************************************
+ ** @brief Get direction index from string
+ **     Convert a direction string to a direction index. The length and first
+ **     letter select the only possible match, so at most one case
+ **     insensitive comparison is made.
+ **
+ ** @param dir: direction heading string
+ **
+ ** @return direction index
+******************************************************************************/
+STATIC intDirection_t getDirectionIdxFromString(char* dir)
+{
+    const char* candidate;
+    intDirection_t direction;
+    
+    switch((strlen(dir) << 8) | (unsigned char)toLowerAscii(dir[0]))
     {
-        return ID_west;
+        case (sizeof(CFG_DIR_STR_NORTH) - 1) << 8 | 'n':
+            candidate = CFG_DIR_STR_NORTH;
+            direction = ID_north;
+            break;
+        case (sizeof(CFG_DIR_STR_EAST) - 1) << 8 | 'e':
+            candidate = CFG_DIR_STR_EAST;
+            direction = ID_east;
+            break;
+        case (sizeof(CFG_DIR_STR_SOUTH) - 1) << 8 | 's':
+            candidate = CFG_DIR_STR_SOUTH;
+            direction = ID_south;
+            break;
+        case (sizeof(CFG_DIR_STR_WEST) - 1) << 8 | 'w':
+            candidate = CFG_DIR_STR_WEST;
+            direction = ID_west;
+            break;
+        default:
+            return ID_numDirections;
     }
-    return ID_numDirections;
+    
+    return strcasecmp(candidate, dir) ? ID_numDirections : direction;
 }
 
  /*****************************************************************************
@@ -421,7 +2036,11 @@ STATIC lightDisplayType_t getLightTypeFromString(char* type)
 
  /*****************************************************************************
  ** @brief Get step state index from string
- **     Convert a step state string to a step state index
+ **     Convert a step state string to a step state index. "LxSy" states are
+ **     decoded from their two variable letters, since the state enum lists
+ **     them left light major (P, U, Y, R) and straight light minor (G, Y, R).
+ **     The other states are told apart by length. Matching is case
+ **     insensitive.
  **
  ** @param state: light step state string
  **
@@ -429,62 +2048,71 @@ STATIC lightDisplayType_t getLightTypeFromString(char* type)
 ******************************************************************************/
 STATIC lightSetState_t getStepStateFromString(char* state)
 {
-    if(!strcasecmp(CFG_STEP_STATE_LPSG, state))
-    {
-        return LSS_LPSG;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LPSY, state))
-    {
-        return LSS_LPSY;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LPSR, state))
-    {
-        return LSS_LPSR;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LUSG, state))
-    {
-        return LSS_LUSG;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LUSY, state))
-    {
-        return LSS_LUSY;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LUSR, state))
-    {
-        return LSS_LUSR;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LYSG, state))
-    {
-        return LSS_LYSG;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LYSY, state))
-    {
-        return LSS_LYSY;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LYSR, state))
-    {
-        return LSS_LYSR;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LRSG, state))
-    {
-        return LSS_LRSG;
-    }
-    else if(!strcasecmp(CFG_STEP_STATE_LRSY, state))
+    uint8_t left;
+    uint8_t straight;
+    
+    switch(strlen(state))
     {
-        return LSS_LRSY;
+        case sizeof(CFG_STEP_STATE_LPSG) - 1:
+            break;
+        case sizeof(CFG_STEP_STATE_END) - 1:
+            return strcasecmp(CFG_STEP_STATE_END, state) ? LSS_unused : LSS_end;
+        case sizeof(CFG_STEP_STATE_DISABLE) - 1:
+            return strcasecmp(CFG_STEP_STATE_DISABLE, state) ? LSS_unused : LSS_disable;
+        default:
+            return LSS_unused;
     }
-    else if(!strcasecmp(CFG_STEP_STATE_LRSR, state))
+    
+    if((toLowerAscii(state[0]) != 'l') || (toLowerAscii(state[2]) != 's'))
     {
-        return LSS_LRSR;
+        return LSS_unused;
     }
-    else if(!strcasecmp(CFG_STEP_STATE_END, state))
+    
+    switch(toLowerAscii(state[1]))
     {
-        return LSS_end;
+        case 'p':
+            left = 0;
+            break;
+        case 'u':
+            left = 1;
+            break;
+        case 'y':
+            left = 2;
+            break;
+        case 'r':
+            left = 3;
+            break;
+        default:
+            return LSS_unused;
     }
-    else if(!strcasecmp(CFG_STEP_STATE_DISABLE, state))
+    
+    switch(toLowerAscii(state[3]))
     {
-        return LSS_disable;
+        case 'g':
+            straight = 0;
+            break;
+        case 'y':
+            straight = 1;
+            break;
+        case 'r':
+            straight = 2;
+            break;
+        default:
+            return LSS_unused;
     }
-    return LSS_unused;
+    
+    return (lightSetState_t)(LSS_LPSG + left * 3 + straight);
 }
 
+ /*****************************************************************************
+ ** @brief To lower ASCII
+ **     Lower case an ASCII letter, independent of the locale
+ **
+ ** @param c: character
+ **
+ ** @return lower case letter, or the character unchanged if not a letter
+******************************************************************************/
+STATIC char toLowerAscii(char c)
+{
+    return ((c >= 'A') && (c <= 'Z')) ? (char)(c + ('a' - 'A')) : c;
+}
@@ -19,28 +19,20 @@
 #define LIGHT_SOLID_GRN         {.type = LDT_solid, .state = LS_red}
 #define LIGHT_UNUSED            {.type = LDT_unused, .state = LS_red}
 
-#define STEP_UNUSED             {.state = LSS_unused, .expirationOffset = 0}
-#define STEP_END                {.state = LSS_end, .expirationOffset = -1}
-#define STEP_YELLOW             {.state = LSS_LYSY, .expirationOffset = 9000}
-#define STEP_RED                {.state = LSS_LRSR, .expirationOffset = 11000}
-#define STEP_PROT_GRN           {.state = LSS_LPSR, .expirationOffset = 3000}
-#define STEP_PROT_GRN_EXP       {.state = LSS_LYSR, .expirationOffset = 5000}
-#define STEP_UNPROT_GRN         {.state = LSS_LUSG, .expirationOffset = 7000}
-#define STEP_FLASH_RED          {.state = LSS_LRGR, .expirationOffset = 1000}
-#define STEP_FLASH_OFF          {.state = LSS_disable, .expirationOffset = 1000}
-
-#define PATTERN_ADV_GRN         {STEP_PROT_GRN, STEP_PROT_GRN_EXP, STEP_UNPROT_GRN, STEP_YELLOW, STEP_RED, STEP_END, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED}
-
-#define PATTERN_FLASH_RED       {STEP_FLASH_OFF, STEP_END, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED}
-
-#define PATTERN_UNUSED          {STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED, STEP_UNUSED}
+//pattern initializers; each offset is the time from the cycle start at which its step expires
+#define PATTERN_ADV_GRN         {.offsets = (const uint32_t[]){3000, 5000, 7000, 9000, 11000, SET_OFFSET_END}, \
+                                 .states = (const uint8_t[]){LSS_LPSR, LSS_LYSR, LSS_LUSG, LSS_LYSY, LSS_LRSR, LSS_end}, \
+                                 .count = 6}
+#define PATTERN_FLASH_RED       {.offsets = (const uint32_t[]){1000, SET_OFFSET_END}, \
+                                 .states = (const uint8_t[]){LSS_disable, LSS_end}, \
+                                 .count = 2}
 
 #define DEFAULT_LIGHT_SET_N     {.lights = {LIGHT_ADV_GRN, LIGHT_SOLID_GRN, LIGHT_UNUSED, LIGHT_UNUSED, LIGHT_UNUSED}, \
-                                 .steps = PATTERN_ADV_GRN, \
-                                 .currentStep = MAX_STEPS_IN_PATTERN - 1}
+                                 .pattern = &CFG_advGreenPattern, \
+                                 .currentStep = SET_LEAD_IN}
 #define UNUSED_LIGHT_SET        {.lights = {LIGHT_UNUSED, LIGHT_UNUSED, LIGHT_UNUSED, LIGHT_UNUSED, LIGHT_UNUSED}, \
-                                 .steps = PATTERN_UNUSED, \
-                                 .currentStep = MAX_STEPS_IN_PATTERN - 1}
+                                 .pattern = &SET_unusedPattern, \
+                                 .currentStep = SET_LEAD_IN}
                                  
 #define DEFAULT_LIGHT_SET_E     DEFAULT_LIGHT_SET_N
 #define DEFAULT_LIGHT_SET_S     DEFAULT_LIGHT_SET_N
@@ -85,10 +77,33 @@ typedef enum
     ID_numDirections    //last item in list; number of valid options
 } intDirection_t;
 
+//light set configs for every direction of an intersection
+typedef struct intconfig
+{
+    lightSet_t lightSets[INT_DIRECTIONS];   //intersection config source of truth
+} intConfig_t;
+
+//config file parsers
+typedef enum cfgparser
+{
+    CP_stream = 0,      //single pass tokenizer writing straight into the config
+    CP_tree             //cJSON document tree
+} cfgParser_t;
+
+//config generated from JSON by njtraffic-generate; only linked into builds with STATIC_CONFIG
+extern const intConfig_t CFG_staticConfig;
+
+//pattern of the default light sets; not in any pool
+extern const setPattern_t CFG_advGreenPattern;
+
 //********************* Public function prototypes ****************************//
-error_t CFG_init(char* filepath);
-void CFG_loadDefaults(void);
-lightSet_t* CFG_getLightSet(intDirection_t direction);
+error_t CFG_init(intConfig_t* config, char* filepath);
+error_t CFG_load(intConfig_t* config, const char* filepath);
+error_t CFG_validate(const intConfig_t* config);
+void CFG_apply(intConfig_t* config, const intConfig_t* update);
+void CFG_setParser(cfgParser_t parser);
+void CFG_loadDefaults(intConfig_t* config);
+lightSet_t* CFG_getLightSet(intConfig_t* config, intDirection_t direction);
 
 
 #endif //_CONFIG_H
@@ -0,0 +1,98 @@
+/***************************************************************************************
+ * @file    configCache.c
+ * @date    October 18th 2026
+ *
+ * @brief   Cache of parsed configs. Each JSON config is stored as a one
+ *          intersection image named after a hash and the length of its
+ *          contents, so an unchanged file is decoded instead of parsed.
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for mkdir
+
+#include <limits.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include "main.h"
+#include "configCache.h"
+#include "configParser.h"
+#include "image.h"
+
+//************************* Local variables **********************************//
+STATIC const char* cacheDirectory = NULL;   //directory of cached parsed configs, NULL when not caching
+
+//************************ Public functions *********************************//
+ 
+ /*****************************************************************************
+ ** @brief Set config cache directory
+ **     Cache the parsed form of every JSON config loaded from then on, keyed
+ **     by a hash of the file contents, so unchanged configs are not parsed
+ **     again. Cached configs are loaded over unused light sets, as when an
+ **     intersection starts.
+ **
+ ** @param directory: cache directory, created when first written; NULL to
+ **     stop caching. The string must stay valid while caching.
+ **
+ ** @return none
+******************************************************************************/
+void CFG_setCacheDir(const char* directory)
+{
+    cacheDirectory = directory;
+}
+
+ /*****************************************************************************
+ ** @brief Load cached config
+ **     Load a JSON config from the cache, keyed by a hash and the length of
+ **     its contents. On a miss, or if the entry is corrupt or from another
+ **     version, the JSON is parsed and the entry is rebuilt. Without a cache
+ **     directory the JSON is only parsed.
+ **
+ ** @param config: unused intersection config into which the light sets are
+ **     saved, as CFG_parse() would
+ ** @param json: json buffer containing an intersection config
+ ** @param length: length of the json buffer
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_loadCached(intConfig_t* config, const char* json, size_t length)
+{
+    uint8_t entry[sizeof(imgHeader_t) + INT_DIRECTIONS * (sizeof(imgLightSet_t) + MAX_STEPS_IN_PATTERN * sizeof(imgStep_t)) + 1];  //one more than the longest entry, to catch longer files
+    char path[PATH_MAX];
+    uint32_t count = 0;
+    size_t entryLength;
+    FILE* file;
+    error_t result;
+    
+    if(!cacheDirectory || (snprintf(path, sizeof(path), "%s/%016" PRIx64 "-%zx.img", cacheDirectory, IMG_hash(json, length), length) >= (int)sizeof(path)))
+    {
+        return CFG_parse(config, json, length);
+    }
+    
+    file = fopen(path, "rb");
+    if(file)
+    {
+        entryLength = fread(entry, 1, sizeof(entry), file);
+        fclose(file);
+        if((IMG_check(entry, entryLength, &count) == ERR_success) && (count == 1) &&
+           (IMG_decode(entry, 0, config) == ERR_success))
+        {
+            return ERR_success;
+        }
+        printf("Rebuilding cached config %s\n", path);
+    }
+    
+    result = CFG_parse(config, json, length);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
+    //the directory may already exist; failing to cache only costs the next load a parse
+    mkdir(cacheDirectory, 0755);
+    if(IMG_write(path, config, 1) != ERR_success)
+    {
+        printf("Failed to cache config in %s\n", cacheDirectory);
+    }
+    
+    return ERR_success;
+}
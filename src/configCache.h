@@ -0,0 +1,22 @@
+/***************************************************************************************
+ * @file    configCache.h
+ * @date    October 18th 2026
+ *
+ * @brief   Parsed config cache header
+ *
+ ****************************************************************************************/
+
+#ifndef _CONFIGCACHE_H_
+#define _CONFIGCACHE_H_
+
+#include <stddef.h>
+
+#include "main.h"
+#include "config.h"
+
+//********************* Public function prototypes ****************************//
+void CFG_setCacheDir(const char* directory);
+error_t CFG_loadCached(intConfig_t* config, const char* json, size_t length);
+
+
+#endif //_CONFIGCACHE_H_
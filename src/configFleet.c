@@ -0,0 +1,406 @@
+/***************************************************************************************
+ * @file    configFleet.c
+ * @date    October 18th 2026
+ *
+ * @brief   Fleet config loading. The file is split at the elements of its
+ *          top level array, then the intersections are parsed on a pool of
+ *          threads with the streaming parser of config.c.
+ *
+ ****************************************************************************************/
+#define _DEFAULT_SOURCE             //necessary for _SC_NPROCESSORS_ONLN
+
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "configFleet.h"
+#include "configParser.h"
+#include "image.h"
+
+//********************* Local function prototypes ****************************//
+STATIC error_t splitFleet(const char* json, size_t length, cfgSpan_t** spans, uint32_t* count);
+STATIC error_t parseFleet(cfgFleet_t* fleet, const char* json, const cfgSpan_t* spans, uint8_t threads);
+STATIC void* fleetWorker(void* arg);
+
+//************************* Function pointers ********************************//
+STATIC void* (*fleetMalloc_ptr)(size_t) = malloc;     //function ptr for mocking
+
+//************************ Public functions *********************************//
+ 
+ /*****************************************************************************
+ ** @brief Load fleet configuration
+ **     Load every intersection of a fleet config file: an array of objects,
+ **     each holding an optional name and an intersection array in the single
+ **     intersection format. The file is split at the array's element
+ **     boundaries and the intersections are parsed on a pool of threads with
+ **     the streaming parser. The file may instead be a precompiled image,
+ **     whose intersections are all decoded and left unnamed. Nothing is
+ **     loaded if any intersection fails.
+ **
+ ** @param fleet: destination for the intersections, freed with CFG_freeFleet
+ ** @param filepath: path to fleet config file
+ ** @param threads: max threads parsing the file, 0 for one per online CPU
+ **
+ ** @return error code
+******************************************************************************/
+error_t CFG_loadFleet(cfgFleet_t* fleet, const char* filepath, uint8_t threads)
+{
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    char* contents;
+    size_t length;
+    bool mapped;
+    bool image;
+    cfgSpan_t* spans = NULL;
+    uint32_t count = 0;
+    error_t result;
+    
+    fleet->configs = NULL;
+    fleet->names = NULL;
+    fleet->count = 0;
+    
+    result = CFG_openFile(filepath, true, &contents, &length, &mapped);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
+    //images are checked once, then decoded without splitting
+    image = IMG_isImage(contents, length);
+    if(image)
+    {
+        result = IMG_check(contents, length, &count);
+    }
+    else
+    {
+        result = splitFleet(contents, length, &spans, &count);
+    }
+    if((result == ERR_success) && !count)
+    {
+        printf("Fleet config holds no intersections\n");
+        result = ERR_value;
+    }
+    
+    if(result == ERR_success)
+    {
+        fleet->configs = fleetMalloc_ptr(count * sizeof(intConfig_t));
+        fleet->names = fleetMalloc_ptr(count * sizeof(*fleet->names));
+        if(!fleet->configs || !fleet->names)
+        {
+            printf("Failed to allocate memory for %u intersections\n", count);
+            result = ERR_mem;
+        }
+    }
+    
+    if((result == ERR_success) && image)
+    {
+        fleet->count = count;
+        for(uint32_t i = 0; (i < count) && (result == ERR_success); i++)
+        {
+            fleet->configs[i] = unusedConfig;
+            fleet->names[i][0] = '\0';
+            result = IMG_decode(contents, i, &fleet->configs[i]);
+        }
+    }
+    else if(result == ERR_success)
+    {
+        fleet->count = count;
+        result = parseFleet(fleet, contents, spans, threads);
+    }
+    
+    free(spans);
+    CFG_closeFile(contents, length, mapped);
+    
+    if(result != ERR_success)
+    {
+        CFG_freeFleet(fleet);
+    }
+    
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Free fleet configuration
+ **
+ ** @param fleet: fleet loaded with CFG_loadFleet
+ **
+ ** @return none
+******************************************************************************/
+void CFG_freeFleet(cfgFleet_t* fleet)
+{
+    free(fleet->configs);
+    free(fleet->names);
+    fleet->configs = NULL;
+    fleet->names = NULL;
+    fleet->count = 0;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Split fleet
+ **     Find the elements of a fleet config's top level array. Only strings and
+ **     nesting are tracked, so the file is scanned at close to memory speed;
+ **     the syntax of each element is checked when it is parsed.
+ **
+ ** @param json: fleet config
+ ** @param length: length of the fleet config
+ ** @param spans: destination for the location of each element, to be freed
+ **     by the caller
+ ** @param count: destination for the number of elements
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t splitFleet(const char* json, size_t length, cfgSpan_t** spans, uint32_t* count)
+{
+    size_t capacity = CFG_FLEET_SPANS;
+    cfgSpan_t* found;
+    cfgSpan_t* grown;
+    size_t offset = 0;
+    size_t start = 0;
+    size_t end;
+    uint32_t depth = 0;
+    uint32_t elements = 0;
+    bool inElement = false;
+    bool closed = false;
+    char c;
+    
+    *spans = NULL;
+    *count = 0;
+    
+    //skip the UTF-8 byte order mark and leading whitespace
+    if((length > 3) && !memcmp(json, "\xEF\xBB\xBF", 3))
+    {
+        offset = 3;
+    }
+    while((offset < length) && ((unsigned char)json[offset] <= ' '))
+    {
+        offset++;
+    }
+    if((offset >= length) || (json[offset] != '['))
+    {
+        printf("Fleet config is not an array of intersections\n");
+        return ERR_format;
+    }
+    offset++;
+    
+    found = fleetMalloc_ptr(capacity * sizeof(cfgSpan_t));
+    if(!found)
+    {
+        printf("Failed to allocate memory for fleet config\n");
+        return ERR_mem;
+    }
+    
+    for(; (offset < length) && !closed; offset++)
+    {
+        c = json[offset];
+        if((unsigned char)c <= ' ')
+        {
+            continue;
+        }
+        
+        if(!inElement && (c != ']') && (c != ','))
+        {
+            inElement = true;
+            start = offset;
+        }
+        
+        switch(c)
+        {
+            case '"':
+                //skip to the closing quote
+                for(offset++; (offset < length) && (json[offset] != '"'); offset++)
+                {
+                    if(json[offset] == '\\')
+                    {
+                        offset++;
+                    }
+                }
+                break;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+                if(!depth)
+                {
+                    free(found);
+                    return ERR_json;
+                }
+                depth--;
+                break;
+            case ']':
+            case ',':
+                if(depth)
+                {
+                    depth -= (c == ']');
+                    break;
+                }
+                
+                //empty element, other than the closing bracket of an empty array
+                if(!inElement && ((c == ',') || elements))
+                {
+                    free(found);
+                    return ERR_json;
+                }
+                if(inElement)
+                {
+                    if(elements == capacity)
+                    {
+                        capacity *= 2;
+                        grown = realloc(found, capacity * sizeof(cfgSpan_t));
+                        if(!grown || (capacity > UINT32_MAX))
+                        {
+                            printf("Failed to allocate memory for fleet config\n");
+                            free(grown ? grown : found);
+                            return ERR_mem;
+                        }
+                        found = grown;
+                    }
+                    
+                    end = offset;
+                    while((unsigned char)json[end - 1] <= ' ')
+                    {
+                        end--;
+                    }
+                    found[elements].start = start;
+                    found[elements].length = end - start;
+                    elements++;
+                    inElement = false;
+                }
+                closed = (c == ']');
+                break;
+            default:
+                break;
+        }
+    }
+    
+    //only whitespace may follow the array
+    while((offset < length) && ((unsigned char)json[offset] <= ' '))
+    {
+        offset++;
+    }
+    if(!closed || (offset < length))
+    {
+        printf("Fleet config array is not closed\n");
+        free(found);
+        return ERR_json;
+    }
+    
+    *spans = found;
+    *count = elements;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Parse fleet
+ **     Parse the intersections of a fleet config on up to the requested
+ **     number of threads, including the calling thread
+ **
+ ** @param fleet: destination for the intersections, with room for each span
+ ** @param json: fleet config
+ ** @param spans: location of each intersection
+ ** @param threads: max threads, 0 for one per online CPU
+ **
+ ** @return error code of the first intersection in the file that failed
+******************************************************************************/
+STATIC error_t parseFleet(cfgFleet_t* fleet, const char* json, const cfgSpan_t* spans, uint8_t threads)
+{
+    cfgFleetJob_t job = {.json = json, .spans = spans, .fleet = fleet};
+    pthread_t workers[CFG_MAX_THREADS];
+    uint32_t batches = (fleet->count + CFG_FLEET_BATCH - 1) / CFG_FLEET_BATCH;
+    long online;
+    uint8_t started = 0;
+    uint64_t failure;
+    
+    atomic_init(&job.next, 0);
+    atomic_init(&job.failure, UINT64_MAX);
+    
+    if(!threads)
+    {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online < 1) ? 1 : (online > CFG_MAX_THREADS) ? CFG_MAX_THREADS : (uint8_t)online;
+    }
+    if(threads > CFG_MAX_THREADS)
+    {
+        threads = CFG_MAX_THREADS;
+    }
+    
+    //no more threads than there are batches; the calling thread is one of them
+    while((started + 1u < threads) && (started + 1u < batches))
+    {
+        if(pthread_create(&workers[started], NULL, fleetWorker, &job))
+        {
+            break;
+        }
+        started++;
+    }
+    
+    fleetWorker(&job);
+    
+    for(uint8_t i = 0; i < started; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    
+    failure = atomic_load(&job.failure);
+    if(failure != UINT64_MAX)
+    {
+        printf("Failed to parse intersection %u of fleet config\n", (unsigned)(failure >> 8));
+        return (error_t)(failure & 0xFF);
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Fleet worker
+ **     Take batches of fleet intersections and parse them until none are
+ **     left, or the rest come after an intersection that failed
+ **
+ ** @param arg: fleet job
+ **
+ ** @return NULL
+******************************************************************************/
+STATIC void* fleetWorker(void* arg)
+{
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    cfgFleetJob_t* job = arg;
+    cfgFleet_t* fleet = job->fleet;
+    uint64_t failure;
+    uint64_t expected;
+    uint32_t first;
+    uint32_t last;
+    error_t result;
+    
+    while(1)
+    {
+        first = atomic_fetch_add(&job->next, CFG_FLEET_BATCH);
+        if((first >= fleet->count) || (first > (atomic_load(&job->failure) >> 8)))
+        {
+            break;
+        }
+        last = (fleet->count - first < CFG_FLEET_BATCH) ? fleet->count : first + CFG_FLEET_BATCH;
+        
+        for(uint32_t i = first; i < last; i++)
+        {
+            fleet->configs[i] = unusedConfig;
+            fleet->names[i][0] = '\0';
+            result = CFG_streamFleetEntry(&fleet->configs[i], fleet->names[i], job->json + job->spans[i].start, job->spans[i].length);
+            if(result == ERR_success)
+            {
+                continue;
+            }
+            
+            //keep the failure that comes first in the file
+            failure = ((uint64_t)i << 8) | (uint8_t)result;
+            expected = atomic_load(&job->failure);
+            while((failure < expected) && !atomic_compare_exchange_weak(&job->failure, &expected, failure));
+            break;
+        }
+    }
+    
+    return NULL;
+}
@@ -0,0 +1,52 @@
+/***************************************************************************************
+ * @file    configFleet.h
+ * @date    October 18th 2026
+ *
+ * @brief   Fleet config loader header
+ *
+ ****************************************************************************************/
+
+#ifndef _CONFIGFLEET_H_
+#define _CONFIGFLEET_H_
+
+#include <stdatomic.h>
+
+#include "main.h"
+#include "config.h"
+
+#define CFG_MAX_NAME            64      //longest intersection name kept from a fleet config, including the terminator
+#define CFG_MAX_THREADS         64      //max threads parsing a fleet config
+#define CFG_FLEET_SPANS         1024    //initial number of intersections the fleet splitter has room for
+#define CFG_FLEET_BATCH         64      //intersections a fleet parsing thread takes at a time
+
+//intersections loaded from a fleet config
+typedef struct cfgfleet
+{
+    intConfig_t* configs;               //config of each intersection, in file order
+    char (*names)[CFG_MAX_NAME];        //name of each intersection, empty if it has none
+    uint32_t count;                     //number of intersections
+} cfgFleet_t;
+
+//location of one intersection in a fleet config
+typedef struct cfgspan
+{
+    size_t start;                       //offset of the intersection's object
+    size_t length;                      //length of the object
+} cfgSpan_t;
+
+//work shared by the threads parsing a fleet config
+typedef struct cfgfleetjob
+{
+    const char* json;                   //fleet config
+    const cfgSpan_t* spans;             //location of each intersection
+    cfgFleet_t* fleet;                  //destination for the parsed intersections
+    atomic_uint next;                   //index of the next intersection to be taken
+    atomic_uint_least64_t failure;      //index << 8 | error code of the first intersection that failed
+} cfgFleetJob_t;
+
+//********************* Public function prototypes ****************************//
+error_t CFG_loadFleet(cfgFleet_t* fleet, const char* filepath, uint8_t threads);
+void CFG_freeFleet(cfgFleet_t* fleet);
+
+
+#endif //_CONFIGFLEET_H_
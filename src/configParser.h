@@ -0,0 +1,84 @@
+/***************************************************************************************
+ * @file    configParser.h
+ * @date    October 18th 2026
+ *
+ * @brief   Config parser internals: the keys of the JSON format, the state
+ *          of the streaming parser and the file and parsing functions shared
+ *          by config.c, configFleet.c and configCache.c. Only for those files
+ *          and their tests; everything else uses their public headers.
+ *
+ ****************************************************************************************/
+
+#ifndef _CONFIGPARSER_H_
+#define _CONFIGPARSER_H_
+
+#include "main.h"
+#include "config.h"
+
+#define CFG_READ_CHUNK          65536   //initial buffer size when reading configs from streams
+#define CFG_ERROR_CONTEXT       32      //max bytes of JSON printed after a parse error
+#define CFG_ARENA_RATIO         10      //bytes of cJSON tree per byte of JSON; compact configs need about 9
+#define CFG_MAX_TOKEN           32      //longest key or string value kept by the streaming parser, including the terminator
+
+#define CFG_KEY_INTERSECTION    "intersection"
+#define CFG_KEY_NAME            "name"
+#define CFG_KEY_DIRECTION       "direction"
+#define CFG_KEY_LIGHTS          "lights"
+#define CFG_KEY_STEPS           "steps"
+#define CFG_KEY_STATE           "state"
+#define CFG_KEY_TIME            "time"
+
+//keys found by the streaming parser in the object being parsed; the flag of key CK_x is 1 << CK_x
+#define CFG_SEEN_INTERSECTION   (1u << CK_intersection)
+#define CFG_SEEN_DIRECTION      (1u << CK_direction)
+#define CFG_SEEN_LIGHTS         (1u << CK_lights)
+#define CFG_SEEN_STEPS          (1u << CK_steps)
+#define CFG_SEEN_STATE          (1u << CK_state)
+#define CFG_SEEN_TIME           (1u << CK_time)
+#define CFG_SEEN_NAME           (1u << CK_name)
+
+//keys of the config objects
+typedef enum cfgkey
+{
+    CK_intersection = 0,
+    CK_direction,
+    CK_lights,
+    CK_steps,
+    CK_state,
+    CK_time,
+    CK_name,
+    CK_unknown          //last item in list; number of valid options
+} cfgKey_t;
+
+//state of the streaming parser
+typedef struct cfgstream
+{
+    const char* json;                           //buffer being parsed
+    size_t length;                              //length of the buffer
+    size_t offset;                              //offset of the next unread byte
+    uint16_t depth;                             //nesting depth of the value being parsed
+    error_t result;                             //first format error; parsing continues to check the JSON syntax
+    intConfig_t* config;                        //config into which directions are saved
+    uint8_t seen;                               //CFG_SEEN_x flags of the keys found so far
+    intDirection_t direction;                   //direction being parsed
+    light_t lights[MAX_LIGHTS_IN_SET];          //lights of the direction being parsed
+    uint8_t lightCount;
+    lightSetStep_t steps[MAX_STEPS_IN_PATTERN]; //steps of the direction being parsed, interned once complete
+    uint8_t stepCount;
+    lightSetState_t stepState;                  //state of the step being parsed
+    double stepTime;                            //time of the step being parsed
+    char* name;                                 //destination for the name of a fleet intersection, CFG_MAX_NAME bytes
+} cfgStream_t;
+
+//callbacks for the members of a streamed object and the elements of a streamed array
+typedef error_t (*cfgMemberHandler_t)(cfgStream_t* stream, const char* key);
+typedef error_t (*cfgElementHandler_t)(cfgStream_t* stream, uint32_t index);
+
+//********************* Public function prototypes ****************************//
+error_t CFG_openFile(const char* filepath, bool map, char** contents, size_t* length, bool* mapped);
+void CFG_closeFile(char* contents, size_t length, bool mapped);
+error_t CFG_parse(intConfig_t* config, const char* json, size_t length);
+error_t CFG_streamFleetEntry(intConfig_t* config, char* name, const char* json, size_t length);
+
+
+#endif //_CONFIGPARSER_H_
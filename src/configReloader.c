@@ -0,0 +1,283 @@
+/***************************************************************************************
+ * @file    configReloader.c
+ * @date    October 18th 2026
+ *
+ * @brief   Live config reloading. A thread watches the config file's directory
+ *          with inotify, so both in place writes and editors that rename a new
+ *          file over the old one are seen. Each new version is loaded and
+ *          validated on that thread, then published with a single atomic
+ *          pointer exchange. The state machine takes it at the next
+ *          North-South/East-West boundary, so it never waits on I/O or
+ *          parsing and never runs a pattern that is half old, half new.
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for strdup
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/inotify.h>
+
+#include "main.h"
+#include "configReloader.h"
+
+//********************* Local function prototypes ****************************//
+STATIC void* reloaderThread(void* arg);
+STATIC bool readChanges(reloader_t* reloader);
+
+//************************* Function pointers ********************************//
+STATIC void* (*reloadMalloc_ptr)(size_t) = malloc;    //function ptr for mocking
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Start reloader
+ **     Watch a config file and reload it whenever it changes. The thread
+ **     starts with every signal blocked, so SIGINT, SIGTERM and SIGUSR1 are
+ **     always taken by the main thread, whether it handles them or blocks
+ **     them for an event loop's signalfd.
+ **
+ ** @param reloader: reloader to start
+ ** @param filepath: path to config file
+ **
+ ** @return error code
+******************************************************************************/
+error_t RLD_start(reloader_t* reloader, const char* filepath)
+{
+    const char* separator = strrchr(filepath, '/');
+    sigset_t allSignals;
+    sigset_t callerMask;
+    int created;
+    
+    atomic_init(&reloader->pending, NULL);
+    atomic_init(&reloader->reloads, 0);
+    atomic_init(&reloader->rejected, 0);
+    reloader->inotifyFd = -1;
+    reloader->stopFds[0] = -1;
+    reloader->stopFds[1] = -1;
+    
+    //split the path into the watched directory and the file name
+    reloader->filepath = strdup(filepath);
+    reloader->filename = strdup(separator ? separator + 1 : filepath);
+    reloader->directory = separator ? strndup(filepath, (separator == filepath) ? 1 : (size_t)(separator - filepath)) : strdup(".");
+    if(!reloader->filepath || !reloader->filename || !reloader->directory)
+    {
+        printf("Failed to allocate memory for config reloader\n");
+        RLD_stop(reloader);
+        return ERR_mem;
+    }
+    
+    reloader->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if((reloader->inotifyFd < 0) || (inotify_add_watch(reloader->inotifyFd, reloader->directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0))
+    {
+        printf("Failed to watch %s for config changes\n", reloader->directory);
+        RLD_stop(reloader);
+        return ERR_file;
+    }
+    
+    if(pipe(reloader->stopFds))
+    {
+        printf("Failed to create config reloader pipe\n");
+        reloader->stopFds[0] = -1;
+        reloader->stopFds[1] = -1;
+        RLD_stop(reloader);
+        return ERR_other;
+    }
+    
+    //the new thread inherits the mask in place when it is created
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_BLOCK, &allSignals, &callerMask);
+    created = pthread_create(&reloader->thread, NULL, reloaderThread, reloader);
+    pthread_sigmask(SIG_SETMASK, &callerMask, NULL);
+    if(created)
+    {
+        printf("Failed to start config reloader thread\n");
+        close(reloader->stopFds[1]);
+        reloader->stopFds[1] = -1;
+        RLD_stop(reloader);
+        return ERR_other;
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Reload
+ **     Load and validate the config file into a new config, then publish it.
+ **     A published config that was never taken is replaced. Invalid configs
+ **     are rejected and the current one stays in use.
+ **
+ ** @param reloader: reloader
+ **
+ ** @return error code
+******************************************************************************/
+error_t RLD_reload(reloader_t* reloader)
+{
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t* update;
+    error_t result;
+    
+    update = reloadMalloc_ptr(sizeof(intConfig_t));
+    if(!update)
+    {
+        printf("Failed to allocate memory for reloaded config\n");
+        atomic_fetch_add(&reloader->rejected, 1);
+        return ERR_mem;
+    }
+    
+    //start from the same base as the first load
+    *update = unusedConfig;
+    result = CFG_load(update, reloader->filepath);
+    if(result == ERR_success)
+    {
+        result = CFG_validate(update);
+    }
+    if(result != ERR_success)
+    {
+        printf("Rejected changes to %s, keeping the current config\n", reloader->filepath);
+        free(update);
+        atomic_fetch_add(&reloader->rejected, 1);
+        return result;
+    }
+    
+    free(atomic_exchange(&reloader->pending, update));
+    atomic_fetch_add(&reloader->reloads, 1);
+    printf("Reloaded %s, applying at the next direction change\n", reloader->filepath);
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Take reloaded config
+ **     Take ownership of the latest published config, if any. Never blocks.
+ **
+ ** @param reloader: reloader
+ **
+ ** @return config to be applied and freed by the caller, NULL if nothing
+ **     changed since the last call
+******************************************************************************/
+intConfig_t* RLD_take(reloader_t* reloader)
+{
+    //cheap check first, so the state machine does not write a shared line every toggle
+    if(!atomic_load_explicit(&reloader->pending, memory_order_relaxed))
+    {
+        return NULL;
+    }
+    
+    return atomic_exchange_explicit(&reloader->pending, NULL, memory_order_acquire);
+}
+
+ /*****************************************************************************
+ ** @brief Stop reloader
+ **     Stop the thread and free everything, including an untaken config.
+ **     Also cleans up a reloader that failed to start.
+ **
+ ** @param reloader: reloader to stop
+ **
+ ** @return none
+******************************************************************************/
+void RLD_stop(reloader_t* reloader)
+{
+    if(reloader->stopFds[1] >= 0)
+    {
+        if(write(reloader->stopFds[1], "", 1) == 1)
+        {
+            pthread_join(reloader->thread, NULL);
+        }
+        close(reloader->stopFds[1]);
+        reloader->stopFds[1] = -1;
+    }
+    if(reloader->stopFds[0] >= 0)
+    {
+        close(reloader->stopFds[0]);
+        reloader->stopFds[0] = -1;
+    }
+    if(reloader->inotifyFd >= 0)
+    {
+        close(reloader->inotifyFd);
+        reloader->inotifyFd = -1;
+    }
+    
+    free(atomic_exchange(&reloader->pending, NULL));
+    free(reloader->filepath);
+    free(reloader->filename);
+    free(reloader->directory);
+    reloader->filepath = NULL;
+    reloader->filename = NULL;
+    reloader->directory = NULL;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Reloader thread
+ **     Wait for changes to the config file and reload it, until stopped
+ **
+ ** @param arg: reloader
+ **
+ ** @return NULL
+******************************************************************************/
+STATIC void* reloaderThread(void* arg)
+{
+    reloader_t* reloader = arg;
+    struct pollfd fds[2] = {{.fd = reloader->inotifyFd, .events = POLLIN},
+                            {.fd = reloader->stopFds[0], .events = POLLIN}};
+    
+    while(1)
+    {
+        if(poll(fds, 2, -1) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            printf("Config reloader failed to wait for changes\n");
+            break;
+        }
+        
+        if(fds[1].revents)
+        {
+            break;
+        }
+        
+        if((fds[0].revents & POLLIN) && readChanges(reloader))
+        {
+            RLD_reload(reloader);
+        }
+    }
+    
+    return NULL;
+}
+
+ /*****************************************************************************
+ ** @brief Read changes
+ **     Drain the queued inotify events
+ **
+ ** @param reloader: reloader
+ **
+ ** @return true if any event was for the config file
+******************************************************************************/
+STATIC bool readChanges(reloader_t* reloader)
+{
+    _Alignas(struct inotify_event) char buffer[RLD_EVENT_BUFFER];
+    const struct inotify_event* event;
+    bool changed = false;
+    ssize_t length;
+    
+    while((length = read(reloader->inotifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for(char* next = buffer; next < buffer + length; next += sizeof(struct inotify_event) + event->len)
+        {
+            event = (const struct inotify_event*)next;
+            if(event->len && !strcmp(event->name, reloader->filename))
+            {
+                changed = true;
+            }
+        }
+    }
+    
+    return changed;
+}
@@ -0,0 +1,42 @@
+/***************************************************************************************
+ * @file    configReloader.h
+ * @date    October 18th 2026
+ *
+ * @brief   Live config reloading header
+ *
+ ****************************************************************************************/
+
+#ifndef _CONFIGRELOADER_H_
+#define _CONFIGRELOADER_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "main.h"
+#include "config.h"
+
+#define RLD_EVENT_BUFFER        4096    //bytes of inotify events read at once
+
+//watches a config file and prepares each valid new version for the state machine
+typedef struct reloader
+{
+    char* filepath;                     //path the config is loaded from
+    char* directory;                    //directory watched for changes to the file
+    char* filename;                     //name of the file within the directory
+    int inotifyFd;
+    int stopFds[2];                     //pipe written to stop the thread
+    pthread_t thread;
+    _Atomic(intConfig_t*) pending;      //validated config waiting for the next direction change
+    atomic_uint reloads;                //configs published
+    atomic_uint rejected;               //configs that failed to load or validate
+} reloader_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t RLD_start(reloader_t* reloader, const char* filepath);
+error_t RLD_reload(reloader_t* reloader);
+intConfig_t* RLD_take(reloader_t* reloader);
+void RLD_stop(reloader_t* reloader);
+
+
+#endif //_CONFIGRELOADER_H_
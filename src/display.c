@@ -33,12 +33,11 @@ typedef enum lightid
 //*********************** Static variables ***********************************//
 const char* lightStrings[] = {LIGHT_UNUSED_STR, LIGHT_SOLID_STR, LIGHT_ARROW_STR};    //aligned with lightDisplayType_t
 const char* lightColors[] = {COLOR_GREEN, COLOR_YELLOW, COLOR_YELLOW, COLOR_RED, COLOR_GREY};    //aligned with lightState_t
-STATIC uint8_t printedSetSteps[INT_DIRECTIONS];     //most recently printed light states
 
 //********************* Local function prototypes ****************************//
-void printNorthOrSouthLights(lightSet_t* set);
-void printWestAndEastLights(lightSet_t* west, lightSet_t* east);
-void printLightTypeString(lightID_t LID, lightSet_t* set);
+void printNorthOrSouthLights(const packedSet_t* set, uint64_t lamps);
+void printWestAndEastLights(const packedSet_t* west, const packedSet_t* east, uint64_t lamps);
+void printLightTypeString(lightID_t LID, const packedSet_t* set, uint64_t lamps);
 
 //************************ Public functions *********************************//
 
@@ -46,23 +45,25 @@ void printLightTypeString(lightID_t LID, lightSet_t* set);
  ** @brief Display light states
  **     Prints the most recent lights states to the console
  **
- ** @param none
+ ** @param display: display tracking of the intersection
+ ** @param sets: runtime light set of each direction
+ ** @param lamps: lamp board of the intersection
  **
  ** @return none
 ******************************************************************************/
-void DISP_printLightStates(void)
+void DISP_printLightStates(dispState_t* display, const packedSet_t* sets, uint64_t lamps)
 {
     bool printStates = false;
 
     //check if any state has changed since they were last printed
     for(uint8_t i = 0; i < INT_DIRECTIONS; i++)
     {
-        if(printedSetSteps[i] != CFG_getLightSet(i)->currentStep)
+        if(display->printedSetSteps[i] != sets[i].currentStep)
         {
             printStates = true;
             
             //update tracking variable
-            printedSetSteps[i] = CFG_getLightSet(i)->currentStep;
+            display->printedSetSteps[i] = sets[i].currentStep;
         }
     }
     
@@ -80,35 +81,19 @@ void DISP_printLightStates(void)
     printf("\033[H");  // Move the cursor to the top-left corner
 
     //print lights visible for vehicles heading North
-    if(CFG_getLightSet(ID_north))
-    {
-        printf("             North: %u\n", CFG_getLightSet(ID_north)->currentStep);
-        printNorthOrSouthLights(CFG_getLightSet(ID_north));
-    }
+    printf("             North: %u\n", sets[ID_north].currentStep);
+    printNorthOrSouthLights(&sets[ID_north], lamps);
     
     //print lights visible for vehicles heading West and East
-    if(CFG_getLightSet(ID_west))
-    {
-        printf("West: %u", CFG_getLightSet(ID_west)->currentStep);
-    }
-    else
-    {
-        printf("       ");
-    }
+    printf("West: %u", sets[ID_west].currentStep);
     printf("                   ");
-    if(CFG_getLightSet(ID_east))
-    {
-        printf("East: %u", CFG_getLightSet(ID_east)->currentStep);
-    }
+    printf("East: %u", sets[ID_east].currentStep);
     printf("\n");
-    printWestAndEastLights(CFG_getLightSet(ID_west), CFG_getLightSet(ID_east));
+    printWestAndEastLights(&sets[ID_west], &sets[ID_east], lamps);
     
     //print lights visible for vehicles heading South
-    if(CFG_getLightSet(ID_south))
-    {
-        printf("             South: %u\n", CFG_getLightSet(ID_south)->currentStep);
-        printNorthOrSouthLights(CFG_getLightSet(ID_south));
-    }
+    printf("             South: %u\n", sets[ID_south].currentStep);
+    printNorthOrSouthLights(&sets[ID_south], lamps);
 }
 
  /*****************************************************************************
@@ -116,10 +101,11 @@ void DISP_printLightStates(void)
  **     Prints states of lights visible to vehicles heading north or south
  **
  ** @param set: pointer to set of lights to print
+ ** @param lamps: lamp board of the intersection
  **
  ** @return none
 ******************************************************************************/
-void printNorthOrSouthLights(lightSet_t* set)
+void printNorthOrSouthLights(const packedSet_t* set, uint64_t lamps)
 {    
     if(!set)
     {
@@ -129,7 +115,7 @@ void printNorthOrSouthLights(lightSet_t* set)
     for(lightID_t lid = LID_red; lid < LID_lightIDs; lid++)
     {
         printf("             ");
-        printLightTypeString(lid, set);
+        printLightTypeString(lid, set, lamps);
         printf("\n");
     }
     printf("\n");
@@ -139,17 +125,19 @@ void printNorthOrSouthLights(lightSet_t* set)
  ** @brief Print East and West lights
  **     Prints states of lights visible to vehicles heading east and west
  **
- ** @param set: pointer to set of lights to print
+ ** @param west: pointer to set of lights heading west
+ ** @param east: pointer to set of lights heading east
+ ** @param lamps: lamp board of the intersection
  **
  ** @return none
 ******************************************************************************/
-void printWestAndEastLights(lightSet_t* west, lightSet_t* east)
+void printWestAndEastLights(const packedSet_t* west, const packedSet_t* east, uint64_t lamps)
 {    
     for(lightID_t lid = LID_red; lid < LID_lightIDs; lid++)
     {
-        printLightTypeString(lid, west);
+        printLightTypeString(lid, west, lamps);
         printf("           ");
-        printLightTypeString(lid, east);
+        printLightTypeString(lid, east, lamps);
         printf("\n");
     }
     printf("\n");
@@ -163,13 +151,15 @@ void printWestAndEastLights(lightSet_t* west, lightSet_t* east)
  **
  ** @param LID: light color ID
  ** @param set: pointer to set of lights to print
+ ** @param lamps: lamp board of the intersection, holding the set's light states
  **
  ** @return none
 ******************************************************************************/
-void printLightTypeString(lightID_t LID, lightSet_t* set)
+void printLightTypeString(lightID_t LID, const packedSet_t* set, uint64_t lamps)
 {
     const char* lstr = NULL;
     const char* cstr = NULL;
+    lightState_t lightState;
     
     for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
     {
@@ -180,16 +170,17 @@ void printLightTypeString(lightID_t LID, lightSet_t* set)
             continue;
         }
         //unused light set
-        if(set->lights[i].type == LDT_unused)
+        if(SET_getLampType(set, i) == LDT_unused)
         {
             printf("%s ", lightStrings[LDT_unused]);
             continue;
         }
+        lightState = SET_getBoardLamp(lamps, set->lane, i);
     
         switch(LID)
         {
             case LID_red:
-                if(set->lights[i].state == LS_red)
+                if(lightState == LS_red)
                 {
                     cstr = lightColors[LS_red];
                 }
@@ -199,7 +190,7 @@ void printLightTypeString(lightID_t LID, lightSet_t* set)
                 }
                 break;
             case LID_yellow:
-                if(set->lights[i].state == LS_yellow)
+                if(lightState == LS_yellow)
                 {
                     cstr = lightColors[LS_yellow];
                 }
@@ -209,11 +200,11 @@ void printLightTypeString(lightID_t LID, lightSet_t* set)
                 }
                 break;
             case LID_green:
-                if(set->lights[i].state == LS_green)
+                if(lightState == LS_green)
                 {
                     cstr = lightColors[LS_green];
                 }
-                else if(set->lights[i].state == LS_yellowArrow)
+                else if(lightState == LS_yellowArrow)
                 {
                     cstr = lightColors[LS_yellowArrow];
                 }
@@ -226,7 +217,7 @@ void printLightTypeString(lightID_t LID, lightSet_t* set)
                 cstr = lightStrings[LDT_unused];
                 break;
         }
-        lstr = lightStrings[set->lights[i].type];
+        lstr = lightStrings[SET_getLampType(set, i)];
         printf("%s%s %s", cstr, lstr, COLOR_RESET);
     }
 }
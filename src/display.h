@@ -11,10 +11,17 @@
 
 #include "main.h"
 #include "lightSet.h"
+#include "config.h"
+
+//console display tracking for an intersection
+typedef struct dispstate
+{
+    uint8_t printedSetSteps[INT_DIRECTIONS];    //most recently printed light states
+} dispState_t;
 
 //********************* Public function prototypes ****************************//
 
-void DISP_printLightStates(void);
+void DISP_printLightStates(dispState_t* display, const packedSet_t* sets, uint64_t lamps);
 
 
 #endif //_DISPLAY_H_
@@ -0,0 +1,464 @@
+/***************************************************************************************
+ * @file    eventLoop.c
+ * @date    October 18th 2026
+ *
+ * @brief   epoll based event loop. A single epoll set watches a timerfd for the
+ *          next light change, a signalfd for process signals and any other fds
+ *          (config files, control sockets, etc.) registered by the application.
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for sigprocmask and CLOCK_MONOTONIC
+
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+
+#include "main.h"
+#include "eventLoop.h"
+
+#define EVT_MAX_SIGNALS         65  //signal numbers are 1-64 on Linux
+
+//************************* Local types **************************************//
+typedef struct evthandlerentry
+{
+    int fd;                 //watched fd, -1 when the entry is free
+    evtHandler_t handler;   //callback for when the fd is readable
+    void* arg;              //user argument for the callback
+} evtHandlerEntry_t;
+
+typedef struct evtsignalentry
+{
+    evtSignalHandler_t handler;     //callback for when the signal is received
+    void* arg;                      //user argument for the callback
+} evtSignalEntry_t;
+
+//*********************** Static variables ***********************************//
+STATIC int epollFd = -1;                //epoll set watching all fds
+STATIC int timerFd = -1;                //timer for the next deadline
+STATIC int signalFd = -1;               //fd receiving all registered signals
+STATIC bool running = false;            //loop keeps running while set
+STATIC evtHandlerEntry_t handlers[EVT_MAX_HANDLERS];   //watched fds
+STATIC evtSignalEntry_t signalHandlers[EVT_MAX_SIGNALS];    //registered signals, indexed by signal number
+STATIC evtHandler_t timerHandler = NULL;    //user callback for timer expiration
+STATIC void* timerArg = NULL;               //user argument for timer callback
+STATIC sigset_t signalMask;                 //registered signals
+STATIC sigset_t originalMask;               //signal mask before any signals were registered
+
+//********************* Local function prototypes ****************************//
+STATIC evtHandlerEntry_t* findHandler(int fd);
+STATIC void timerFdHandler(int fd, void* arg);
+STATIC void signalFdHandler(int fd, void* arg);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Event loop initialization
+ **     Create the epoll set. Any previous loop is closed first.
+ **
+ ** @param none
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_init(void)
+{
+    EVT_close();
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if(epollFd < 0)
+    {
+        printf("Failed to create epoll set\n");
+        return ERR_other;
+    }
+
+    for(uint8_t i = 0; i < EVT_MAX_HANDLERS; i++)
+    {
+        handlers[i].fd = -1;
+    }
+    sigemptyset(&signalMask);
+    sigprocmask(SIG_BLOCK, NULL, &originalMask);
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Close event loop
+ **     Close the fds owned by the loop and restore the signal mask. Fds added
+ **     with EVT_addFd are left open for their owners.
+ **
+ ** @param none
+ **
+ ** @return none
+******************************************************************************/
+void EVT_close(void)
+{
+    if(timerFd >= 0)
+    {
+        close(timerFd);
+        timerFd = -1;
+    }
+    if(signalFd >= 0)
+    {
+        close(signalFd);
+        signalFd = -1;
+        sigprocmask(SIG_SETMASK, &originalMask, NULL);
+    }
+    if(epollFd >= 0)
+    {
+        close(epollFd);
+        epollFd = -1;
+    }
+
+    for(uint8_t i = 0; i < EVT_MAX_HANDLERS; i++)
+    {
+        handlers[i].fd = -1;
+    }
+    for(uint8_t i = 0; i < EVT_MAX_SIGNALS; i++)
+    {
+        signalHandlers[i].handler = NULL;
+    }
+    timerHandler = NULL;
+    running = false;
+}
+
+ /*****************************************************************************
+ ** @brief Add fd
+ **     Watch an fd and call a handler each time it becomes readable.
+ **
+ ** @param fd: fd to watch
+ ** @param handler: callback for when the fd is readable
+ ** @param arg: user argument passed to the callback
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_addFd(int fd, evtHandler_t handler, void* arg)
+{
+    struct epoll_event event;
+    evtHandlerEntry_t* entry;
+
+    if(!handler)
+    {
+        return ERR_nullPtr;
+    }
+    if((epollFd < 0) || (fd < 0) || findHandler(fd))
+    {
+        return ERR_value;
+    }
+
+    //claim a free entry
+    entry = findHandler(-1);
+    if(!entry)
+    {
+        printf("Event loop only supports %u fds\n", EVT_MAX_HANDLERS);
+        return ERR_mem;
+    }
+
+    event.events = EPOLLIN;
+    event.data.ptr = entry;
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        printf("Failed to watch fd %d\n", fd);
+        return ERR_other;
+    }
+
+    entry->fd = fd;
+    entry->handler = handler;
+    entry->arg = arg;
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Remove fd
+ **     Stop watching an fd. Safe to call from within a handler.
+ **
+ ** @param fd: fd to stop watching
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_removeFd(int fd)
+{
+    evtHandlerEntry_t* entry;
+
+    entry = (fd >= 0) ? findHandler(fd) : NULL;
+    if(!entry)
+    {
+        return ERR_value;
+    }
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+    entry->fd = -1;
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Set timer
+ **     Create the loop's timer. It starts disarmed; see EVT_armTimer().
+ **
+ ** @param handler: callback for when the timer expires
+ ** @param arg: user argument passed to the callback
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_setTimer(evtHandler_t handler, void* arg)
+{
+    error_t result;
+
+    if(!handler)
+    {
+        return ERR_nullPtr;
+    }
+
+    if(timerFd < 0)
+    {
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if(timerFd < 0)
+        {
+            printf("Failed to create timer\n");
+            return ERR_other;
+        }
+
+        result = EVT_addFd(timerFd, timerFdHandler, NULL);
+        if(result != ERR_success)
+        {
+            close(timerFd);
+            timerFd = -1;
+            return result;
+        }
+    }
+
+    timerHandler = handler;
+    timerArg = arg;
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Arm timer
+ **     Arm the loop's timer for an absolute CLOCK_MONOTONIC deadline. Deadlines
+ **     in the past fire immediately.
+ **
+ ** @param deadline: mS since epoch at which the timer should fire
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_armTimer(uint64_t deadline)
+{
+    struct itimerspec its = {0};
+
+    if(timerFd < 0)
+    {
+        return ERR_value;
+    }
+
+    its.it_value.tv_sec = (time_t)(deadline / 1000);
+    its.it_value.tv_nsec = (long)((deadline % 1000) * 1000000);
+
+    //an all-zero value disarms the timer, so use the earliest possible time instead
+    if(!its.it_value.tv_sec && !its.it_value.tv_nsec)
+    {
+        its.it_value.tv_nsec = 1;
+    }
+
+    if(timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+    {
+        printf("Failed to arm timer\n");
+        return ERR_other;
+    }
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Add signal
+ **     Block a signal and receive it through the loop instead. Must be called
+ **     before any additional threads are started so they inherit the mask.
+ **
+ ** @param signo: signal number
+ ** @param handler: callback for when the signal is received
+ ** @param arg: user argument passed to the callback
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_addSignal(int signo, evtSignalHandler_t handler, void* arg)
+{
+    int fd;
+    error_t result;
+
+    if(!handler)
+    {
+        return ERR_nullPtr;
+    }
+    if((epollFd < 0) || (signo <= 0) || (signo >= EVT_MAX_SIGNALS))
+    {
+        return ERR_value;
+    }
+
+    //signals must be blocked to be delivered through signalfd
+    sigaddset(&signalMask, signo);
+    sigprocmask(SIG_BLOCK, &signalMask, NULL);
+
+    //create the signalfd or update its mask
+    fd = signalfd(signalFd, &signalMask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if(fd < 0)
+    {
+        printf("Failed to create signalfd\n");
+        return ERR_other;
+    }
+    if(signalFd < 0)
+    {
+        signalFd = fd;
+        result = EVT_addFd(signalFd, signalFdHandler, NULL);
+        if(result != ERR_success)
+        {
+            close(signalFd);
+            signalFd = -1;
+            return result;
+        }
+    }
+
+    signalHandlers[signo].handler = handler;
+    signalHandlers[signo].arg = arg;
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Run event loop
+ **     Wait for events and dispatch them to their handlers until EVT_stop() is
+ **     called.
+ **
+ ** @param none
+ **
+ ** @return error code
+******************************************************************************/
+error_t EVT_run(void)
+{
+    struct epoll_event events[EVT_MAX_EVENTS];
+    evtHandlerEntry_t* entry;
+    int numEvents;
+
+    if(epollFd < 0)
+    {
+        return ERR_value;
+    }
+
+    running = true;
+    while(running)
+    {
+        numEvents = epoll_wait(epollFd, events, EVT_MAX_EVENTS, -1);
+        if(numEvents < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            printf("Failed to wait for events\n");
+            running = false;
+            return ERR_other;
+        }
+
+        for(int i = 0; i < numEvents; i++)
+        {
+            entry = events[i].data.ptr;
+
+            //skip fds removed by an earlier handler in this batch
+            if(entry->fd >= 0)
+            {
+                entry->handler(entry->fd, entry->arg);
+            }
+        }
+    }
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Stop event loop
+ **     Stop the loop once the current batch of events has been handled.
+ **
+ ** @param none
+ **
+ ** @return none
+******************************************************************************/
+void EVT_stop(void)
+{
+    running = false;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Find handler
+ **     Find the handler entry for a watched fd
+ **
+ ** @param fd: watched fd, -1 to find a free entry
+ **
+ ** @return pointer to handler entry, NULL if not found
+******************************************************************************/
+STATIC evtHandlerEntry_t* findHandler(int fd)
+{
+    for(uint8_t i = 0; i < EVT_MAX_HANDLERS; i++)
+    {
+        if(handlers[i].fd == fd)
+        {
+            return &handlers[i];
+        }
+    }
+
+    return NULL;
+}
+
+ /*****************************************************************************
+ ** @brief Timer fd handler
+ **     Acknowledge the timer expiration and call the user's timer handler
+ **
+ ** @param fd: timer fd
+ ** @param arg: unused
+ **
+ ** @return none
+******************************************************************************/
+STATIC void timerFdHandler(int fd, void* arg)
+{
+    uint64_t expirations;
+
+    (void)arg;
+
+    //nothing to do on a spurious wakeup
+    if(read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+    {
+        return;
+    }
+
+    if(timerHandler)
+    {
+        timerHandler(fd, timerArg);
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Signal fd handler
+ **     Dispatch every pending signal to its registered handler
+ **
+ ** @param fd: signal fd
+ ** @param arg: unused
+ **
+ ** @return none
+******************************************************************************/
+STATIC void signalFdHandler(int fd, void* arg)
+{
+    struct signalfd_siginfo info;
+
+    (void)arg;
+
+    while(read(fd, &info, sizeof(info)) == sizeof(info))
+    {
+        if((info.ssi_signo < EVT_MAX_SIGNALS) && signalHandlers[info.ssi_signo].handler)
+        {
+            signalHandlers[info.ssi_signo].handler((int)info.ssi_signo, signalHandlers[info.ssi_signo].arg);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+/***************************************************************************************
+ * @file    eventLoop.h
+ * @date    October 18th 2026
+ *
+ * @brief   epoll based event loop header
+ *
+ ****************************************************************************************/
+
+#ifndef _EVENTLOOP_H_
+#define _EVENTLOOP_H_
+
+#include "main.h"
+
+#define EVT_MAX_HANDLERS        16  //max number of watched fds, including the timer and signal fds
+#define EVT_MAX_EVENTS          16  //max number of events handled per wakeup
+
+//callback for a readable fd
+typedef void (*evtHandler_t)(int fd, void* arg);
+
+//callback for a received signal
+typedef void (*evtSignalHandler_t)(int signo, void* arg);
+
+//********************* Public function prototypes ****************************//
+
+error_t EVT_init(void);
+void EVT_close(void);
+error_t EVT_addFd(int fd, evtHandler_t handler, void* arg);
+error_t EVT_removeFd(int fd);
+error_t EVT_setTimer(evtHandler_t handler, void* arg);
+error_t EVT_armTimer(uint64_t deadline);
+error_t EVT_addSignal(int signo, evtSignalHandler_t handler, void* arg);
+error_t EVT_run(void);
+void EVT_stop(void);
+
+
+#endif //_EVENTLOOP_H_
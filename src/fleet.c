@@ -0,0 +1,161 @@
+/***************************************************************************************
+ * @file    fleet.c
+ * @date    October 18th 2026
+ *
+ * @brief   Drives many intersections from one timing wheel keyed on each
+ *          intersection's next light change, so a tick only touches the
+ *          intersections that are due.
+ *
+ ****************************************************************************************/
+
+#include "main.h"
+#include "fleet.h"
+#include "intersection.h"
+#include "timerWheel.h"
+
+//********************* Local function prototypes ****************************//
+STATIC void clockExpired(twNode_t* node, uint64_t millis, void* arg);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Fleet initialization
+ **     Schedule every intersection in the fleet for its first clock and
+ **     record their step lateness in the fleet. The intersections must
+ **     already be initialized.
+ **
+ ** @param fleet: fleet to initialize
+ ** @param intersections: array of intersections to drive
+ ** @param count: number of intersections in the array
+ ** @param now: current mS since epoch
+ **
+ ** @return error code
+******************************************************************************/
+error_t FLT_init(fleet_t* fleet, intersection_t* intersections, uint32_t count, uint64_t now)
+{
+    if(!fleet || (!intersections && count))
+    {
+        return ERR_nullPtr;
+    }
+    
+    fleet->intersections = intersections;
+    fleet->count = count;
+    fleet->millis = now;
+    TW_init(&fleet->wheel, now);
+    HIST_reset(&fleet->lateness);
+    
+    for(uint32_t i = 0; i < count; i++)
+    {
+        intersections[i].sets.lateness = &fleet->lateness;
+        intersections[i].timer.next = NULL;
+        TW_schedule(&fleet->wheel, &intersections[i].timer, INT_nextDeadlineCtx(&intersections[i]));
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Fleet tick
+ **     Clock every intersection whose next light change is due by the given
+ **     time and reschedule it for the following one.
+ **
+ ** @param fleet: fleet to tick
+ ** @param millis: current mS since epoch
+ **
+ ** @return number of intersections clocked
+******************************************************************************/
+uint32_t FLT_tick(fleet_t* fleet, uint64_t millis)
+{
+    fleet->millis = millis;
+    
+    return TW_advance(&fleet->wheel, millis, clockExpired, fleet);
+}
+
+ /*****************************************************************************
+ ** @brief Clock due intersection
+ **     Clock an intersection at the given time until nothing more is due, as
+ **     a polling loop would within the same mS. Bounded so configurations
+ **     with unused directions cannot spin.
+ **
+ ** @param intersection: intersection whose light change is due
+ ** @param millis: current mS since epoch
+ **
+ ** @return mS since epoch of the intersection's next light change
+******************************************************************************/
+uint64_t FLT_clockDue(intersection_t* intersection, uint64_t millis)
+{
+    uint64_t deadline;
+    uint8_t clocks = 0;
+    
+    do
+    {
+        INT_clockCtx(intersection, millis);
+        deadline = INT_nextDeadlineCtx(intersection);
+        clocks++;
+    } while((deadline <= millis) && (clocks < FLT_MAX_CLOCKS_PER_TICK));
+    
+    return deadline;
+}
+
+ /*****************************************************************************
+ ** @brief Get fleet lateness
+ **     Get the step change lateness of every intersection in the fleet
+ **
+ ** @param fleet: fleet to query
+ ** @param lateness: destination histogram, overwritten
+ **
+ ** @return none
+******************************************************************************/
+void FLT_getLateness(const fleet_t* fleet, histogram_t* lateness)
+{
+    *lateness = fleet->lateness;
+}
+
+ /*****************************************************************************
+ ** @brief Attach intersection lateness
+ **     Also record the step change lateness of each intersection of the
+ **     fleet in a histogram of its own
+ **
+ ** @param fleet: initialized fleet
+ ** @param lateness: caller's histograms, one per intersection in the same
+ **     order, reset here; NULL to stop recording them
+ **
+ ** @return none
+******************************************************************************/
+void FLT_attachLateness(fleet_t* fleet, histogram_t* lateness)
+{
+    for(uint32_t i = 0; i < fleet->count; i++)
+    {
+        if(lateness)
+        {
+            HIST_reset(&lateness[i]);
+        }
+        fleet->intersections[i].sets.ownLateness = lateness ? &lateness[i] : NULL;
+    }
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Clock expired intersection
+ **     Timing wheel callback for an intersection whose light change is due.
+ **     The intersection is clocked at the tick's time, then rescheduled.
+ **
+ ** @param node: timer of the due intersection
+ ** @param millis: mS in which the timer expired
+ ** @param arg: fleet being ticked
+ **
+ ** @return none
+******************************************************************************/
+STATIC void clockExpired(twNode_t* node, uint64_t millis, void* arg)
+{
+    fleet_t* fleet = arg;
+    uint64_t deadline;
+    
+    (void)millis;
+    
+    deadline = FLT_clockDue(INT_FROM_TIMER(node), fleet->millis);
+    
+    //deadlines still in the past are retried in the next mS
+    TW_schedule(&fleet->wheel, node, deadline);
+}
@@ -0,0 +1,38 @@
+/***************************************************************************************
+ * @file    fleet.h
+ * @date    October 18th 2026
+ *
+ * @brief   Fleet of intersections header
+ *
+ ****************************************************************************************/
+
+#ifndef _FLEET_H_
+#define _FLEET_H_
+
+#include "main.h"
+#include "intersection.h"
+#include "timerWheel.h"
+#include "histogram.h"
+
+#define FLT_MAX_CLOCKS_PER_TICK     4   //max clocks of one intersection per mS, bounds toggling of unused configs
+
+//intersections sharing one timing wheel
+typedef struct fleet
+{
+    intersection_t* intersections;  //array of intersections in the fleet
+    uint32_t count;                 //number of intersections in the array
+    uint64_t millis;                //time of the tick in progress
+    timerWheel_t wheel;             //next light change of every intersection
+    histogram_t lateness;           //step change lateness of every intersection
+} fleet_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t FLT_init(fleet_t* fleet, intersection_t* intersections, uint32_t count, uint64_t now);
+uint32_t FLT_tick(fleet_t* fleet, uint64_t millis);
+uint64_t FLT_clockDue(intersection_t* intersection, uint64_t millis);
+void FLT_getLateness(const fleet_t* fleet, histogram_t* lateness);
+void FLT_attachLateness(fleet_t* fleet, histogram_t* lateness);
+
+
+#endif //_FLEET_H_
@@ -0,0 +1,188 @@
+/***************************************************************************************
+ * @file    histogram.c
+ * @date    October 18th 2026
+ *
+ * @brief   Log-linear histogram in the style of HdrHistogram. Values below
+ *          HIST_SUB_BUCKETS each get their own bucket; above that, every power
+ *          of 2 is split into HIST_SUB_BUCKETS equal buckets, so recording is a
+ *          couple of shifts and the relative error stays constant.
+ *
+ ****************************************************************************************/
+
+#include <string.h>
+
+#include "main.h"
+#include "histogram.h"
+
+//********************* Local function prototypes ****************************//
+STATIC uint16_t getBucket(uint64_t value);
+STATIC uint64_t getBucketLimit(uint16_t bucket);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Reset histogram
+ **     Remove all samples
+ **
+ ** @param histogram: histogram to reset
+ **
+ ** @return none
+******************************************************************************/
+void HIST_reset(histogram_t* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+ /*****************************************************************************
+ ** @brief Record value
+ **
+ ** @param histogram: histogram to record into
+ ** @param value: sample to record
+ **
+ ** @return none
+******************************************************************************/
+void HIST_record(histogram_t* histogram, uint64_t value)
+{
+    histogram->counts[getBucket(value)]++;
+    histogram->total++;
+    if(value > histogram->max)
+    {
+        histogram->max = value;
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Merge histograms
+ **     Add every sample of one histogram to another
+ **
+ ** @param dest: histogram to add to
+ ** @param src: histogram to add
+ **
+ ** @return none
+******************************************************************************/
+void HIST_merge(histogram_t* dest, const histogram_t* src)
+{
+    for(uint16_t i = 0; i < HIST_BUCKETS; i++)
+    {
+        dest->counts[i] += src->counts[i];
+    }
+    dest->total += src->total;
+    if(src->max > dest->max)
+    {
+        dest->max = src->max;
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Get percentile
+ **     Get the value at or below which the given percentage of samples fall,
+ **     rounded up to the top of its bucket
+ **
+ ** @param histogram: histogram to query
+ ** @param percentile: percentage of samples, 0 to 100
+ **
+ ** @return value at the percentile, 0 if the histogram is empty
+******************************************************************************/
+uint64_t HIST_percentile(const histogram_t* histogram, double percentile)
+{
+    uint64_t rank;
+    uint64_t count = 0;
+    uint64_t limit;
+    
+    if(!histogram->total)
+    {
+        return 0;
+    }
+    
+    //number of samples that must be at or below the result, rounded to absorb floating point error
+    rank = (uint64_t)(((percentile / 100.0) * (double)histogram->total) + 0.5);
+    if(!rank)
+    {
+        rank = 1;
+    }
+    
+    for(uint16_t i = 0; i < HIST_BUCKETS; i++)
+    {
+        count += histogram->counts[i];
+        if(count >= rank)
+        {
+            limit = getBucketLimit(i);
+            return (limit < histogram->max) ? limit : histogram->max;
+        }
+    }
+    
+    return histogram->max;
+}
+
+ /*****************************************************************************
+ ** @brief Print histogram
+ **     Print the sample count, common percentiles and maximum
+ **
+ ** @param histogram: histogram to print
+ ** @param name: label for the values
+ **
+ ** @return none
+******************************************************************************/
+void HIST_print(const histogram_t* histogram, const char* name)
+{
+    printf("%s: %llu samples, p50 %llu, p99 %llu, p99.9 %llu, max %llu\n", name,
+           (unsigned long long)histogram->total,
+           (unsigned long long)HIST_percentile(histogram, 50.0),
+           (unsigned long long)HIST_percentile(histogram, 99.0),
+           (unsigned long long)HIST_percentile(histogram, 99.9),
+           (unsigned long long)histogram->max);
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Get bucket
+ **     Find the bucket index of a value
+ **
+ ** @param value: sample value
+ **
+ ** @return bucket index
+******************************************************************************/
+STATIC uint16_t getBucket(uint64_t value)
+{
+    uint8_t group;
+    
+    if(value < HIST_SUB_BUCKETS)
+    {
+        return (uint16_t)value;
+    }
+    if(value >= (UINT64_C(1) << HIST_MAX_BITS))
+    {
+        return HIST_BUCKETS - 1;
+    }
+    
+    //values in [SUB << (group - 1), SUB << group) are split into SUB buckets of 2^(group - 1)
+    group = (uint8_t)(64 - __builtin_clzll(value) - HIST_SUB_BITS);
+    
+    return (uint16_t)(((group - 1) * HIST_SUB_BUCKETS) + (value >> (group - 1)));
+}
+
+ /*****************************************************************************
+ ** @brief Get bucket limit
+ **     Get the largest value that falls in a bucket
+ **
+ ** @param bucket: bucket index
+ **
+ ** @return largest value of the bucket
+******************************************************************************/
+STATIC uint64_t getBucketLimit(uint16_t bucket)
+{
+    uint8_t group = (uint8_t)(bucket / HIST_SUB_BUCKETS);
+    uint64_t sub = bucket % HIST_SUB_BUCKETS;
+    
+    if(!group)
+    {
+        return sub;
+    }
+    if(bucket == HIST_BUCKETS - 1)
+    {
+        return UINT64_MAX;
+    }
+    
+    return ((HIST_SUB_BUCKETS + sub + 1) << (group - 1)) - 1;
+}
@@ -0,0 +1,36 @@
+/***************************************************************************************
+ * @file    histogram.h
+ * @date    October 18th 2026
+ *
+ * @brief   Log-linear histogram header
+ *
+ ****************************************************************************************/
+
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include "main.h"
+
+#define HIST_SUB_BITS           4                           //log2 of buckets per power of 2 (~6% precision)
+#define HIST_SUB_BUCKETS        (1 << HIST_SUB_BITS)
+#define HIST_MAX_BITS           24                          //values of 2^24 and above share the last bucket
+#define HIST_BUCKETS            ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS)
+
+//fixed memory histogram of non-negative values
+typedef struct histogram
+{
+    uint64_t counts[HIST_BUCKETS];  //samples in each bucket, as wide as the total
+    uint64_t total;                 //number of samples
+    uint64_t max;                   //largest sample
+} histogram_t;
+
+//********************* Public function prototypes ****************************//
+
+void HIST_reset(histogram_t* histogram);
+void HIST_record(histogram_t* histogram, uint64_t value);
+void HIST_merge(histogram_t* dest, const histogram_t* src);
+uint64_t HIST_percentile(const histogram_t* histogram, double percentile);
+void HIST_print(const histogram_t* histogram, const char* name);
+
+
+#endif //_HISTOGRAM_H_
@@ -0,0 +1,444 @@
+/***************************************************************************************
+ * @file    image.c
+ * @date    October 18th 2026
+ *
+ * @brief   Precompiled intersection images. An image holds fully parsed light
+ *          sets for one or more intersections in a byte oriented layout of
+ *          fixed size set records followed by a table of their steps, so
+ *          loading one is a bounds and checksum check followed by plain
+ *          copies; no JSON parsing or string comparisons. Images are portable
+ *          between hosts: every field is a byte array and integers are little
+ *          endian.
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for rename
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "image.h"
+#include "patternPool.h"
+
+//********************* Local function prototypes ****************************//
+STATIC uint64_t getChecksum(const uint8_t* data, size_t length);
+STATIC uint64_t readLE(const uint8_t* bytes, uint8_t size);
+STATIC void writeLE(uint8_t* bytes, uint8_t size, uint64_t value);
+
+//************************* Function pointers ********************************//
+STATIC void* (*imageMalloc_ptr)(size_t) = malloc;     //function ptr for mocking
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Is image
+ **     Check whether a buffer starts like an image. JSON configs cannot.
+ **
+ ** @param data: buffer to check
+ ** @param length: length of the buffer
+ **
+ ** @return true if the buffer starts with the image magic
+******************************************************************************/
+bool IMG_isImage(const void* data, size_t length)
+{
+    return (length >= IMG_MAGIC_SIZE) && !memcmp(data, IMG_MAGIC, IMG_MAGIC_SIZE);
+}
+
+ /*****************************************************************************
+ ** @brief Image size
+ **
+ ** @param count: number of intersections
+ ** @param steps: number of steps in the patterns of all their light sets
+ **
+ ** @return size in bytes of an image holding the intersections
+******************************************************************************/
+size_t IMG_size(uint32_t count, uint32_t steps)
+{
+    return sizeof(imgHeader_t) + (size_t)count * INT_DIRECTIONS * sizeof(imgLightSet_t) + (size_t)steps * sizeof(imgStep_t);
+}
+
+ /*****************************************************************************
+ ** @brief Count steps
+ **
+ ** @param configs: intersection configs
+ ** @param count: number of intersections
+ **
+ ** @return number of steps in the patterns of all their light sets
+******************************************************************************/
+uint32_t IMG_countSteps(const intConfig_t* configs, uint32_t count)
+{
+    uint32_t steps = 0;
+    
+    for(uint32_t intersection = 0; intersection < count; intersection++)
+    {
+        for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+        {
+            steps += configs[intersection].lightSets[direction].pattern->count;
+        }
+    }
+    
+    return steps;
+}
+
+ /*****************************************************************************
+ ** @brief Check image
+ **     Validate the header, size, checksum and stored enum values of an
+ **     image. Images that pass can be decoded without further checks.
+ **
+ ** @param data: image
+ ** @param length: length of the image
+ ** @param count: destination for the number of intersections, may be NULL
+ **
+ ** @return error code
+******************************************************************************/
+error_t IMG_check(const void* data, size_t length, uint32_t* count)
+{
+    const imgHeader_t* header = data;
+    const imgLightSet_t* sets = (const imgLightSet_t*)(header + 1);
+    const imgStep_t* steps;
+    uint32_t intersections;
+    uint32_t stepCount;
+    
+    if((length < sizeof(imgHeader_t)) || !IMG_isImage(data, length))
+    {
+        printf("Not an intersection image\n");
+        return ERR_format;
+    }
+    
+    //images built for other layouts cannot be used
+    if((readLE(header->version, sizeof(header->version)) != IMG_VERSION) || (header->directions != INT_DIRECTIONS) ||
+       (header->lights != MAX_LIGHTS_IN_SET) || (header->steps > MAX_STEPS_IN_PATTERN))
+    {
+        printf("Unsupported image version %u\n", (unsigned)readLE(header->version, sizeof(header->version)));
+        return ERR_format;
+    }
+    
+    intersections = (uint32_t)readLE(header->count, sizeof(header->count));
+    stepCount = (uint32_t)readLE(header->stepCount, sizeof(header->stepCount));
+    if(IMG_size(intersections, stepCount) != length)
+    {
+        printf("Image size %zu does not match its %u intersections and %u steps\n", length, intersections, stepCount);
+        return ERR_format;
+    }
+    
+    if(getChecksum((const uint8_t*)sets, length - sizeof(imgHeader_t)) != readLE(header->checksum, sizeof(header->checksum)))
+    {
+        printf("Image checksum mismatch\n");
+        return ERR_format;
+    }
+    
+    for(size_t set = 0; set < (size_t)intersections * INT_DIRECTIONS; set++)
+    {
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            if(sets[set].lightTypes[i] >= LDT_numTypes)
+            {
+                printf("Invalid light type %u in image\n", sets[set].lightTypes[i]);
+                return ERR_value;
+            }
+        }
+        if((sets[set].steps > header->steps) ||
+           (readLE(sets[set].firstStep, sizeof(sets[set].firstStep)) + sets[set].steps > stepCount))
+        {
+            printf("Invalid pattern of %u steps in image\n", sets[set].steps);
+            return ERR_value;
+        }
+    }
+    
+    steps = (const imgStep_t*)&sets[(size_t)intersections * INT_DIRECTIONS];
+    for(uint32_t step = 0; step < stepCount; step++)
+    {
+        if(steps[step].state >= LSS_unused)
+        {
+            printf("Invalid step state %u in image\n", steps[step].state);
+            return ERR_value;
+        }
+    }
+    
+    if(count)
+    {
+        *count = intersections;
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Decode image
+ **     Copy the light sets of one intersection into a config, interning their
+ **     patterns in the default pattern pool. Only the lights and patterns are
+ **     written, as when parsing a JSON config.
+ **
+ ** @param data: image that passed IMG_check
+ ** @param index: intersection to decode, less than the image's count
+ ** @param config: intersection config into which the light sets are saved
+ **
+ ** @return error code
+******************************************************************************/
+error_t IMG_decode(const void* data, uint32_t index, intConfig_t* config)
+{
+    const imgHeader_t* header = data;
+    const imgLightSet_t* sets = (const imgLightSet_t*)(header + 1);
+    const imgStep_t* steps = (const imgStep_t*)&sets[readLE(header->count, sizeof(header->count)) * INT_DIRECTIONS];
+    lightSetStep_t pattern[MAX_STEPS_IN_PATTERN];
+    const setPattern_t* patterns[INT_DIRECTIONS];
+    const imgStep_t* step;
+    
+    sets += (size_t)index * INT_DIRECTIONS;
+    
+    //intern every pattern first, so the config is left as it was on failure
+    for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+    {
+        step = &steps[readLE(sets[direction].firstStep, sizeof(sets[direction].firstStep))];
+        for(uint8_t i = 0; i < sets[direction].steps; i++)
+        {
+            pattern[i].state = (lightSetState_t)step[i].state;
+            pattern[i].expirationOffset = (uint64_t)(int64_t)(int32_t)readLE(step[i].expirationOffset, sizeof(step[i].expirationOffset));
+        }
+        patterns[direction] = PAT_intern(PAT_getDefault(), pattern, sets[direction].steps);
+        if(!patterns[direction])
+        {
+            return ERR_mem;
+        }
+    }
+    
+    for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+    {
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            config->lightSets[direction].lights[i].type = (lightDisplayType_t)sets[direction].lightTypes[i];
+            config->lightSets[direction].lights[i].state = LS_red;
+        }
+        config->lightSets[direction].pattern = patterns[direction];
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Encode image
+ **     Build an image of the given intersections
+ **
+ ** @param data: destination of IMG_size(count, IMG_countSteps(configs, count))
+ **     bytes
+ ** @param configs: intersection configs
+ ** @param count: number of intersections
+ **
+ ** @return none
+******************************************************************************/
+void IMG_encode(void* data, const intConfig_t* configs, uint32_t count)
+{
+    imgHeader_t* header = data;
+    imgLightSet_t* sets = (imgLightSet_t*)(header + 1);
+    imgStep_t* steps = (imgStep_t*)&sets[(size_t)count * INT_DIRECTIONS];
+    uint32_t stepCount = IMG_countSteps(configs, count);
+    uint32_t firstStep = 0;
+    uint8_t longest = 0;
+    const setPattern_t* pattern;
+    const lightSet_t* set;
+    
+    memset(data, 0, IMG_size(count, stepCount));
+    
+    for(uint32_t intersection = 0; intersection < count; intersection++)
+    {
+        for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++, sets++)
+        {
+            set = &configs[intersection].lightSets[direction];
+            pattern = set->pattern;
+            for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+            {
+                sets->lightTypes[i] = (uint8_t)set->lights[i].type;
+            }
+            writeLE(sets->firstStep, sizeof(sets->firstStep), firstStep);
+            sets->steps = pattern->count;
+            for(uint8_t i = 0; i < pattern->count; i++, steps++)
+            {
+                steps->state = pattern->states[i];
+                writeLE(steps->expirationOffset, sizeof(steps->expirationOffset), pattern->offsets[i]);
+            }
+            firstStep += pattern->count;
+            if(pattern->count > longest)
+            {
+                longest = pattern->count;
+            }
+        }
+    }
+    
+    memcpy(header->magic, IMG_MAGIC, IMG_MAGIC_SIZE);
+    writeLE(header->version, sizeof(header->version), IMG_VERSION);
+    header->directions = INT_DIRECTIONS;
+    header->lights = MAX_LIGHTS_IN_SET;
+    header->steps = longest;
+    writeLE(header->count, sizeof(header->count), count);
+    writeLE(header->stepCount, sizeof(header->stepCount), stepCount);
+    writeLE(header->checksum, sizeof(header->checksum), getChecksum((const uint8_t*)(header + 1), IMG_size(count, stepCount) - sizeof(imgHeader_t)));
+}
+
+ /*****************************************************************************
+ ** @brief Write image
+ **     Encode intersections into an image file. The image is written next to
+ **     the destination and renamed over it, so readers never see a partial
+ **     image.
+ **
+ ** @param filepath: path of the image file
+ ** @param configs: intersection configs
+ ** @param count: number of intersections
+ **
+ ** @return error code
+******************************************************************************/
+error_t IMG_write(const char* filepath, const intConfig_t* configs, uint32_t count)
+{
+    size_t size = IMG_size(count, IMG_countSteps(configs, count));
+    size_t pathLength = strlen(filepath);
+    char* tempPath;
+    uint8_t* data;
+    FILE* file;
+    error_t result = ERR_success;
+    
+    data = imageMalloc_ptr(size + pathLength + sizeof(".tmp"));
+    if(!data)
+    {
+        printf("Failed to allocate memory for image\n");
+        return ERR_mem;
+    }
+    tempPath = (char*)&data[size];
+    memcpy(tempPath, filepath, pathLength);
+    memcpy(&tempPath[pathLength], ".tmp", sizeof(".tmp"));
+    
+    IMG_encode(data, configs, count);
+    
+    file = fopen(tempPath, "wb");
+    if(!file)
+    {
+        printf("Failed to open %s\n", tempPath);
+        free(data);
+        return ERR_file;
+    }
+    if(fwrite(data, 1, size, file) != size)
+    {
+        printf("Failed to write %s\n", tempPath);
+        result = ERR_file;
+    }
+    if(fclose(file) && (result == ERR_success))
+    {
+        printf("Failed to write %s\n", tempPath);
+        result = ERR_file;
+    }
+    
+    if(result == ERR_success)
+    {
+        if(rename(tempPath, filepath))
+        {
+            printf("Failed to rename %s to %s\n", tempPath, filepath);
+            result = ERR_file;
+        }
+    }
+    if(result != ERR_success)
+    {
+        remove(tempPath);
+    }
+    
+    free(data);
+    
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Hash
+ **     Fast 64-bit hash of a buffer, eight bytes per multiply. Words are read
+ **     in host byte order, so hashes are only comparable on the same kind of
+ **     host; use the image checksum for anything that leaves it.
+ **
+ ** @param data: bytes to hash
+ ** @param length: number of bytes
+ **
+ ** @return hash
+******************************************************************************/
+uint64_t IMG_hash(const void* data, size_t length)
+{
+    const uint8_t* bytes = data;
+    uint64_t hash = IMG_HASH_SEED ^ ((uint64_t)length * IMG_HASH_MULTIPLIER);
+    uint64_t word;
+    
+    for(; length >= sizeof(word); bytes += sizeof(word), length -= sizeof(word))
+    {
+        memcpy(&word, bytes, sizeof(word));
+        hash = (hash ^ word) * IMG_HASH_MULTIPLIER;
+        hash ^= hash >> 32;
+    }
+    if(length)
+    {
+        word = 0;
+        memcpy(&word, bytes, length);
+        hash = (hash ^ word) * IMG_HASH_MULTIPLIER;
+    }
+    
+    //mix the last words into every bit
+    hash ^= hash >> 33;
+    hash *= IMG_HASH_FINALIZER;
+    hash ^= hash >> 33;
+    
+    return hash;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Get checksum
+ **     64-bit FNV-1a hash
+ **
+ ** @param data: bytes to hash
+ ** @param length: number of bytes
+ **
+ ** @return hash
+******************************************************************************/
+STATIC uint64_t getChecksum(const uint8_t* data, size_t length)
+{
+    uint64_t hash = IMG_FNV_OFFSET;
+    
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= data[i];
+        hash *= IMG_FNV_PRIME;
+    }
+    
+    return hash;
+}
+
+ /*****************************************************************************
+ ** @brief Read little endian
+ **
+ ** @param bytes: little endian integer
+ ** @param size: number of bytes, at most 8
+ **
+ ** @return host integer
+******************************************************************************/
+STATIC uint64_t readLE(const uint8_t* bytes, uint8_t size)
+{
+    uint64_t value = 0;
+    
+    while(size--)
+    {
+        value = (value << 8) | bytes[size];
+    }
+    
+    return value;
+}
+
+ /*****************************************************************************
+ ** @brief Write little endian
+ **
+ ** @param bytes: destination
+ ** @param size: number of bytes, at most 8
+ ** @param value: host integer
+ **
+ ** @return none
+******************************************************************************/
+STATIC void writeLE(uint8_t* bytes, uint8_t size, uint64_t value)
+{
+    for(uint8_t i = 0; i < size; i++)
+    {
+        bytes[i] = (uint8_t)value;
+        value >>= 8;
+    }
+}
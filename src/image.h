@@ -0,0 +1,68 @@
+/***************************************************************************************
+ * @file    image.h
+ * @date    October 18th 2026
+ *
+ * @brief   Precompiled intersection image header
+ *
+ ****************************************************************************************/
+
+#ifndef _IMAGE_H_
+#define _IMAGE_H_
+
+#include <stddef.h>
+
+#include "main.h"
+#include "config.h"
+
+#define IMG_MAGIC               "NJTI"      //first bytes of every image
+#define IMG_MAGIC_SIZE          4
+#define IMG_VERSION             2           //bumped whenever the layout or an enum stored in it changes
+#define IMG_FNV_OFFSET          UINT64_C(0xcbf29ce484222325)
+#define IMG_FNV_PRIME           UINT64_C(0x100000001b3)
+#define IMG_HASH_SEED           UINT64_C(0x9e3779b97f4a7c15)    //content hash constants (golden ratio and murmur3 finalizer)
+#define IMG_HASH_MULTIPLIER     UINT64_C(0xff51afd7ed558ccd)
+#define IMG_HASH_FINALIZER      UINT64_C(0xc4ceb9fe1a85ec53)
+
+//image header; multi-byte fields are little endian
+typedef struct imgheader
+{
+    uint8_t magic[IMG_MAGIC_SIZE];
+    uint8_t version[2];
+    uint8_t directions;                                 //light sets per intersection
+    uint8_t lights;                                     //lights per set
+    uint8_t steps;                                      //steps in the longest pattern
+    uint8_t reserved[3];
+    uint8_t count[4];                                   //number of intersections
+    uint8_t stepCount[4];                               //number of step records
+    uint8_t checksum[8];                                //FNV-1a of everything after the header
+} imgHeader_t;
+
+//light set record; an intersection is INT_DIRECTIONS records in intDirection_t order,
+//and the step records of every set follow the last intersection
+typedef struct imglightset
+{
+    uint8_t firstStep[4];                               //index of the set's first step record
+    uint8_t lightTypes[MAX_LIGHTS_IN_SET];              //lightDisplayType_t
+    uint8_t steps;                                      //number of steps in the set's pattern
+} imgLightSet_t;
+
+//step record, as packed into a pattern
+typedef struct imgstep
+{
+    uint8_t expirationOffset[4];
+    uint8_t state;                                      //lightSetState_t
+} imgStep_t;
+
+//********************* Public function prototypes ****************************//
+
+bool IMG_isImage(const void* data, size_t length);
+size_t IMG_size(uint32_t count, uint32_t steps);
+uint32_t IMG_countSteps(const intConfig_t* configs, uint32_t count);
+error_t IMG_check(const void* data, size_t length, uint32_t* count);
+error_t IMG_decode(const void* data, uint32_t index, intConfig_t* config);
+void IMG_encode(void* data, const intConfig_t* configs, uint32_t count);
+error_t IMG_write(const char* filepath, const intConfig_t* configs, uint32_t count);
+uint64_t IMG_hash(const void* data, size_t length);
+
+
+#endif //_IMAGE_H_
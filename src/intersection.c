@@ -9,31 +9,42 @@
 
 #include <time.h>
 #include <string.h>
+#include <stdlib.h>
+#include <signal.h>
 
 #include "main.h"
 #include "intersection.h"
 #include "config.h"
 #include "lightSet.h"
 #include "display.h"
+#include "eventLoop.h"
+#include "configReloader.h"
 
 //*********************** Static variables ***********************************//
-STATIC intState_t intState = IS_off;        //currently active directions of the intersection
-STATIC const lightSetStep_t errorSteps[MAX_STEPS_IN_PATTERN] = PATTERN_FLASH_RED;    //error pattern
+STATIC intersection_t defaultIntersection = INTERSECTION_INIT;     //intersection driven by the non-context API
+STATIC histogram_t defaultStepLateness;     //step change lateness of the default intersection
+STATIC const setPattern_t errorPattern = PATTERN_FLASH_RED;    //error pattern
 
 //********************* Local function prototypes ****************************//
 STATIC uint64_t getMillis(void);
-STATIC error_t toggleActiveDirection(uint64_t millis);
-STATIC error_t changeActiveDirection(intState_t state, uint64_t millis);
+STATIC void eventLoopTimerHandler(int fd, void* arg);
+STATIC void eventLoopStopHandler(int signo, void* arg);
+STATIC void eventLoopDumpHandler(int signo, void* arg);
+STATIC uint64_t getCycleAnchor(intersection_t* intersection, uint64_t millis);
+STATIC error_t toggleActiveDirection(intersection_t* intersection, uint64_t millis);
+STATIC error_t changeActiveDirection(intersection_t* intersection, intState_t state, uint64_t millis);
+STATIC void packLightSets(intersection_t* intersection);
 
 //************************* Function pointers ********************************//
-STATIC error_t (*changeActiveDirection_ptr)(intState_t, uint64_t) = changeActiveDirection;  //function ptr for mocking
-STATIC lightSet_t* (*CFG_getLightSet_ptr)(intDirection_t) = CFG_getLightSet;                //function ptr for mocking
+STATIC error_t (*changeActiveDirection_ptr)(intersection_t*, intState_t, uint64_t) = changeActiveDirection;  //function ptr for mocking
+STATIC lightSet_t* (*CFG_getLightSet_ptr)(intConfig_t*, intDirection_t) = CFG_getLightSet;                  //function ptr for mocking
 
 //************************ Public functions *********************************//
 
  /*****************************************************************************
  ** @brief Intersection initialization
- **     Simply initializes the intersection configuration
+ **     Simply initializes the default intersection's configuration and
+ **     records its step lateness
  **
  ** @param filepath: path to config file
  **
@@ -41,44 +52,373 @@ STATIC lightSet_t* (*CFG_getLightSet_ptr)(intDirection_t) = CFG_getLightSet;
 ******************************************************************************/
 error_t INT_init(char* filepath)
 {
-    return CFG_init(filepath);
+    defaultIntersection.sets.lateness = &defaultStepLateness;
+    
+    return INT_initCtx(&defaultIntersection, filepath);
 }
 
  /*****************************************************************************
  ** @brief Intersection state machine
- **     Clocks the intersection state machine, initializing to North-South,
- **     then switching between that and East-West when each direction's pattern
- **     has reached its end state.
+ **     Clocks the default intersection's state machine
  **
  ** @param none
  **
  ** @return none
 ******************************************************************************/
 void INT_stateMachine(void)
-{   
-    uint64_t millis = getMillis();   
+{
+    INT_stateMachineCtx(&defaultIntersection);
+}
+
+ /*****************************************************************************
+ ** @brief Next deadline
+ **     Get the time of the default intersection's next light change
+ **
+ ** @param none
+ **
+ ** @return mS since epoch of the next light change, 0 if the state machine
+ **     should be clocked immediately
+******************************************************************************/
+uint64_t INT_nextDeadline(void)
+{
+    return INT_nextDeadlineCtx(&defaultIntersection);
+}
+
+ /*****************************************************************************
+ ** @brief Wait for next transition
+ **     Sleep until the default intersection's next light change
+ **
+ ** @param none
+ **
+ ** @return none
+******************************************************************************/
+void INT_waitForNextTransition(void)
+{
+    INT_waitForNextTransitionCtx(&defaultIntersection);
+}
+
+ /*****************************************************************************
+ ** @brief Run event loop
+ **     Drive the default intersection from an epoll event loop
+ **
+ ** @param none
+ **
+ ** @return error code
+******************************************************************************/
+error_t INT_runEventLoop(void)
+{
+    return INT_runEventLoopCtx(&defaultIntersection);
+}
 
-    switch(intState)
+ /*****************************************************************************
+ ** @brief Get default intersection
+ **     Get the intersection driven by the functions that take no context
+ **
+ ** @param none
+ **
+ ** @return pointer to default intersection
+******************************************************************************/
+intersection_t* INT_getDefault(void)
+{
+    return &defaultIntersection;
+}
+
+ /*****************************************************************************
+ ** @brief Print lateness
+ **     Print the timing statistics of the default intersection
+ **
+ ** @param none
+ **
+ ** @return none
+******************************************************************************/
+void INT_printLateness(void)
+{
+    INT_printLatenessCtx(&defaultIntersection);
+}
+
+ /*****************************************************************************
+ ** @brief Get lamps
+ **     Get the lamp board of the default intersection
+ **
+ ** @param none
+ **
+ ** @return lamp board of every direction
+******************************************************************************/
+uint64_t INT_getLamps(void)
+{
+    return INT_getLampsCtx(&defaultIntersection);
+}
+
+ /*****************************************************************************
+ ** @brief Get arrows
+ **     Get the arrow mask of the default intersection's lamp board
+ **
+ ** @param none
+ **
+ ** @return arrow lamps of every direction
+******************************************************************************/
+uint64_t INT_getArrows(void)
+{
+    return INT_getArrowsCtx(&defaultIntersection);
+}
+
+ /*****************************************************************************
+ ** @brief Lamps conflict
+ **     Check a lamp board for traffic let into the intersection from two
+ **     directions that cross, by a green light or a yellow arrow in both
+ **     North-South and East-West
+ **
+ ** @param lamps: lamp board of an intersection
+ **
+ ** @return true if crossing directions may both enter
+******************************************************************************/
+bool INT_lampsConflict(uint64_t lamps)
+{
+    uint64_t greens = lamps & SET_BOARD_GREENS;
+    
+    return (greens & INT_LANES_NS) && (greens & INT_LANES_EW);
+}
+
+ /*****************************************************************************
+ ** @brief Intersection initialization
+ **     Initializes the intersection configuration and attaches the lamp
+ **     board. New contexts must be initialized with INTERSECTION_INIT
+ **     beforehand. Step lateness is recorded in the histograms attached as
+ **     sets.lateness and sets.ownLateness, if any; they are kept out of the
+ **     intersection so fleets can share one per fleet or worker and attach
+ **     per-intersection ones only when asked to.
+ **
+ ** @param intersection: intersection to initialize
+ ** @param filepath: path to config file
+ **
+ ** @return error code
+******************************************************************************/
+error_t INT_initCtx(intersection_t* intersection, char* filepath)
+{
+    error_t result;
+    
+    intersection->sets.board = &intersection->lamps;
+    
+    result = CFG_init(&intersection->config, filepath);
+    packLightSets(intersection);
+    
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Intersection state machine
+ **     Clocks the intersection state machine at the current time and prints
+ **     any light changes.
+ **
+ ** @param intersection: intersection to clock
+ **
+ ** @return none
+******************************************************************************/
+void INT_stateMachineCtx(intersection_t* intersection)
+{
+    INT_clockCtx(intersection, getMillis());
+    
+    DISP_printLightStates(&intersection->display, intersection->lightSets, intersection->lamps);
+}
+
+ /*****************************************************************************
+ ** @brief Clock intersection
+ **     Clocks the intersection state machine, initializing to North-South,
+ **     then switching between that and East-West when each direction's pattern
+ **     has reached its end state. Each new pattern starts when the previous
+ **     one was scheduled to end, so clocking late does not shift later cycles.
+ **
+ ** @param intersection: intersection to clock
+ ** @param millis: current mS since epoch
+ **
+ ** @return none
+******************************************************************************/
+void INT_clockCtx(intersection_t* intersection, uint64_t millis)
+{
+    switch(intersection->state)
     {
         case IS_ns:
         case IS_ew:
-            if(SET_stateMachine(millis) == LSS_end)
+            if(SET_stateMachine(&intersection->sets, millis) == LSS_end)
             {
-                if(toggleActiveDirection(millis) != ERR_success)
+                if(toggleActiveDirection(intersection, getCycleAnchor(intersection, millis)) != ERR_success)
                 {
-                    changeActiveDirection(IS_error, millis);
+                    changeActiveDirection(intersection, IS_error, millis);
                 }
             }
             break;
         default:
-            if(changeActiveDirection_ptr(IS_ns, millis) != ERR_success)
+            if(changeActiveDirection_ptr(intersection, IS_ns, millis) != ERR_success)
             {
-                changeActiveDirection(IS_error, millis);
+                changeActiveDirection(intersection, IS_error, millis);
             }
             break;
     }
+}
+
+ /*****************************************************************************
+ ** @brief Next deadline
+ **     Get the time at which INT_stateMachineCtx() next has work to do: the
+ **     earliest step expiration of the active light sets or, once they have
+ **     finished their patterns, the North-South/East-West toggle, which is
+ **     due immediately. Clocking the state machine before this time has no
+ **     effect.
+ **
+ ** @param intersection: intersection to query
+ **
+ ** @return mS since epoch of the next light change, 0 if the state machine
+ **     should be clocked immediately
+******************************************************************************/
+uint64_t INT_nextDeadlineCtx(intersection_t* intersection)
+{
+    uint64_t deadline;
+    
+    //the off and error states change on the very next clock
+    if((intersection->state != IS_ns) && (intersection->state != IS_ew))
+    {
+        return 0;
+    }
     
-    DISP_printLightStates();
+    //no pending expiration means the active sets are finished; toggle immediately
+    deadline = SET_nextDeadline(&intersection->sets);
+    if(deadline == SET_NO_DEADLINE)
+    {
+        return 0;
+    }
+    
+    return deadline;
+}
+
+ /*****************************************************************************
+ ** @brief Wait for next transition
+ **     Sleep until the next time INT_stateMachineCtx() has work to do. The
+ **     absolute deadline is taken from the active light sets and slept on with
+ **     CLOCK_MONOTONIC, the same clock getMillis() reads, so clocking the state
+ **     machine on return produces exactly the transitions that busy polling
+ **     would have. A signal ends the wait early so the caller can act on
+ **     what its handler requested, such as a SIGUSR1 statistics dump;
+ **     clocking the state machine early has no effect.
+ **
+ ** @param intersection: intersection to wait on
+ **
+ ** @return none
+******************************************************************************/
+void INT_waitForNextTransitionCtx(intersection_t* intersection)
+{
+    uint64_t deadline = INT_nextDeadlineCtx(intersection);
+    struct timespec ts;
+    
+    ts.tv_sec = (time_t)(deadline / 1000);
+    ts.tv_nsec = (long)((deadline % 1000) * 1000000);
+    
+    //returns immediately if the deadline has already passed, and on EINTR
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+ /*****************************************************************************
+ ** @brief Run event loop
+ **     Drive the intersection from an epoll event loop instead of polling.
+ **     A timerfd is armed for the next light change, SIGINT/SIGTERM stop
+ **     the loop and SIGUSR1 prints the timing statistics. Other fds can be
+ **     added to the loop with EVT_addFd() from their handlers.
+ **
+ ** @param intersection: intersection to drive
+ **
+ ** @return error code
+******************************************************************************/
+error_t INT_runEventLoopCtx(intersection_t* intersection)
+{
+    error_t result;
+    
+    result = EVT_init();
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
+    //clock the state machine on the first wakeup
+    result = EVT_setTimer(eventLoopTimerHandler, intersection);
+    if(result == ERR_success)
+    {
+        result = EVT_armTimer(0);
+    }
+    if(result == ERR_success)
+    {
+        result = EVT_addSignal(SIGINT, eventLoopStopHandler, NULL);
+    }
+    if(result == ERR_success)
+    {
+        result = EVT_addSignal(SIGTERM, eventLoopStopHandler, NULL);
+    }
+    if(result == ERR_success)
+    {
+        result = EVT_addSignal(SIGUSR1, eventLoopDumpHandler, intersection);
+    }
+    if(result == ERR_success)
+    {
+        result = EVT_run();
+    }
+    
+    EVT_close();
+    
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Print lateness
+ **     Print how late step and direction changes were clocked compared to
+ **     their scheduled times. Steps are taken from the intersection's own
+ **     histogram if it has one, or else from the one it shares.
+ **
+ ** @param intersection: intersection to print
+ **
+ ** @return none
+******************************************************************************/
+void INT_printLatenessCtx(intersection_t* intersection)
+{
+    if(intersection->sets.ownLateness)
+    {
+        HIST_print(intersection->sets.ownLateness, "Step change lateness (mS)");
+    }
+    else if(intersection->sets.lateness)
+    {
+        HIST_print(intersection->sets.lateness, "Step change lateness (mS)");
+    }
+    printf("Direction change lateness: last %llu mS, max %llu mS, %u resyncs\n",
+           (unsigned long long)intersection->lateness,
+           (unsigned long long)intersection->maxLateness, intersection->resyncs);
+}
+
+ /*****************************************************************************
+ ** @brief Get lamps
+ **     Get the lamp board of an intersection: the lamps of every direction
+ **     in one word, in the lane of their intDirection_t. Copying it is a
+ **     consistent snapshot, and the XOR of two snapshots is every lamp that
+ **     changed between them.
+ **
+ ** @param intersection: intersection to query
+ **
+ ** @return lamp board of every direction
+******************************************************************************/
+uint64_t INT_getLampsCtx(const intersection_t* intersection)
+{
+    return intersection->lamps;
+}
+
+ /*****************************************************************************
+ ** @brief Get arrows
+ **     Get the arrow mask of an intersection's lamp board: every colour bit
+ **     of each arrow lamp. The lamp board holds colours only, so this tells
+ **     a green arrow, a protected turn, from a solid green. It changes only
+ **     when a new config is applied.
+ **
+ ** @param intersection: intersection to query
+ **
+ ** @return arrow lamps of every direction
+******************************************************************************/
+uint64_t INT_getArrowsCtx(const intersection_t* intersection)
+{
+    return intersection->arrows;
 }
 
 //************************* Local functions *********************************//
@@ -100,27 +440,136 @@ STATIC uint64_t getMillis(void)
     return (((uint64_t)(ts.tv_sec) * 1000) + (ts.tv_nsec / 1000000));
 }
 
+ /*****************************************************************************
+ ** @brief Event loop timer handler
+ **     Clock the state machine and re-arm the timer for the next light change
+ **
+ ** @param fd: timer fd
+ ** @param arg: intersection driven by the loop
+ **
+ ** @return none
+******************************************************************************/
+STATIC void eventLoopTimerHandler(int fd, void* arg)
+{
+    intersection_t* intersection = arg;
+    
+    (void)fd;
+    
+    INT_stateMachineCtx(intersection);
+    
+    if(EVT_armTimer(INT_nextDeadlineCtx(intersection)) != ERR_success)
+    {
+        EVT_stop();
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Event loop stop handler
+ **     Stop the event loop when a termination signal is received
+ **
+ ** @param signo: received signal
+ ** @param arg: unused
+ **
+ ** @return none
+******************************************************************************/
+STATIC void eventLoopStopHandler(int signo, void* arg)
+{
+    (void)arg;
+    
+    printf("Received signal %d, stopping\n", signo);
+    EVT_stop();
+}
+
+ /*****************************************************************************
+ ** @brief Event loop dump handler
+ **     Print the timing statistics when requested by a signal
+ **
+ ** @param signo: received signal
+ ** @param arg: intersection driven by the loop
+ **
+ ** @return none
+******************************************************************************/
+STATIC void eventLoopDumpHandler(int signo, void* arg)
+{
+    (void)signo;
+    
+    INT_printLatenessCtx(arg);
+}
+
+ /*****************************************************************************
+ ** @brief Get cycle anchor
+ **     Get the start time for the next pattern: the time the finished pattern
+ **     was scheduled to end. The lateness of the clock is recorded. Patterns
+ **     that ended more than INT_MAX_CATCH_UP ago are restarted at the current
+ **     time instead so the lights do not race through steps to catch up.
+ **
+ ** @param intersection: intersection whose pattern has ended
+ ** @param millis: current mS since epoch
+ **
+ ** @return mS since epoch at which the next pattern starts
+******************************************************************************/
+STATIC uint64_t getCycleAnchor(intersection_t* intersection, uint64_t millis)
+{
+    uint64_t endTime = SET_endTime(&intersection->sets);
+    
+    //no schedule to keep for unused sets
+    if((endTime == SET_NO_DEADLINE) || (endTime > millis))
+    {
+        intersection->lateness = 0;
+        return millis;
+    }
+    
+    intersection->lateness = millis - endTime;
+    if(intersection->lateness > intersection->maxLateness)
+    {
+        intersection->maxLateness = intersection->lateness;
+    }
+    
+    if(intersection->lateness > INT_MAX_CATCH_UP)
+    {
+        intersection->resyncs++;
+        return millis;
+    }
+    
+    return endTime;
+}
+
  /*****************************************************************************
  ** @brief Toggle active direction
  **     Switch from North-South to East-West or vice versa. The active
  **     direction is the one whose lights are moving through their configured 
- **     pattern(s).
+ **     pattern(s). A config published by the intersection's reloader is
+ **     applied first.
  **
- ** @param millis: current mS since epoch
+ ** @param intersection: intersection to toggle
+ ** @param millis: mS since epoch at which the new direction starts
  **
  ** @return error code
 ******************************************************************************/
-STATIC error_t toggleActiveDirection(uint64_t millis)
+STATIC error_t toggleActiveDirection(intersection_t* intersection, uint64_t millis)
 {
     error_t result = ERR_success;
+    intConfig_t* update;
+    
+    //apply a reloaded config between patterns, so no set changes its steps part way through
+    if(intersection->reloader)
+    {
+        update = RLD_take(intersection->reloader);
+        if(update)
+        {
+            CFG_apply(&intersection->config, update);
+            packLightSets(intersection);
+            free(update);
+        }
+    }
     
-    if(intState == IS_ns)
+    if(intersection->state == IS_ns)
     {
-        result = changeActiveDirection_ptr(IS_ew, millis);
+        result = changeActiveDirection_ptr(intersection, IS_ew, millis);
     }
-    else if(intState == IS_ew)
+    else if(intersection->state == IS_ew)
     {
-        result = changeActiveDirection_ptr(IS_ns, millis);
+        result = changeActiveDirection_ptr(intersection, IS_ns, millis);
     }
     
     return result;
@@ -132,15 +581,17 @@ STATIC error_t toggleActiveDirection(uint64_t millis)
  **     direction is the one whose lights are moving through their configured 
  **     pattern(s).
  **
+ ** @param intersection: intersection to change
  ** @param state: requested direction to activate
  ** @param millis: current mS since epoch
  **
  ** @return error code
 ******************************************************************************/
-STATIC error_t changeActiveDirection(intState_t state, uint64_t millis)
+STATIC error_t changeActiveDirection(intersection_t* intersection, intState_t state, uint64_t millis)
 {
     error_t result;
-    lightSet_t *set1, *set2;
+    lightSet_t* set;
+    intDirection_t dir1, dir2;
     
     //confirm new state request is valid
     if(state >= IS_off)
@@ -150,7 +601,7 @@ STATIC error_t changeActiveDirection(intState_t state, uint64_t millis)
     }
     
     //check if a new state is requested
-    if(state == intState)
+    if(state == intersection->state)
     {
         //already in this state; nothing to do
         return ERR_success;
@@ -158,41 +609,68 @@ STATIC error_t changeActiveDirection(intState_t state, uint64_t millis)
     
     if(state == IS_ns)
     {
-        set1 = CFG_getLightSet_ptr(ID_north);
-        set2 = CFG_getLightSet_ptr(ID_south);
+        dir1 = ID_north;
+        dir2 = ID_south;
         //printf("North-south\n");
     }
     else if(state == IS_ew)
     {
-        set1 = CFG_getLightSet_ptr(ID_east);
-        set2 = CFG_getLightSet_ptr(ID_west);
+        dir1 = ID_east;
+        dir2 = ID_west;
         //printf("East-west\n");
     }
     else
     {
         //error happened, switch to error pattern to simulate hardware taking over to flash red lights
         printf("Changing to flashing red pattern!\n");
-        set1 = CFG_getLightSet_ptr(ID_north);
-        set2 = CFG_getLightSet_ptr(ID_south);
-        memcpy(set1->steps, errorSteps, sizeof(errorSteps));
-        memcpy(set2->steps, errorSteps, sizeof(errorSteps));
-        set1 = CFG_getLightSet_ptr(ID_east);
-        set2 = CFG_getLightSet_ptr(ID_west);
-        memcpy(set1->steps, errorSteps, sizeof(errorSteps));
-        memcpy(set2->steps, errorSteps, sizeof(errorSteps));
+        for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+        {
+            set = CFG_getLightSet_ptr(&intersection->config, dir);
+            if(!set)
+            {
+                return ERR_nullPtr;
+            }
+            set->pattern = &errorPattern;
+            intersection->lightSets[dir].pattern = &errorPattern;
+        }
         //return ERR_success;
+        dir1 = ID_east;
+        dir2 = ID_west;
         state = IS_ew;
     }
     
     //set new active configurations in lightSet module
-    result = SET_assignLights(set1, set2, millis);
+    result = SET_assignLights(&intersection->sets, &intersection->lightSets[dir1], &intersection->lightSets[dir2], millis);
     if(result != ERR_success)
     {
         return result;
     }
     
-    intState = state;
+    intersection->state = state;
     
     return ERR_success;
 }
 
+ /*****************************************************************************
+ ** @brief Pack light sets
+ **     Pack the light set config of every direction into the intersection's
+ **     runtime light sets, sharing the configs' patterns. Sets restart from
+ **     their starting step, which leads to the first step of the pattern as
+ **     the end step does. The lamp board and its arrow mask are rebuilt from
+ **     the packed lamps.
+ **
+ ** @param intersection: intersection whose config was loaded
+ **
+ ** @return none
+******************************************************************************/
+STATIC void packLightSets(intersection_t* intersection)
+{
+    intersection->arrows = 0;
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        SET_pack(&intersection->lightSets[dir], &intersection->config.lightSets[dir]);
+        intersection->lightSets[dir].lane = (uint8_t)dir;
+        SET_updateBoard(&intersection->lamps, &intersection->lightSets[dir]);
+        intersection->arrows |= SET_getBoardArrows(&intersection->lightSets[dir]);
+    }
+}
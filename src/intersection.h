@@ -9,8 +9,24 @@
 #ifndef _INTERSECTION_H_
 #define _INTERSECTION_H_
 
+#include <stddef.h>
+
 #include "main.h"
+#include "config.h"
+#include "lightSet.h"
+#include "display.h"
+#include "timerWheel.h"
+#include "histogram.h"
+#include "configReloader.h"
+
+
+#define INT_MAX_CATCH_UP        1000    //max mS of lateness made up by shortening the next cycle
 
+//lamp board lanes of each pair of directions that cross; a direction's lane is its intDirection_t
+#define INT_LANES_NS            (SET_BOARD_LANE(ID_north) | SET_BOARD_LANE(ID_south))
+#define INT_LANES_EW            (SET_BOARD_LANE(ID_east) | SET_BOARD_LANE(ID_west))
+
+_Static_assert(INT_DIRECTIONS <= SET_BOARD_LANES, "directions do not fit in a lamp board");
 
 //active heading index
 typedef enum
@@ -21,10 +37,54 @@ typedef enum
     IS_off          //All off (red)
 } intState_t;
 
+//all runtime state of one intersection
+typedef struct intersection
+{
+    packedSet_t lightSets[INT_DIRECTIONS];  //runtime state of each direction, packed from the config
+    uint64_t lamps;             //lamp board of every direction, updated at each step change
+    uint64_t arrows;            //lamp board mask of the arrow lamps, updated when a config is packed
+    intConfig_t config;         //light set configs for each direction
+    activeLightSets_t sets;     //light sets currently moving through their patterns
+    intState_t state;           //currently active directions of the intersection
+    dispState_t display;        //console display tracking
+    twNode_t timer;             //scheduling entry when run in a timing wheel
+    uint64_t lateness;          //mS between the scheduled and clocked time of the last direction change
+    uint64_t maxLateness;       //largest lateness of any direction change
+    uint32_t resyncs;           //direction changes too late to keep the schedule
+    reloader_t* reloader;       //source of reloaded configs, NULL if not watching the config file
+} intersection_t;
+
+//intersection owning a timing wheel entry
+#define INT_FROM_TIMER(node)    ((intersection_t*)((char*)(node) - offsetof(intersection_t, timer)))
+
+//initializer for an intersection that has not been started yet
+#define INTERSECTION_INIT       {.lightSets = {SET_PACKED_UNUSED, SET_PACKED_UNUSED, SET_PACKED_UNUSED, SET_PACKED_UNUSED}, \
+                                 .config = {.lightSets = UNUSED_CONFIG}, \
+                                 .sets = {.set1 = NULL, .set2 = NULL}, \
+                                 .state = IS_off}
+
 //********************* Public function prototypes ****************************//
 
 error_t INT_init(char* filepath);
 void INT_stateMachine(void);
+uint64_t INT_nextDeadline(void);
+void INT_waitForNextTransition(void);
+error_t INT_runEventLoop(void);
+intersection_t* INT_getDefault(void);
+void INT_printLateness(void);
+uint64_t INT_getLamps(void);
+uint64_t INT_getArrows(void);
+bool INT_lampsConflict(uint64_t lamps);
+
+error_t INT_initCtx(intersection_t* intersection, char* filepath);
+void INT_stateMachineCtx(intersection_t* intersection);
+void INT_clockCtx(intersection_t* intersection, uint64_t millis);
+uint64_t INT_nextDeadlineCtx(intersection_t* intersection);
+void INT_waitForNextTransitionCtx(intersection_t* intersection);
+error_t INT_runEventLoopCtx(intersection_t* intersection);
+void INT_printLatenessCtx(intersection_t* intersection);
+uint64_t INT_getLampsCtx(const intersection_t* intersection);
+uint64_t INT_getArrowsCtx(const intersection_t* intersection);
 
 
 #endif //_INTERSECTION_H_
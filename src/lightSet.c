@@ -9,68 +9,130 @@
 #include "main.h"
 #include "lightSet.h"
 
+//*********************** Global variables ***********************************//
+const setPattern_t SET_unusedPattern = {.count = 0};    //pattern of unused sets
+
 //*********************** Static variables ***********************************//
-STATIC lightSet_t* lightSet1 = NULL;    //ptr to config for active light set 1
-STATIC lightSet_t* lightSet2 = NULL;    //ptr to config for active light set 2
+STATIC const uint8_t boardColours[SET_LAMP_MASK + 1] = {       //lamp board colour bits of each lightState_t
+    [LS_green] = SET_BOARD_GREEN,
+    [LS_yellowArrow] = SET_BOARD_YELLOW | SET_BOARD_GREEN,
+    [LS_yellow] = SET_BOARD_YELLOW,
+    [LS_red] = SET_BOARD_RED};
+STATIC const lightState_t boardStates[SET_BOARD_LAMP_MASK + 1] = {     //lightState_t of each lamp board colour
+    [0] = LS_off,
+    [SET_BOARD_RED] = LS_red,
+    [SET_BOARD_YELLOW] = LS_yellow,
+    [SET_BOARD_RED | SET_BOARD_YELLOW] = LS_off,
+    [SET_BOARD_GREEN] = LS_green,
+    [SET_BOARD_RED | SET_BOARD_GREEN] = LS_off,
+    [SET_BOARD_YELLOW | SET_BOARD_GREEN] = LS_yellowArrow,
+    [SET_BOARD_LAMP_MASK] = LS_off};
 
 //********************* Local function prototypes ****************************//
-STATIC lightSetState_t clockLightSetStateMachine(lightSet_t* set, uint64_t millis);
-STATIC lightSetState_t incrementLightSetStep(lightSet_t* set);
+STATIC lightSetState_t clockLightSetStateMachine(packedSet_t* set, uint64_t cycleStartTime, uint64_t millis, histogram_t* lateness, histogram_t* ownLateness, uint64_t* board);
+STATIC uint64_t getLightSetDeadline(const packedSet_t* set, uint64_t cycleStartTime);
+STATIC lightSetState_t incrementLightSetStep(packedSet_t* set);
+STATIC uint64_t widenOffset(uint32_t offset);
 STATIC lightState_t getArrowState(lightSetState_t setState);
 STATIC lightState_t getSolidGreenState(lightSetState_t setState);
 
 //************************ Public functions *********************************//
 
+ /*****************************************************************************
+ ** @brief Pack light set
+ **     Pack the lights of a light set config into its runtime layout, sharing
+ **     the config's pattern and starting from the config's current step.
+ **
+ ** @param packed: runtime light set to fill
+ ** @param set: light set config to pack
+ **
+ ** @return none
+******************************************************************************/
+void SET_pack(packedSet_t* packed, const lightSet_t* set)
+{
+    packed->lamps = 0;
+    packed->types = 0;
+    for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+    {
+        packed->lamps |= ((uint32_t)set->lights[i].state & SET_LAMP_MASK) << (i * SET_LAMP_BITS);
+        packed->types |= (uint16_t)(((uint32_t)set->lights[i].type & SET_TYPE_MASK) << (i * SET_TYPE_BITS));
+    }
+    
+    packed->pattern = set->pattern;
+    packed->currentStep = (set->currentStep < set->pattern->count) ? set->currentStep : set->pattern->count;
+    packed->stepStart = 0;
+}
+
  /*****************************************************************************
  ** @brief Assign lights
- **     Set active light config pointers to a new set of configs and set the 
- **     start time for the current iteration of light pattern.
+ **     Set active light set pointers to a new pair of sets and set the 
+ **     start time for the current iteration of light pattern. Sets held at
+ **     their end step go back to the lead-in before the first step.
  **
- ** @param set1: pointer to active light set config 1
- ** @param set2: pointer to active light set config 2
+ ** @param active: active light sets of the intersection
+ ** @param set1: pointer to active light set 1
+ ** @param set2: pointer to active light set 2
  ** @param startTime: mS since epoch at which this pattern started
  **
  ** @return error code
 ******************************************************************************/
-error_t SET_assignLights(lightSet_t* set1, lightSet_t* set2, uint64_t startTime)
+error_t SET_assignLights(activeLightSets_t* active, packedSet_t* set1, packedSet_t* set2, uint64_t startTime)
 {
-    lightSet1 = set1;
-    lightSet2 = set2;
+    if(!active)
+    {
+        return ERR_nullPtr;
+    }
+    
+    active->set1 = set1;
+    active->set2 = set2;
     
     //check if set pointers are valid
-    if(!lightSet1 || !lightSet2)
+    if(!set1 || !set2)
     {
         return ERR_nullPtr;
     }
     
-    //set cycle start times for both sets
-    lightSet1->cycleStartTime = startTime;
-    lightSet2->cycleStartTime = startTime;
+    //set cycle start time for both sets; sets that finished their last
+    //pattern start this one from the lead-in
+    active->cycleStartTime = startTime;
+    set1->stepStart = 0;
+    set2->stepStart = 0;
+    if(SET_getStepState(set1->pattern, set1->currentStep) == LSS_end)
+    {
+        set1->currentStep = set1->pattern->count;
+    }
+    if(SET_getStepState(set2->pattern, set2->currentStep) == LSS_end)
+    {
+        set2->currentStep = set2->pattern->count;
+    }
     
     return ERR_success;
 }
 
  /*****************************************************************************
  ** @brief Light set state machine
- **     Clocks the state machines for the currently active light set patterns.
+ **     Clocks the state machines for the currently active light set patterns,
+ **     recording the lateness of any step changes in whichever histograms are
+ **     attached and updating the lamp board if one is attached.
  **
+ ** @param active: active light sets of the intersection
  ** @param millis: current mS since epoch
  **
  ** @return lowest illumination state of the active light sets
 ******************************************************************************/
-lightSetState_t SET_stateMachine(uint64_t millis)
+lightSetState_t SET_stateMachine(activeLightSets_t* active, uint64_t millis)
 {
     lightSetState_t overallState = LSS_end; //lowest illumination state tracker
     lightSetState_t lightSetState;
         
     //clock the state machines for each light set and determine the state with the lowest index
-    lightSetState = clockLightSetStateMachine(lightSet1, millis);
+    lightSetState = clockLightSetStateMachine(active->set1, active->cycleStartTime, millis, active->lateness, active->ownLateness, active->board);
     if(lightSetState < overallState)
     {
         overallState = lightSetState;
     }
 
-    lightSetState = clockLightSetStateMachine(lightSet2, millis);
+    lightSetState = clockLightSetStateMachine(active->set2, active->cycleStartTime, millis, active->lateness, active->ownLateness, active->board);
     if(lightSetState < overallState)
     {
         overallState = lightSetState;
@@ -79,6 +141,226 @@ lightSetState_t SET_stateMachine(uint64_t millis)
     return overallState;
 }
 
+ /*****************************************************************************
+ ** @brief Next deadline
+ **     Get the time at which the state machine of either active light set
+ **     will next change step. Clocking SET_stateMachine() before this time
+ **     has no effect.
+ **
+ ** @param active: active light sets of the intersection
+ **
+ ** @return mS since epoch of the earliest step expiration, SET_NO_DEADLINE
+ **     if neither active set has one pending
+******************************************************************************/
+uint64_t SET_nextDeadline(const activeLightSets_t* active)
+{
+    uint64_t deadline1 = getLightSetDeadline(active->set1, active->cycleStartTime);
+    uint64_t deadline2 = getLightSetDeadline(active->set2, active->cycleStartTime);
+    
+    return (deadline1 < deadline2) ? deadline1 : deadline2;
+}
+
+ /*****************************************************************************
+ ** @brief Get light state
+ **     Get the state an individual light shows for a light set illumination
+ **     state, as incrementLightSetStep() would set it.
+ **
+ ** @param light: light to check
+ ** @param setState: illumination state of the light's set
+ **
+ ** @return light state, LS_off for unused lights
+******************************************************************************/
+lightState_t SET_getLightState(const light_t* light, lightSetState_t setState)
+{
+    if(light->type == LDT_solid)
+    {
+        return getSolidGreenState(setState);
+    }
+    if(light->type == LDT_arrow)
+    {
+        return getArrowState(setState);
+    }
+    
+    return LS_off;
+}
+
+ /*****************************************************************************
+ ** @brief Get lamp
+ **     Get the state of one light of a runtime light set
+ **
+ ** @param set: runtime light set
+ ** @param light: index of the light in the set
+ **
+ ** @return light state
+******************************************************************************/
+lightState_t SET_getLamp(const packedSet_t* set, uint8_t light)
+{
+    return (lightState_t)((set->lamps >> (light * SET_LAMP_BITS)) & SET_LAMP_MASK);
+}
+
+ /*****************************************************************************
+ ** @brief Get lamp type
+ **     Get the display type of one light of a runtime light set
+ **
+ ** @param set: runtime light set
+ ** @param light: index of the light in the set
+ **
+ ** @return light display type
+******************************************************************************/
+lightDisplayType_t SET_getLampType(const packedSet_t* set, uint8_t light)
+{
+    return (lightDisplayType_t)((set->types >> (light * SET_TYPE_BITS)) & SET_TYPE_MASK);
+}
+
+ /*****************************************************************************
+ ** @brief Get offset
+ **     Get the expiration offset of a step of a pattern, widened back to the
+ **     value the config gave. Sets start past the last step, which expires at
+ **     the cycle start, so their first clock leads to the first step.
+ **
+ ** @param pattern: illumination pattern
+ ** @param step: index of the step in the pattern
+ **
+ ** @return mS from the cycle start at which the step expires
+******************************************************************************/
+uint64_t SET_getOffset(const setPattern_t* pattern, uint8_t step)
+{
+    return (step < pattern->count) ? widenOffset(pattern->offsets[step]) : 0;
+}
+
+ /*****************************************************************************
+ ** @brief Get deadline
+ **     Get the time at which a step of a pattern expires. End steps never
+ **     do; a set that finishes early holds its end state until its partner
+ **     finishes too and the intersection toggles direction.
+ **
+ ** @param pattern: illumination pattern
+ ** @param step: index of the step in the pattern
+ ** @param cycleStartTime: mS since epoch at which the set's cycle started
+ **
+ ** @return mS since epoch of the step expiration, SET_NO_DEADLINE for an
+ **     end step
+******************************************************************************/
+uint64_t SET_getDeadline(const setPattern_t* pattern, uint8_t step, uint64_t cycleStartTime)
+{
+    if(SET_getStepState(pattern, step) == LSS_end)
+    {
+        return SET_NO_DEADLINE;
+    }
+    
+    return SET_getOffset(pattern, step) + cycleStartTime;
+}
+
+ /*****************************************************************************
+ ** @brief Get step state
+ **
+ ** @param pattern: illumination pattern
+ ** @param step: index of the step in the pattern
+ **
+ ** @return illumination state of the step, LSS_unused past the last step
+******************************************************************************/
+lightSetState_t SET_getStepState(const setPattern_t* pattern, uint8_t step)
+{
+    return (step < pattern->count) ? (lightSetState_t)pattern->states[step] : LSS_unused;
+}
+
+ /*****************************************************************************
+ ** @brief End time
+ **     Get the time at which the active light sets were scheduled to reach
+ **     their current steps; once both are at their end steps, this is when
+ **     the pattern was scheduled to end, however late it was clocked.
+ **
+ ** @param active: active light sets of the intersection
+ **
+ ** @return mS since epoch of the later scheduled step start, SET_NO_DEADLINE
+ **     if neither active set is used
+******************************************************************************/
+uint64_t SET_endTime(const activeLightSets_t* active)
+{
+    uint64_t endTime = SET_NO_DEADLINE;
+    uint64_t stepStartTime;
+    const packedSet_t* sets[2] = {active->set1, active->set2};
+    
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        if(!sets[i] || !sets[i]->pattern->count)
+        {
+            continue;
+        }
+        stepStartTime = active->cycleStartTime + widenOffset(sets[i]->stepStart);
+        if((endTime == SET_NO_DEADLINE) || (stepStartTime > endTime))
+        {
+            endTime = stepStartTime;
+        }
+    }
+    
+    return endTime;
+}
+
+ /*****************************************************************************
+ ** @brief Update board
+ **     Write the lamps of a runtime light set into its lane of a lamp board
+ **
+ ** @param board: lamp board of the set's intersection
+ ** @param set: runtime light set
+ **
+ ** @return none
+******************************************************************************/
+void SET_updateBoard(uint64_t* board, const packedSet_t* set)
+{
+    uint64_t lane = 0;
+    
+    for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+    {
+        if(SET_getLampType(set, i) != LDT_unused)
+        {
+            lane |= (uint64_t)boardColours[SET_getLamp(set, i)] << (i * SET_BOARD_LAMP_BITS);
+        }
+    }
+    
+    *board = (*board & ~SET_BOARD_LANE(set->lane)) | (lane << (set->lane * SET_BOARD_LANE_BITS));
+}
+
+ /*****************************************************************************
+ ** @brief Get board lamp
+ **     Get the state of one light from a lamp board
+ **
+ ** @param board: lamp board
+ ** @param lane: lane of the light's set
+ ** @param light: index of the light in the set
+ **
+ ** @return light state, LS_off for unused lights
+******************************************************************************/
+lightState_t SET_getBoardLamp(uint64_t board, uint8_t lane, uint8_t light)
+{
+    return boardStates[(board >> (lane * SET_BOARD_LANE_BITS + light * SET_BOARD_LAMP_BITS)) & SET_BOARD_LAMP_MASK];
+}
+
+ /*****************************************************************************
+ ** @brief Get board arrows
+ **     Get the arrow mask of a runtime light set's lane: every colour bit of
+ **     each of its arrow lamps. ANDed with a lamp board, it leaves only the
+ **     arrows; ANDed with its complement, only the solid lamps.
+ **
+ ** @param set: runtime light set
+ **
+ ** @return arrow lamps of the set, in its lane of a lamp board
+******************************************************************************/
+uint64_t SET_getBoardArrows(const packedSet_t* set)
+{
+    uint64_t lane = 0;
+    
+    for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+    {
+        if(SET_getLampType(set, i) == LDT_arrow)
+        {
+            lane |= (uint64_t)SET_BOARD_LAMP_MASK << (i * SET_BOARD_LAMP_BITS);
+        }
+    }
+    
+    return lane << (set->lane * SET_BOARD_LANE_BITS);
+}
+
 //************************* Local functions *********************************//
 
  /*****************************************************************************
@@ -86,12 +368,19 @@ lightSetState_t SET_stateMachine(uint64_t millis)
  **     Clock the state machine of an individual light set
  **
  ** @param set: pointer to active light set to clock
+ ** @param cycleStartTime: mS since epoch at which the set's cycle started
  ** @param millis: current mS since epoch
+ ** @param lateness: optional histogram for the lateness of scheduled step changes
+ ** @param ownLateness: optional second histogram for the same lateness
+ ** @param board: optional lamp board to update with the set's new lamps
  **
  ** @return current illumination state of the light set
 ******************************************************************************/
-STATIC lightSetState_t clockLightSetStateMachine(lightSet_t* set, uint64_t millis)
+STATIC lightSetState_t clockLightSetStateMachine(packedSet_t* set, uint64_t cycleStartTime, uint64_t millis, histogram_t* lateness, histogram_t* ownLateness, uint64_t* board)
 {
+    uint64_t deadline;
+    lightSetState_t state;
+    
     //check if set pointer is valid
     if(!set)
     {
@@ -99,72 +388,137 @@ STATIC lightSetState_t clockLightSetStateMachine(lightSet_t* set, uint64_t milli
         return LSS_end;
     }
     
-    //check if set is being used by checking first step in pattern
-    if(set->steps[0].state == LSS_unused)
+    //check if set is being used by checking for steps in its pattern
+    if(!set->pattern->count)
     {
         //printf("Unused light set\n");
         return LSS_end;
     }
     
     //check if it's time to increment the step in the pattern
-    if(millis >= (set->steps[set->currentStep].expirationOffset + set->cycleStartTime))
+    deadline = SET_getDeadline(set->pattern, set->currentStep, cycleStartTime);
+    if(millis >= deadline)
     {
+        //the next step starts when this one was scheduled to expire, not when the expiry was seen;
+        //steps left over from the previous cycle expire immediately and are not scheduled changes
+        if(deadline > widenOffset(set->stepStart) + cycleStartTime)
+        {
+            set->stepStart = set->pattern->offsets[set->currentStep];
+            if(lateness)
+            {
+                HIST_record(lateness, millis - deadline);
+            }
+            if(ownLateness)
+            {
+                HIST_record(ownLateness, millis - deadline);
+            }
+        }
+        
+        state = incrementLightSetStep(set);
+        if(board)
+        {
+            SET_updateBoard(board, set);
+        }
+        
         //return active state
-        return incrementLightSetStep(set);
+        return state;
     }
     
     //return active state
-    return set->steps[set->currentStep].state;
+    return SET_getStepState(set->pattern, set->currentStep);
+}
+
+ /*****************************************************************************
+ ** @brief Get light set deadline
+ **     Get the time at which the active step of a light set expires, using the
+ **     same arithmetic as clockLightSetStateMachine so both always agree.
+ **
+ ** @param set: pointer to light set
+ ** @param cycleStartTime: mS since epoch at which the set's cycle started
+ **
+ ** @return mS since epoch of the step expiration, SET_NO_DEADLINE if the set
+ **     is invalid, unused or finished
+******************************************************************************/
+STATIC uint64_t getLightSetDeadline(const packedSet_t* set, uint64_t cycleStartTime)
+{
+    //invalid and unused sets never change step
+    if(!set || !set->pattern->count)
+    {
+        return SET_NO_DEADLINE;
+    }
+    
+    return SET_getDeadline(set->pattern, set->currentStep, cycleStartTime);
 }
 
  /*****************************************************************************
  ** @brief Increment light set step
  **     Increment to the next step of the illumination pattern for a given 
- **     light set.
+ **     light set, wrapping from the last step to the first.
  **
  ** @param set: pointer to light set to increment
  **
  ** @return current illumination state of the light set
 ******************************************************************************/
-STATIC lightSetState_t incrementLightSetStep(lightSet_t* set)
+STATIC lightSetState_t incrementLightSetStep(packedSet_t* set)
 {
     uint8_t nextStep;
     lightSetState_t nextState;
     lightState_t arrowState;
     lightState_t solidGreenState;
+    lightState_t lightState;
+    uint32_t lamps = set->lamps;
+    uint8_t shift;
     
-    nextStep = (set->currentStep + 1) % MAX_STEPS_IN_PATTERN;
-    while(set->steps[nextStep].state == LSS_unused)
+    nextStep = set->currentStep + 1;
+    if(nextStep >= set->pattern->count)
     {
-        nextStep = (nextStep + 1) % MAX_STEPS_IN_PATTERN;
+        nextStep = 0;
     }
-    nextState = set->steps[nextStep].state;
+    nextState = (lightSetState_t)set->pattern->states[nextStep];
     arrowState = getArrowState(nextState);
     solidGreenState = getSolidGreenState(nextState);
     
     for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
     {        
-        if(set->lights[i].type == LDT_solid)
+        if(SET_getLampType(set, i) == LDT_solid)
         {
-            set->lights[i].state = solidGreenState;
+            lightState = solidGreenState;
         }
-        else if(set->lights[i].type == LDT_arrow)
+        else if(SET_getLampType(set, i) == LDT_arrow)
         {
-            set->lights[i].state = arrowState;
+            lightState = arrowState;
         }
         else    //LDT_unused or invalid
         {
             //no more populated lights in the set
             break;
         }
+        
+        shift = i * SET_LAMP_BITS;
+        lamps = (lamps & ~(SET_LAMP_MASK << shift)) | ((uint32_t)lightState << shift);
     }
     
+    set->lamps = lamps;
     set->currentStep = nextStep;
     //printf("Step %u\n", nextStep);
     
     return nextState;
 }
 
+ /*****************************************************************************
+ ** @brief Widen offset
+ **     Sign extend a packed offset. Config times are ints, so this restores
+ **     the offset the config held, including the -1 of an end step.
+ **
+ ** @param offset: packed offset
+ **
+ ** @return mS from the cycle start
+******************************************************************************/
+STATIC uint64_t widenOffset(uint32_t offset)
+{
+    return (uint64_t)(int64_t)(int32_t)offset;
+}
+
  /*****************************************************************************
  ** @brief Get arrow light state
  **     Gets the arrow state index for a given light set illumination state.
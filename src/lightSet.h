@@ -10,9 +10,40 @@
 #define _LIGHTSET_H_
 
 #include "main.h"
+#include "histogram.h"
 
 #define MAX_LIGHTS_IN_SET       5
-#define MAX_STEPS_IN_PATTERN    10
+#define MAX_STEPS_IN_PATTERN    64          //longest pattern a config may hold
+
+#define SET_NO_DEADLINE         UINT64_MAX  //no pending step expiration
+#define SET_CACHE_LINE          64          //alignment of interned light set patterns
+#define SET_OFFSET_END          UINT32_MAX  //packed offset of an end step, which never expires
+#define SET_LEAD_IN             UINT8_MAX   //starting step of a config before the first step of its pattern
+#define SET_LAMP_BITS           4           //bits of each light state in a packed set
+#define SET_LAMP_MASK           0xFu
+#define SET_TYPE_BITS           2           //bits of each light type in a packed set
+#define SET_TYPE_MASK           0x3u
+
+//lamp board: the lamps of every light set of an intersection in one word. Each set
+//has a lane of SET_BOARD_LANE_BITS, and each of its lights SET_BOARD_LAMP_BITS of
+//colour bits in that lane; unused and off lights are 0. A yellow arrow lights the
+//green arrow in yellow, so it sets both the yellow and green bits. Which lamps are
+//arrows does not change with the lamps, so it is kept in a separate arrow mask of
+//the same layout, with every colour bit of each arrow lamp set.
+#define SET_BOARD_LANES         4           //light sets in a lamp board
+#define SET_BOARD_LANE_BITS     16
+#define SET_BOARD_LANE_MASK     0x7FFFu
+#define SET_BOARD_LAMP_BITS     3
+#define SET_BOARD_LAMP_MASK     0x7u
+#define SET_BOARD_RED           0x1u        //colour bits of a lamp
+#define SET_BOARD_YELLOW        0x2u
+#define SET_BOARD_GREEN         0x4u
+#define SET_BOARD_REDS          UINT64_C(0x1249124912491249)    //colour bit of every lamp of every lane
+#define SET_BOARD_YELLOWS       (SET_BOARD_REDS << 1)
+#define SET_BOARD_GREENS        (SET_BOARD_REDS << 2)
+
+//bits of one lane of a lamp board
+#define SET_BOARD_LANE(lane)    ((uint64_t)SET_BOARD_LANE_MASK << ((lane) * SET_BOARD_LANE_BITS))
 
 //Light set illumination state
 typedef enum lightsetstate
@@ -67,20 +98,79 @@ typedef struct lightsetstep
     uint64_t expirationOffset;  //time from cycleStartTime that the state will expire
 } lightSetStep_t;
 
-//light set config
+//illumination pattern as the state machine runs it: an exact-length span of
+//steps, read-only once interned, so every light set with the same steps shares
+//one copy. offsets are the config's expiration offsets truncated to 32 bits,
+//read with SET_getOffset()
+typedef struct setpattern
+{
+    const uint32_t* offsets;                //time from the cycle start that each step expires
+    const uint8_t* states;                  //lightSetState_t of each step
+    const struct setpattern* next;          //next pattern in the same bucket of the pool it was interned in
+    uint8_t count;                          //number of steps, 0 for unused sets
+} setPattern_t;
+
+//light set config, as parsed
 typedef struct lightset
 {
     light_t lights[MAX_LIGHTS_IN_SET];    //lights contained in set
-    lightSetStep_t steps[MAX_STEPS_IN_PATTERN];     //steps in the set's illumination pattern
-    uint8_t currentStep;        //index of the active step in the illumination pattern
-    uint64_t cycleStartTime;    //timestamp of when the current cycle started
+    const setPattern_t* pattern;    //shared illumination pattern, never NULL
+    uint8_t currentStep;        //index of the step the set starts from, SET_LEAD_IN to start before the first
 } lightSet_t;
 
+//runtime state of a light set: its own cursor and lamps over a shared pattern
+typedef struct packedset
+{
+    const setPattern_t* pattern;    //shared illumination pattern, never NULL
+    uint32_t stepStart;         //time from the cycle start at which the active step was scheduled to start
+    uint32_t lamps;             //lightState_t of each light, SET_LAMP_BITS each from the low bits
+    uint16_t types;             //lightDisplayType_t of each light, SET_TYPE_BITS each from the low bits
+    uint8_t currentStep;        //index of the active step in the illumination pattern; the
+                                //pattern's count before the first step, which expires at the cycle start
+    uint8_t lane;               //lane of the set's lamps in its intersection's lamp board
+} packedSet_t;
+
+//pattern of sets with no steps; not in any pool
+extern const setPattern_t SET_unusedPattern;
+
+//runtime light set with no lights or steps, all lamps red
+#define SET_PACKED_UNUSED       {.pattern = &SET_unusedPattern, \
+                                 .lamps = LS_red * 0x11111u}
+
+_Static_assert(MAX_STEPS_IN_PATTERN < SET_LEAD_IN, "step indices do not fit in a light set");
+_Static_assert(MAX_LIGHTS_IN_SET * SET_LAMP_BITS <= 32, "lamps do not fit in a packed light set");
+_Static_assert(MAX_LIGHTS_IN_SET * SET_TYPE_BITS <= 16, "light types do not fit in a packed light set");
+_Static_assert(MAX_LIGHTS_IN_SET * SET_BOARD_LAMP_BITS < SET_BOARD_LANE_BITS, "lamps do not fit in a lamp board lane");
+_Static_assert(SET_BOARD_LANES * SET_BOARD_LANE_BITS <= 64, "lanes do not fit in a lamp board");
+
+//light sets currently moving through their patterns
+typedef struct activelightsets
+{
+    packedSet_t* set1;  //ptr to active light set 1
+    packedSet_t* set2;  //ptr to active light set 2
+    uint64_t cycleStartTime;    //timestamp of when the current cycle of both sets started
+    histogram_t* lateness;  //optional record of how late each step change was clocked
+    histogram_t* ownLateness;   //optional record of this intersection alone, when lateness is shared
+    uint64_t* board;        //optional lamp board updated with each step change of the sets
+} activeLightSets_t;
+
 //********************* Public function prototypes ****************************//
 
-error_t SET_assignLights(lightSet_t* set1, lightSet_t* set2, uint64_t startTime);
+void SET_pack(packedSet_t* packed, const lightSet_t* set);
+error_t SET_assignLights(activeLightSets_t* active, packedSet_t* set1, packedSet_t* set2, uint64_t startTime);
 void SET_turnAllOff(void);
-lightSetState_t SET_stateMachine(uint64_t millis);
+lightSetState_t SET_stateMachine(activeLightSets_t* active, uint64_t millis);
+uint64_t SET_nextDeadline(const activeLightSets_t* active);
+uint64_t SET_endTime(const activeLightSets_t* active);
+lightState_t SET_getLightState(const light_t* light, lightSetState_t setState);
+lightState_t SET_getLamp(const packedSet_t* set, uint8_t light);
+lightDisplayType_t SET_getLampType(const packedSet_t* set, uint8_t light);
+uint64_t SET_getOffset(const setPattern_t* pattern, uint8_t step);
+uint64_t SET_getDeadline(const setPattern_t* pattern, uint8_t step, uint64_t cycleStartTime);
+void SET_updateBoard(uint64_t* board, const packedSet_t* set);
+lightState_t SET_getBoardLamp(uint64_t board, uint8_t lane, uint8_t light);
+uint64_t SET_getBoardArrows(const packedSet_t* set);
+lightSetState_t SET_getStepState(const setPattern_t* pattern, uint8_t step);
 
 
 #endif //_LIGHTSET_H_
@@ -5,44 +5,239 @@
  * @brief   Main.c for traffic lights application
  *
  ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for getopt
+
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
 
 #include "main.h"
 
+#include "config.h"
+#include "configCache.h"
 #include "intersection.h"
+#include "simulation.h"
+#include "configReloader.h"
+
+//scheduling modes for the main loop
+typedef enum runmode
+{
+    RM_sleep = 0,   //sleep until the next step expiration
+    RM_poll,        //clock the state machine continuously
+    RM_epoll,       //wait on an epoll event loop
+    RM_sim          //run on a virtual clock as fast as possible
+} runMode_t;
+
+static volatile sig_atomic_t dumpRequested = 0;    //set by SIGUSR1 to print timing statistics
+static reloader_t reloader;                         //watches the config file for changes
+
+ /*****************************************************************************
+ ** @brief Request dump
+ **     SIGUSR1 handler; the statistics are printed from the main loop, whose
+ **     wait for the next light change the signal interrupts
+ **
+ ** @param signo: received signal
+ **
+ ** @return none
+******************************************************************************/
+static void requestDump(int signo)
+{
+    (void)signo;
+    
+    dumpRequested = 1;
+}
+
+ /*****************************************************************************
+ ** @brief Print usage
+ **
+ ** @param name: name of the binary
+ **
+ ** @return none
+******************************************************************************/
+static void printUsage(const char* name)
+{
+    printf("Usage: %s [-m sleep|poll|epoll|sim] [-d duration] [-n intersections] [-c cache dir] [config file]\n", name);
+    printf("    -m sleep: sleep until the next light change (default)\n");
+    printf("    -m poll:  clock the state machine continuously\n");
+    printf("    -m epoll: wait on an event loop for light changes and signals\n");
+    printf("    -m sim:   simulate the light changes on a virtual clock and print a summary\n");
+    printf("    -d:       mS of virtual time to simulate (default one week)\n");
+    printf("    -n:       number of intersections to simulate as a sweep fleet (default 1)\n");
+    printf("    -c:       directory in which parsed configs are cached between runs\n");
+}
+
+ /*****************************************************************************
+ ** @brief Run simulation
+ **     Simulate the default intersection, or a sweep fleet of intersections
+ **     running its config, and print the results
+ **
+ ** @param duration: mS of virtual time to simulate
+ ** @param count: number of intersections; more than one runs a sweep fleet
+ **
+ ** @return 0 on success, 1 on failure
+******************************************************************************/
+static int runSimulation(uint64_t duration, uint32_t count)
+{
+    sweepFleet_t fleet;
+    simStats_t stats;
+    clock_t start = clock();
+    double seconds;
+    error_t result;
+    
+    if(count > 1)
+    {
+        if(SWP_init(&fleet, &INT_getDefault()->config, count, 0) != ERR_success)
+        {
+            return 1;
+        }
+        result = SIM_runSweep(&fleet, 0, duration, &stats);
+        SWP_close(&fleet);
+    }
+    else
+    {
+        result = SIM_run(INT_getDefault(), 0, duration, NULL, NULL, &stats);
+    }
+    if(result != ERR_success)
+    {
+        return 1;
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    printf("Simulated %llu mS of %u intersection(s) in %.3f s: %llu light changes, %llu direction changes, %llu clocks\n",
+           (unsigned long long)stats.millis, count, seconds, (unsigned long long)stats.changes,
+           (unsigned long long)stats.toggles, (unsigned long long)stats.clocks);
+    
+    return 0;
+}
 
 /*****************************************************************************
  ** @brief main function
  **     Initializes the intersection and clocks its state machine
  **
- ** @param single argument: path to config file
+ ** @param arguments: optional scheduling mode, simulation duration and path
+ **     to config file
  **
- ** @return 1
+ ** @return 1 on failure; 0 when the event loop is stopped by a signal or the
+ **     simulation completes
 ******************************************************************************/
 int main (int argc, char *argv[])
 {
     char* filepath = NULL;
-    
+    struct sigaction dumpAction = {.sa_handler = requestDump};
+    runMode_t mode = RM_sleep;
+    uint64_t duration = SIM_DEFAULT_DURATION;
+    uint32_t count = 1;
+    char* end;
+    int opt;
+    int status;
+
     printf("Nick Bourdon's Traffic Light Management Application, v%s\n\n", VERSION);
-    
+
+    //check for options
+    while((opt = getopt(argc, argv, "m:d:n:c:")) != -1)
+    {
+        if((opt == 'm') && !strcmp(optarg, "sleep"))
+        {
+            mode = RM_sleep;
+        }
+        else if((opt == 'm') && !strcmp(optarg, "poll"))
+        {
+            mode = RM_poll;
+        }
+        else if((opt == 'm') && !strcmp(optarg, "epoll"))
+        {
+            mode = RM_epoll;
+        }
+        else if((opt == 'm') && !strcmp(optarg, "sim"))
+        {
+            mode = RM_sim;
+        }
+        else if(opt == 'c')
+        {
+            CFG_setCacheDir(optarg);
+        }
+        else if(opt == 'd')
+        {
+            duration = strtoull(optarg, &end, 10);
+            if((*optarg == '\0') || (*end != '\0'))
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if(opt == 'n')
+        {
+            count = (uint32_t)strtoul(optarg, &end, 10);
+            if((*optarg == '\0') || (*end != '\0') || !count)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
     //check for config file argument
-    if(argc >= 2)
+    if(optind < argc)
     {
-        filepath = argv[1];
+        filepath = argv[optind];
         printf("Using %s\n", filepath);
     }
     else
     {
+#ifdef STATIC_CONFIG
+        printf("Using compiled in configuration\n");
+#else
         printf("Using default configuration\n");
+#endif
     }
-    
+
     //initialize config
     INT_init(filepath);
+
+    if(mode == RM_sim)
+    {
+        return runSimulation(duration, count);
+    }
+    
+    //pick up changes to the config file while running
+    if(filepath && (RLD_start(&reloader, filepath) == ERR_success))
+    {
+        INT_getDefault()->reloader = &reloader;
+    }
+    
+    if(mode == RM_epoll)
+    {
+        status = (INT_runEventLoop() == ERR_success) ? 0 : 1;
+        INT_getDefault()->reloader = NULL;
+        RLD_stop(&reloader);
+        return status;
+    }
+
+    //stays installed after the first signal, unlike signal()'s System V semantics
+    sigaction(SIGUSR1, &dumpAction, NULL);
     
     while(1)
     {
         INT_stateMachine();
+        
+        if(dumpRequested)
+        {
+            dumpRequested = 0;
+            INT_printLateness();
+        }
+
+        if(mode == RM_sleep)
+        {
+            INT_waitForNextTransition();
+        }
     }
 
     return 1;
 }
-
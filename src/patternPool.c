@@ -0,0 +1,247 @@
+/***************************************************************************************
+ * @file    patternPool.c
+ * @date    October 18th 2026
+ *
+ * @brief   Interning of light set patterns by content. Each distinct pattern is
+ *          stored once, in a single allocation sized to its steps and aligned
+ *          to a cache line, and shared read-only by every light set config
+ *          and runtime light set that runs it. Patterns live until their pool
+ *          is released, so references never dangle while configs are reloaded.
+ *          The default pool is never released: each reload that brings in
+ *          patterns no config has used before grows it by those patterns,
+ *          while patterns that come back are shared again.
+ *
+ *          Interning takes no lock. Lookups read the chains as they are, and
+ *          a new pattern is published at the head of its chain with a compare
+ *          and swap, so threads parsing a fleet only contend when they add to
+ *          the same chain at once.
+ *
+ ****************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "patternPool.h"
+
+#define PAT_FNV_OFFSET          UINT32_C(2166136261)    //FNV-1a hash of the packed steps
+#define PAT_FNV_PRIME           UINT32_C(16777619)
+
+//*********************** Static variables ***********************************//
+STATIC patternPool_t defaultPool = PATTERN_POOL_INIT;  //pool parsed configs intern their patterns into
+
+//********************* Local function prototypes ****************************//
+STATIC void packPattern(uint32_t* offsets, uint8_t* states, const lightSetStep_t* steps, uint8_t count);
+STATIC uint32_t hashPattern(const uint32_t* offsets, const uint8_t* states, uint8_t count);
+STATIC bool matchPattern(const setPattern_t* pattern, const uint32_t* offsets, const uint8_t* states, uint8_t count);
+STATIC const setPattern_t* findPattern(const setPattern_t* first, const setPattern_t* last, const uint32_t* offsets, const uint8_t* states, uint8_t count);
+
+//************************* Function pointers ********************************//
+STATIC void* (*patternAlloc_ptr)(size_t, size_t) = aligned_alloc;  //function ptr for mocking
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Intern pattern
+ **     Get the pool's copy of a pattern, adding it if no light set has
+ **     interned the same steps before. Safe to call from several threads;
+ **     if two add the same steps at once, one copy is kept and the other freed.
+ **
+ ** @param pool: pool to intern into
+ ** @param steps: steps of the pattern
+ ** @param count: number of steps, at most MAX_STEPS_IN_PATTERN
+ **
+ ** @return shared read-only pattern, SET_unusedPattern if there are no
+ **     steps, NULL if it could not be allocated
+******************************************************************************/
+const setPattern_t* PAT_intern(patternPool_t* pool, const lightSetStep_t* steps, uint8_t count)
+{
+    uint32_t offsets[MAX_STEPS_IN_PATTERN];
+    uint8_t states[MAX_STEPS_IN_PATTERN];
+    setPattern_t* pattern;
+    const setPattern_t* head;
+    const setPattern_t* found;
+    uint32_t* patternOffsets;
+    uint8_t* patternStates;
+    size_t size;
+    uint32_t bucket;
+
+    if(!count)
+    {
+        return &SET_unusedPattern;
+    }
+
+    packPattern(offsets, states, steps, count);
+    bucket = hashPattern(offsets, states, count) & (PAT_BUCKETS - 1);
+    atomic_fetch_add_explicit(&pool->requests, 1, memory_order_relaxed);
+
+    head = atomic_load_explicit(&pool->buckets[bucket], memory_order_acquire);
+    found = findPattern(head, NULL, offsets, states, count);
+    if(found)
+    {
+        return found;
+    }
+
+    //the steps follow the pattern in the same allocation, rounded up to whole cache lines
+    size = sizeof(setPattern_t) + count * (sizeof(uint32_t) + sizeof(uint8_t));
+    size = (size + SET_CACHE_LINE - 1) & ~(size_t)(SET_CACHE_LINE - 1);
+    pattern = patternAlloc_ptr(SET_CACHE_LINE, size);
+    if(!pattern)
+    {
+        printf("Failed to allocate light set pattern\n");
+        return NULL;
+    }
+
+    patternOffsets = (uint32_t*)(pattern + 1);
+    patternStates = (uint8_t*)&patternOffsets[count];
+    memcpy(patternOffsets, offsets, count * sizeof(uint32_t));
+    memcpy(patternStates, states, count);
+    pattern->offsets = patternOffsets;
+    pattern->states = patternStates;
+    pattern->count = count;
+    pattern->next = head;
+
+    //publish the complete pattern; on a race, only the patterns added since need checking
+    while(!atomic_compare_exchange_weak_explicit(&pool->buckets[bucket], &pattern->next, pattern,
+                                                 memory_order_release, memory_order_acquire))
+    {
+        found = findPattern(pattern->next, head, offsets, states, count);
+        if(found)
+        {
+            free(pattern);
+            return found;
+        }
+        head = pattern->next;
+    }
+    atomic_fetch_add_explicit(&pool->count, 1, memory_order_relaxed);
+
+    return pattern;
+}
+
+ /*****************************************************************************
+ ** @brief Get default pool
+ **     Get the pool parsed configs intern their patterns into
+ **
+ ** @param none
+ **
+ ** @return default pattern pool
+******************************************************************************/
+patternPool_t* PAT_getDefault(void)
+{
+    return &defaultPool;
+}
+
+ /*****************************************************************************
+ ** @brief Release pool
+ **     Free every pattern in a pool. No light set may still reference them,
+ **     and no thread may be interning into the pool.
+ **
+ ** @param pool: pool to empty
+ **
+ ** @return none
+******************************************************************************/
+void PAT_release(patternPool_t* pool)
+{
+    const setPattern_t* pattern;
+    const setPattern_t* next;
+
+    for(uint32_t bucket = 0; bucket < PAT_BUCKETS; bucket++)
+    {
+        for(pattern = atomic_exchange(&pool->buckets[bucket], NULL); pattern; pattern = next)
+        {
+            next = pattern->next;
+            free((void*)pattern);
+        }
+    }
+    atomic_store(&pool->count, 0);
+    atomic_store(&pool->requests, 0);
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Pack pattern
+ **     Pack config steps into the layout the state machine runs. Offsets are
+ **     truncated to 32 bits; config times are ints, so nothing is lost.
+ **
+ ** @param offsets: destination for the offset of each step
+ ** @param states: destination for the state of each step
+ ** @param steps: steps to pack
+ ** @param count: number of steps
+ **
+ ** @return none
+******************************************************************************/
+STATIC void packPattern(uint32_t* offsets, uint8_t* states, const lightSetStep_t* steps, uint8_t count)
+{
+    for(uint8_t i = 0; i < count; i++)
+    {
+        offsets[i] = (uint32_t)steps[i].expirationOffset;
+        states[i] = (uint8_t)steps[i].state;
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Hash pattern
+ **
+ ** @param offsets: packed offset of each step
+ ** @param states: state of each step
+ ** @param count: number of steps
+ **
+ ** @return FNV-1a hash of the pattern's offsets and states
+******************************************************************************/
+STATIC uint32_t hashPattern(const uint32_t* offsets, const uint8_t* states, uint8_t count)
+{
+    uint32_t hash = (PAT_FNV_OFFSET ^ count) * PAT_FNV_PRIME;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        for(uint8_t byte = 0; byte < sizeof(uint32_t); byte++)
+        {
+            hash = (hash ^ ((offsets[i] >> (byte * 8)) & 0xFF)) * PAT_FNV_PRIME;
+        }
+        hash = (hash ^ states[i]) * PAT_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+ /*****************************************************************************
+ ** @brief Match pattern
+ **
+ ** @param pattern: interned pattern
+ ** @param offsets: packed offset of each step
+ ** @param states: state of each step
+ ** @param count: number of steps
+ **
+ ** @return true if the pattern has exactly the given steps
+******************************************************************************/
+STATIC bool matchPattern(const setPattern_t* pattern, const uint32_t* offsets, const uint8_t* states, uint8_t count)
+{
+    return (pattern->count == count) && !memcmp(pattern->offsets, offsets, count * sizeof(uint32_t)) &&
+           !memcmp(pattern->states, states, count);
+}
+
+ /*****************************************************************************
+ ** @brief Find pattern
+ **     Search part of a chain for a pattern
+ **
+ ** @param first: first pattern to check
+ ** @param last: pattern at which to stop, unchecked, NULL for the whole chain
+ ** @param offsets: packed offset of each step
+ ** @param states: state of each step
+ ** @param count: number of steps
+ **
+ ** @return pattern with exactly the given steps, NULL if there is none
+******************************************************************************/
+STATIC const setPattern_t* findPattern(const setPattern_t* first, const setPattern_t* last, const uint32_t* offsets, const uint8_t* states, uint8_t count)
+{
+    for(const setPattern_t* pattern = first; pattern != last; pattern = pattern->next)
+    {
+        if(matchPattern(pattern, offsets, states, count))
+        {
+            return pattern;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,39 @@
+/***************************************************************************************
+ * @file    patternPool.h
+ * @date    October 18th 2026
+ *
+ * @brief   Light set pattern interning header
+ *
+ ****************************************************************************************/
+
+#ifndef _PATTERNPOOL_H_
+#define _PATTERNPOOL_H_
+
+#include <stdatomic.h>
+
+#include "main.h"
+#include "lightSet.h"
+
+#define PAT_BUCKETS             256     //hash chains in a pool, a power of 2
+
+//read-only patterns shared by every light set with the same steps. Chains only
+//grow, at their heads, so they are searched without a lock; patterns are held
+//until the pool is released
+typedef struct patternpool
+{
+    _Atomic(const setPattern_t*) buckets[PAT_BUCKETS];  //patterns chained by content hash
+    _Atomic uint32_t count;                             //distinct patterns held
+    _Atomic uint64_t requests;                          //patterns interned, counting repeats
+} patternPool_t;
+
+//initializer for an empty pool
+#define PATTERN_POOL_INIT       {.count = 0}
+
+//********************* Public function prototypes ****************************//
+
+const setPattern_t* PAT_intern(patternPool_t* pool, const lightSetStep_t* steps, uint8_t count);
+patternPool_t* PAT_getDefault(void);
+void PAT_release(patternPool_t* pool);
+
+
+#endif //_PATTERNPOOL_H_
@@ -0,0 +1,179 @@
+/***************************************************************************************
+ * @file    simulation.c
+ * @date    October 18th 2026
+ *
+ * @brief   Discrete-event simulation of an intersection or a sweep fleet. Time
+ *          is a virtual clock that jumps straight from one light change to the
+ *          next, so the state machine runs exactly as it would in real time
+ *          without waiting for it.
+ *
+ ****************************************************************************************/
+
+#include "main.h"
+#include "simulation.h"
+#include "intersection.h"
+#include "fleet.h"
+#include "sweep.h"
+
+//********************* Local function prototypes ****************************//
+
+STATIC uint32_t countStepChanges(const intersection_t* intersection, const uint8_t* steps);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Run simulation
+ **     Clock an initialized intersection at each of its light changes from the
+ **     start time until the duration has elapsed. Like a polling loop, the
+ **     intersection is clocked again in the same mS while changes are still
+ **     due, up to FLT_MAX_CLOCKS_PER_TICK times.
+ **
+ ** @param intersection: intersection to simulate
+ ** @param start: virtual mS since epoch at which the simulation starts
+ ** @param duration: virtual mS to simulate
+ ** @param handler: optional callback after every clock
+ ** @param arg: user argument passed to the callback
+ ** @param stats: destination for the results
+ **
+ ** @return error code
+******************************************************************************/
+error_t SIM_run(intersection_t* intersection, uint64_t start, uint64_t duration, simHandler_t handler, void* arg, simStats_t* stats)
+{
+    uint64_t millis = start;
+    uint64_t end = start + duration;
+    uint64_t deadline;
+    intState_t state;
+    uint8_t steps[INT_DIRECTIONS];
+    uint8_t clocks = 0;
+    
+    if(!intersection || !stats)
+    {
+        return ERR_nullPtr;
+    }
+    if(end < start)
+    {
+        return ERR_value;
+    }
+    
+    stats->changes = 0;
+    stats->toggles = 0;
+    stats->clocks = 0;
+    
+    while(millis <= end)
+    {
+        state = intersection->state;
+        for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+        {
+            steps[dir] = intersection->lightSets[dir].currentStep;
+        }
+        INT_clockCtx(intersection, millis);
+        stats->clocks++;
+        stats->changes += countStepChanges(intersection, steps);
+        if((state != intersection->state) && (state <= IS_ew) && (intersection->state <= IS_ew))
+        {
+            stats->toggles++;
+        }
+        if(handler)
+        {
+            handler(intersection, millis, arg);
+        }
+        
+        //jump to the next light change, giving up on this mS if it keeps being due
+        deadline = INT_nextDeadlineCtx(intersection);
+        if(deadline > millis)
+        {
+            millis = deadline;
+            clocks = 0;
+        }
+        else if(++clocks >= FLT_MAX_CLOCKS_PER_TICK)
+        {
+            millis++;
+            clocks = 0;
+        }
+    }
+    
+    stats->millis = end;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Run sweep simulation
+ **     Tick an initialized sweep fleet from the start time until the duration
+ **     has elapsed, jumping to the earliest light change of any intersection
+ **     after each tick. Every intersection is clocked as SIM_run() would
+ **     clock it on its own.
+ **
+ ** @param fleet: fleet to simulate
+ ** @param start: virtual mS since epoch at which the simulation starts
+ ** @param duration: virtual mS to simulate
+ ** @param stats: destination for the results, summed over the fleet
+ **
+ ** @return error code
+******************************************************************************/
+error_t SIM_runSweep(sweepFleet_t* fleet, uint64_t start, uint64_t duration, simStats_t* stats)
+{
+    uint64_t millis = start;
+    uint64_t end = start + duration;
+    uint64_t changes;
+    uint64_t toggles;
+    uint64_t clocks;
+    
+    if(!fleet || !stats)
+    {
+        return ERR_nullPtr;
+    }
+    if(end < start)
+    {
+        return ERR_value;
+    }
+    
+    changes = fleet->changes;
+    toggles = fleet->toggles;
+    clocks = fleet->clocks;
+    
+    while(millis <= end)
+    {
+        SWP_tick(fleet, millis);
+        
+        //intersections still due are retried in the next mS
+        millis = (fleet->earliest > millis) ? fleet->earliest : millis + 1;
+    }
+    
+    stats->changes = fleet->changes - changes;
+    stats->toggles = fleet->toggles - toggles;
+    stats->clocks = fleet->clocks - clocks;
+    stats->millis = end;
+    
+    return ERR_success;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Count step changes
+ **     Count the light sets whose step changed since the given snapshot. A set
+ **     rewound to the lead-in when its direction becomes active shows no new
+ **     lights, so it is not counted.
+ **
+ ** @param intersection: clocked intersection
+ ** @param steps: current step of each direction before the clock
+ **
+ ** @return number of light sets that changed step
+******************************************************************************/
+STATIC uint32_t countStepChanges(const intersection_t* intersection, const uint8_t* steps)
+{
+    const packedSet_t* set;
+    uint32_t changes = 0;
+    
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        set = &intersection->lightSets[dir];
+        if((set->currentStep != steps[dir]) && (set->currentStep != set->pattern->count))
+        {
+            changes++;
+        }
+    }
+    
+    return changes;
+}
@@ -0,0 +1,36 @@
+/***************************************************************************************
+ * @file    simulation.h
+ * @date    October 18th 2026
+ *
+ * @brief   Virtual clock simulation header
+ *
+ ****************************************************************************************/
+
+#ifndef _SIMULATION_H_
+#define _SIMULATION_H_
+
+#include "main.h"
+#include "intersection.h"
+#include "sweep.h"
+
+#define SIM_DEFAULT_DURATION    (7ULL * 24 * 60 * 60 * 1000)    //one week of mS
+
+//callback after every clock of the simulated intersection
+typedef void (*simHandler_t)(const intersection_t* intersection, uint64_t millis, void* arg);
+
+//simulation results
+typedef struct simstats
+{
+    uint64_t changes;       //step changes of the light sets
+    uint64_t toggles;       //changes of active direction
+    uint64_t clocks;        //state machine clocks, including those that changed nothing
+    uint64_t millis;        //virtual time at which the simulation stopped
+} simStats_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t SIM_run(intersection_t* intersection, uint64_t start, uint64_t duration, simHandler_t handler, void* arg, simStats_t* stats);
+error_t SIM_runSweep(sweepFleet_t* fleet, uint64_t start, uint64_t duration, simStats_t* stats);
+
+
+#endif //_SIMULATION_H_
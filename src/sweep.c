@@ -0,0 +1,659 @@
+/***************************************************************************************
+ * @file    sweep.c
+ * @date    October 18th 2026
+ *
+ * @brief   Fleet of intersections sharing one config, stored as parallel
+ *          columns. Each tick sweeps the whole next expiry column against the
+ *          current time with a SIMD kernel, producing a bit mask of the due
+ *          intersections; only those are clocked, so an intersection with no
+ *          light change costs one compare.
+ *
+ ****************************************************************************************/
+
+#include <stdlib.h>
+
+#include "main.h"
+#include "sweep.h"
+#include "intersection.h"
+#include "fleet.h"
+
+#ifdef SWP_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#define SWP_SIGN_BIT        (UINT64_C(1) << 63)     //flips unsigned expiries into signed order for the SIMD compares
+
+//*********************** Static variables ***********************************//
+STATIC const intDirection_t pairDirections[2][2] = {{ID_north, ID_south}, {ID_east, ID_west}};    //light sets of IS_ns and IS_ew
+
+//********************* Local function prototypes ****************************//
+STATIC uint64_t clockDue(sweepFleet_t* fleet, uint32_t intersection, uint64_t millis);
+STATIC void clockIntersection(sweepFleet_t* fleet, uint32_t intersection, uint64_t millis);
+STATIC uint64_t getDeadline(const sweepFleet_t* fleet, uint32_t intersection);
+STATIC uint64_t getPatternAnchor(sweepFleet_t* fleet, const activeLightSets_t* active, uint64_t millis);
+STATIC void loadPair(sweepFleet_t* fleet, uint32_t intersection, packedSet_t* pair, activeLightSets_t* active);
+STATIC void storePair(sweepFleet_t* fleet, uint32_t intersection, const packedSet_t* pair);
+STATIC void startPattern(sweepFleet_t* fleet, uint32_t intersection, intState_t state, uint64_t startTime);
+STATIC swpKernel_t selectKernel(void);
+STATIC uint64_t dueMaskScalar(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+#ifdef SWP_X86_KERNELS
+STATIC uint64_t dueMaskSse42(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+STATIC uint64_t dueMaskAvx2(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+#endif
+
+//************************* Function pointers ********************************//
+STATIC void* (*sweepCalloc_ptr)(size_t, size_t) = calloc;  //function ptr for mocking
+STATIC swpKernel_t dueMask_ptr = NULL;                      //kernel picked for this CPU on first use
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Sweep fleet initialization
+ **     Allocate the columns for a fleet of intersections that all run the
+ **     given config. Every intersection starts off, from the config's
+ **     starting steps, and is clocked on the first tick. The config must be
+ **     valid, as there is no per-intersection error pattern to fall back on.
+ **
+ ** @param fleet: fleet to initialize, released with SWP_close()
+ ** @param config: config shared by every intersection
+ ** @param count: number of intersections in the fleet
+ ** @param now: current mS since epoch
+ **
+ ** @return error code
+******************************************************************************/
+error_t SWP_init(sweepFleet_t* fleet, const intConfig_t* config, uint32_t count, uint64_t now)
+{
+    error_t result;
+    size_t size = count ? count : 1;
+    bool allocated;
+
+    if(!fleet || !config)
+    {
+        return ERR_nullPtr;
+    }
+
+    result = CFG_validate(config);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+
+    fleet->count = count;
+    fleet->nextExpiry = sweepCalloc_ptr(size, sizeof(uint64_t));
+    fleet->cycleStart = sweepCalloc_ptr(size, sizeof(uint64_t));
+    fleet->direction = sweepCalloc_ptr(size, sizeof(uint8_t));
+    fleet->due = sweepCalloc_ptr(SWP_MASK_WORDS(size), sizeof(uint64_t));
+    allocated = fleet->nextExpiry && fleet->cycleStart && fleet->direction && fleet->due;
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        fleet->stepStart[i] = sweepCalloc_ptr(size, sizeof(uint32_t));
+        allocated = allocated && fleet->stepStart[i];
+    }
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        fleet->steps[dir] = sweepCalloc_ptr(size, sizeof(uint8_t));
+        allocated = allocated && fleet->steps[dir];
+    }
+    if(!allocated)
+    {
+        printf("Failed to allocate %u intersections\n", count);
+        SWP_close(fleet);
+        return ERR_mem;
+    }
+
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        SET_pack(&fleet->patterns[dir], &config->lightSets[dir]);
+    }
+
+    //off intersections are due immediately, as INT_nextDeadlineCtx() reports
+    for(uint32_t i = 0; i < count; i++)
+    {
+        fleet->direction[i] = IS_off;
+        for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+        {
+            fleet->steps[dir][i] = fleet->patterns[dir].currentStep;
+        }
+    }
+
+    fleet->earliest = now;
+    fleet->changes = 0;
+    fleet->toggles = 0;
+    fleet->clocks = 0;
+    fleet->resyncs = 0;
+    HIST_reset(&fleet->lateness);
+    fleet->ownLateness = NULL;
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Sweep fleet tick
+ **     Sweep the next expiry column for intersections due by the given time
+ **     and clock each of them as FLT_clockDue() would. Intersections still
+ **     due afterwards are retried on the next tick.
+ **
+ ** @param fleet: fleet to tick
+ ** @param millis: current mS since epoch
+ **
+ ** @return number of intersections clocked
+******************************************************************************/
+uint32_t SWP_tick(sweepFleet_t* fleet, uint64_t millis)
+{
+    uint64_t earliest = SWP_dueMask(fleet->nextExpiry, fleet->count, millis, fleet->due);
+    uint64_t deadline;
+    uint64_t word;
+    uint32_t intersection;
+    uint32_t clocked = 0;
+
+    for(uint32_t w = 0; w < SWP_MASK_WORDS(fleet->count); w++)
+    {
+        word = fleet->due[w];
+        while(word)
+        {
+            intersection = w * SWP_WORD_BITS + (uint32_t)__builtin_ctzll(word);
+            word &= word - 1;
+
+            deadline = clockDue(fleet, intersection, millis);
+            fleet->nextExpiry[intersection] = deadline;
+            if(deadline < earliest)
+            {
+                earliest = deadline;
+            }
+            clocked++;
+        }
+    }
+
+    fleet->earliest = earliest;
+
+    return clocked;
+}
+
+ /*****************************************************************************
+ ** @brief Due mask
+ **     Set the bit of every expiry at or before the given time, using the
+ **     fastest kernel the CPU supports. Bits past the last expiry are clear.
+ **
+ ** @param expiry: column of mS since epoch to compare
+ ** @param count: number of expiries in the column
+ ** @param now: current mS since epoch
+ ** @param mask: destination, SWP_MASK_WORDS(count) words
+ **
+ ** @return earliest expiry after now, UINT64_MAX if there is none
+******************************************************************************/
+uint64_t SWP_dueMask(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask)
+{
+    if(!dueMask_ptr)
+    {
+        dueMask_ptr = selectKernel();
+    }
+
+    return dueMask_ptr(expiry, count, now, mask);
+}
+
+ /*****************************************************************************
+ ** @brief Get set state
+ **     Get the illumination state of one direction of an intersection
+ **
+ ** @param fleet: fleet to query
+ ** @param intersection: index of the intersection in the fleet
+ ** @param dir: direction to query
+ **
+ ** @return illumination state of the direction's light set
+******************************************************************************/
+lightSetState_t SWP_getSetState(const sweepFleet_t* fleet, uint32_t intersection, intDirection_t dir)
+{
+    return SET_getStepState(fleet->patterns[dir].pattern, fleet->steps[dir][intersection]);
+}
+
+ /*****************************************************************************
+ ** @brief Attach intersection lateness
+ **     Also record the step change lateness of each intersection of the
+ **     fleet in a histogram of its own
+ **
+ ** @param fleet: initialized fleet
+ ** @param lateness: caller's histograms, one per intersection in the same
+ **     order, reset here; NULL to stop recording them
+ **
+ ** @return none
+******************************************************************************/
+void SWP_attachLateness(sweepFleet_t* fleet, histogram_t* lateness)
+{
+    for(uint32_t i = 0; lateness && (i < fleet->count); i++)
+    {
+        HIST_reset(&lateness[i]);
+    }
+    fleet->ownLateness = lateness;
+}
+
+ /*****************************************************************************
+ ** @brief Sweep fleet close
+ **     Release the columns of a fleet
+ **
+ ** @param fleet: fleet to close
+ **
+ ** @return none
+******************************************************************************/
+void SWP_close(sweepFleet_t* fleet)
+{
+    free(fleet->nextExpiry);
+    free(fleet->cycleStart);
+    free(fleet->direction);
+    free(fleet->due);
+    fleet->nextExpiry = NULL;
+    fleet->cycleStart = NULL;
+    fleet->direction = NULL;
+    fleet->due = NULL;
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        free(fleet->stepStart[i]);
+        fleet->stepStart[i] = NULL;
+    }
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        free(fleet->steps[dir]);
+        fleet->steps[dir] = NULL;
+    }
+    fleet->count = 0;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Clock due intersection
+ **     Clock an intersection at the given time until nothing more is due, up
+ **     to FLT_MAX_CLOCKS_PER_TICK times.
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param intersection: index of the due intersection
+ ** @param millis: current mS since epoch
+ **
+ ** @return mS since epoch of the intersection's next light change
+******************************************************************************/
+STATIC uint64_t clockDue(sweepFleet_t* fleet, uint32_t intersection, uint64_t millis)
+{
+    uint64_t deadline;
+    uint8_t clocks = 0;
+
+    do
+    {
+        clockIntersection(fleet, intersection, millis);
+        deadline = getDeadline(fleet, intersection);
+        clocks++;
+    } while((deadline <= millis) && (clocks < FLT_MAX_CLOCKS_PER_TICK));
+
+    return deadline;
+}
+
+ /*****************************************************************************
+ ** @brief Clock intersection
+ **     Clock one intersection as INT_clockCtx() does. Its active pair of light
+ **     sets is rebuilt from the shared patterns and its columns, clocked with
+ **     SET_stateMachine() and written back.
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param intersection: index of the intersection to clock
+ ** @param millis: current mS since epoch
+ **
+ ** @return none
+******************************************************************************/
+STATIC void clockIntersection(sweepFleet_t* fleet, uint32_t intersection, uint64_t millis)
+{
+    packedSet_t pair[2];
+    activeLightSets_t active;
+    intState_t state = (intState_t)fleet->direction[intersection];
+    lightSetState_t setState;
+    uint64_t anchor;
+
+    fleet->clocks++;
+
+    if((state != IS_ns) && (state != IS_ew))
+    {
+        startPattern(fleet, intersection, IS_ns, millis);
+        return;
+    }
+
+    loadPair(fleet, intersection, pair, &active);
+    setState = SET_stateMachine(&active, millis);
+
+    //count the steps that changed; startPattern() only rewinds sets to the lead-in
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        if(pair[i].currentStep != fleet->steps[pairDirections[state][i]][intersection])
+        {
+            fleet->changes++;
+        }
+    }
+    if(setState == LSS_end)
+    {
+        anchor = getPatternAnchor(fleet, &active, millis);
+        storePair(fleet, intersection, pair);
+        startPattern(fleet, intersection, (state == IS_ns) ? IS_ew : IS_ns, anchor);
+        fleet->toggles++;
+        return;
+    }
+    storePair(fleet, intersection, pair);
+}
+
+ /*****************************************************************************
+ ** @brief Get deadline
+ **     Get the time of an intersection's next light change, as
+ **     INT_nextDeadlineCtx() does.
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param intersection: index of the intersection
+ **
+ ** @return mS since epoch of the next light change, 0 if the intersection
+ **     should be clocked immediately
+******************************************************************************/
+STATIC uint64_t getDeadline(const sweepFleet_t* fleet, uint32_t intersection)
+{
+    intState_t state = (intState_t)fleet->direction[intersection];
+    uint64_t deadline = SET_NO_DEADLINE;
+    uint64_t setDeadline;
+    intDirection_t dir;
+
+    if((state != IS_ns) && (state != IS_ew))
+    {
+        return 0;
+    }
+
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        dir = pairDirections[state][i];
+        if(!fleet->patterns[dir].pattern->count)
+        {
+            continue;
+        }
+        setDeadline = SET_getDeadline(fleet->patterns[dir].pattern, fleet->steps[dir][intersection], fleet->cycleStart[intersection]);
+        if(setDeadline < deadline)
+        {
+            deadline = setDeadline;
+        }
+    }
+
+    //no pending expiration means the active sets are finished; toggle immediately
+    return (deadline == SET_NO_DEADLINE) ? 0 : deadline;
+}
+
+ /*****************************************************************************
+ ** @brief Get cycle anchor
+ **     Get the start time of the next pattern of an intersection whose
+ **     pattern has ended, with the same catch up limit as an intersection_t.
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param active: finished light sets of the intersection
+ ** @param millis: current mS since epoch
+ **
+ ** @return mS since epoch at which the next pattern starts
+******************************************************************************/
+STATIC uint64_t getPatternAnchor(sweepFleet_t* fleet, const activeLightSets_t* active, uint64_t millis)
+{
+    uint64_t endTime = SET_endTime(active);
+
+    //no schedule to keep for unused sets
+    if((endTime == SET_NO_DEADLINE) || (endTime > millis))
+    {
+        return millis;
+    }
+
+    if(millis - endTime > INT_MAX_CATCH_UP)
+    {
+        fleet->resyncs++;
+        return millis;
+    }
+
+    return endTime;
+}
+
+ /*****************************************************************************
+ ** @brief Load pair
+ **     Rebuild the active light sets of an intersection from the shared
+ **     patterns and its columns. The lamps are left as packed; they follow
+ **     from the steps and are not kept per intersection.
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param intersection: index of the intersection
+ ** @param pair: destination for the two active light sets
+ ** @param active: destination for the active light sets pointing at pair
+ **
+ ** @return none
+******************************************************************************/
+STATIC void loadPair(sweepFleet_t* fleet, uint32_t intersection, packedSet_t* pair, activeLightSets_t* active)
+{
+    intDirection_t dir;
+
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        dir = pairDirections[fleet->direction[intersection]][i];
+        pair[i] = fleet->patterns[dir];
+        pair[i].currentStep = fleet->steps[dir][intersection];
+        pair[i].stepStart = fleet->stepStart[i][intersection];
+    }
+
+    active->set1 = &pair[0];
+    active->set2 = &pair[1];
+    active->cycleStartTime = fleet->cycleStart[intersection];
+    active->lateness = &fleet->lateness;
+    active->ownLateness = fleet->ownLateness ? &fleet->ownLateness[intersection] : NULL;
+    active->board = NULL;
+}
+
+ /*****************************************************************************
+ ** @brief Store pair
+ **     Write the progress of clocked active light sets back to the columns
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param intersection: index of the intersection
+ ** @param pair: active light sets filled by loadPair()
+ **
+ ** @return none
+******************************************************************************/
+STATIC void storePair(sweepFleet_t* fleet, uint32_t intersection, const packedSet_t* pair)
+{
+    intDirection_t dir;
+
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        dir = pairDirections[fleet->direction[intersection]][i];
+        fleet->steps[dir][intersection] = pair[i].currentStep;
+        fleet->stepStart[i][intersection] = pair[i].stepStart;
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Start pattern
+ **     Make a direction active, as SET_assignLights() does for an
+ **     intersection_t. Its sets continue from the steps they were left at,
+ **     or from the lead-in if they finished their last pattern.
+ **
+ ** @param fleet: fleet of the intersection
+ ** @param intersection: index of the intersection
+ ** @param state: direction to activate, IS_ns or IS_ew
+ ** @param startTime: mS since epoch at which the pattern starts
+ **
+ ** @return none
+******************************************************************************/
+STATIC void startPattern(sweepFleet_t* fleet, uint32_t intersection, intState_t state, uint64_t startTime)
+{
+    intDirection_t dir;
+
+    fleet->direction[intersection] = (uint8_t)state;
+    fleet->cycleStart[intersection] = startTime;
+    fleet->stepStart[0][intersection] = 0;
+    fleet->stepStart[1][intersection] = 0;
+
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        dir = pairDirections[state][i];
+        if(SET_getStepState(fleet->patterns[dir].pattern, fleet->steps[dir][intersection]) == LSS_end)
+        {
+            fleet->steps[dir][intersection] = fleet->patterns[dir].pattern->count;
+        }
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Select kernel
+ **     Pick the widest due mask kernel the CPU supports
+ **
+ ** @param none
+ **
+ ** @return due mask kernel
+******************************************************************************/
+STATIC swpKernel_t selectKernel(void)
+{
+#ifdef SWP_X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return dueMaskAvx2;
+    }
+    if(__builtin_cpu_supports("sse4.2"))
+    {
+        return dueMaskSse42;
+    }
+#endif
+
+    return dueMaskScalar;
+}
+
+ /*****************************************************************************
+ ** @brief Due mask, scalar
+ **     Portable due mask kernel, also used for the tail of the SIMD kernels
+ **
+ ** @param expiry: column of mS since epoch to compare
+ ** @param count: number of expiries in the column
+ ** @param now: current mS since epoch
+ ** @param mask: destination, SWP_MASK_WORDS(count) words
+ **
+ ** @return earliest expiry after now, UINT64_MAX if there is none
+******************************************************************************/
+STATIC uint64_t dueMaskScalar(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask)
+{
+    uint64_t earliest = UINT64_MAX;
+    uint64_t candidate;
+    uint64_t word;
+    uint32_t bits;
+
+    for(uint32_t base = 0; base < count; base += SWP_WORD_BITS)
+    {
+        bits = ((count - base) < SWP_WORD_BITS) ? (count - base) : SWP_WORD_BITS;
+        word = 0;
+        for(uint32_t bit = 0; bit < bits; bit++)
+        {
+            word |= (uint64_t)(expiry[base + bit] <= now) << bit;
+            candidate = (expiry[base + bit] > now) ? expiry[base + bit] : UINT64_MAX;
+            earliest = (candidate < earliest) ? candidate : earliest;
+        }
+        mask[base / SWP_WORD_BITS] = word;
+    }
+
+    return earliest;
+}
+
+#ifdef SWP_X86_KERNELS
+ /*****************************************************************************
+ ** @brief Due mask, SSE4.2
+ **     Due mask kernel comparing two expiries per instruction. Full words are
+ **     swept with SIMD, the last partial word with the scalar kernel.
+ **
+ ** @param expiry: column of mS since epoch to compare
+ ** @param count: number of expiries in the column
+ ** @param now: current mS since epoch
+ ** @param mask: destination, SWP_MASK_WORDS(count) words
+ **
+ ** @return earliest expiry after now, UINT64_MAX if there is none
+******************************************************************************/
+__attribute__((target("sse4.2")))
+STATIC uint64_t dueMaskSse42(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask)
+{
+    const __m128i sign = _mm_set1_epi64x((int64_t)SWP_SIGN_BIT);
+    const __m128i none = _mm_set1_epi64x(INT64_MAX);       //UINT64_MAX in signed order
+    const __m128i signedNow = _mm_set1_epi64x((int64_t)(now ^ SWP_SIGN_BIT));
+    __m128i earliest = none;
+    __m128i lanes;
+    __m128i later;
+    __m128i candidate;
+    uint64_t lanesEarliest[2];
+    uint64_t result;
+    uint64_t word;
+    uint32_t words = count / SWP_WORD_BITS;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        word = 0;
+        for(uint32_t bit = 0; bit < SWP_WORD_BITS; bit += 2)
+        {
+            lanes = _mm_xor_si128(_mm_loadu_si128((const __m128i*)&expiry[w * SWP_WORD_BITS + bit]), sign);
+            later = _mm_cmpgt_epi64(lanes, signedNow);
+            word |= (uint64_t)(~_mm_movemask_pd(_mm_castsi128_pd(later)) & 0x3) << bit;
+            candidate = _mm_blendv_epi8(none, lanes, later);
+            earliest = _mm_blendv_epi8(earliest, candidate, _mm_cmpgt_epi64(earliest, candidate));
+        }
+        mask[w] = word;
+    }
+
+    result = dueMaskScalar(&expiry[words * SWP_WORD_BITS], count - words * SWP_WORD_BITS, now, &mask[words]);
+    _mm_storeu_si128((__m128i*)lanesEarliest, earliest);
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        lanesEarliest[i] ^= SWP_SIGN_BIT;
+        result = (lanesEarliest[i] < result) ? lanesEarliest[i] : result;
+    }
+
+    return result;
+}
+
+ /*****************************************************************************
+ ** @brief Due mask, AVX2
+ **     Due mask kernel comparing four expiries per instruction. Full words
+ **     are swept with SIMD, the last partial word with the scalar kernel.
+ **
+ ** @param expiry: column of mS since epoch to compare
+ ** @param count: number of expiries in the column
+ ** @param now: current mS since epoch
+ ** @param mask: destination, SWP_MASK_WORDS(count) words
+ **
+ ** @return earliest expiry after now, UINT64_MAX if there is none
+******************************************************************************/
+__attribute__((target("avx2")))
+STATIC uint64_t dueMaskAvx2(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask)
+{
+    const __m256i sign = _mm256_set1_epi64x((int64_t)SWP_SIGN_BIT);
+    const __m256i none = _mm256_set1_epi64x(INT64_MAX);    //UINT64_MAX in signed order
+    const __m256i signedNow = _mm256_set1_epi64x((int64_t)(now ^ SWP_SIGN_BIT));
+    __m256i earliest = none;
+    __m256i lanes;
+    __m256i later;
+    __m256i candidate;
+    uint64_t lanesEarliest[4];
+    uint64_t result;
+    uint64_t word;
+    uint32_t words = count / SWP_WORD_BITS;
+
+    for(uint32_t w = 0; w < words; w++)
+    {
+        word = 0;
+        for(uint32_t bit = 0; bit < SWP_WORD_BITS; bit += 4)
+        {
+            lanes = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)&expiry[w * SWP_WORD_BITS + bit]), sign);
+            later = _mm256_cmpgt_epi64(lanes, signedNow);
+            word |= (uint64_t)(~_mm256_movemask_pd(_mm256_castsi256_pd(later)) & 0xF) << bit;
+            candidate = _mm256_blendv_epi8(none, lanes, later);
+            earliest = _mm256_blendv_epi8(earliest, candidate, _mm256_cmpgt_epi64(earliest, candidate));
+        }
+        mask[w] = word;
+    }
+
+    result = dueMaskScalar(&expiry[words * SWP_WORD_BITS], count - words * SWP_WORD_BITS, now, &mask[words]);
+    _mm256_storeu_si256((__m256i*)lanesEarliest, earliest);
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        lanesEarliest[i] ^= SWP_SIGN_BIT;
+        result = (lanesEarliest[i] < result) ? lanesEarliest[i] : result;
+    }
+
+    return result;
+}
+#endif
@@ -0,0 +1,60 @@
+/***************************************************************************************
+ * @file    sweep.h
+ * @date    October 18th 2026
+ *
+ * @brief   Struct-of-arrays fleet header
+ *
+ ****************************************************************************************/
+
+#ifndef _SWEEP_H_
+#define _SWEEP_H_
+
+#include "main.h"
+#include "config.h"
+#include "lightSet.h"
+#include "histogram.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SWP_X86_KERNELS             //SSE4.2 and AVX2 due mask kernels are built
+#endif
+
+#define SWP_WORD_BITS       64      //intersections covered by each word of the due mask
+
+//number of due mask words covering a fleet
+#define SWP_MASK_WORDS(count)       (((count) + SWP_WORD_BITS - 1) / SWP_WORD_BITS)
+
+//due mask kernel: sets the bit of every expiry at or before now and returns
+//the earliest expiry after now, UINT64_MAX if there is none
+typedef uint64_t (*swpKernel_t)(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+
+//intersections running one shared config, stored as parallel columns
+typedef struct sweepfleet
+{
+    packedSet_t patterns[INT_DIRECTIONS];   //light sets every intersection runs, packed from the shared config
+    uint32_t count;                 //number of intersections in the fleet
+    uint64_t* nextExpiry;           //mS since epoch of each intersection's next light change
+    uint64_t* cycleStart;           //mS since epoch at which each intersection's current pattern started
+    uint32_t* stepStart[2];         //offset at which the current step of each active set was scheduled to start
+    uint8_t* steps[INT_DIRECTIONS]; //active step of each direction's light set
+    uint8_t* direction;             //intState_t of each intersection
+    uint64_t* due;                  //bit per intersection due in the current tick
+    uint64_t earliest;              //earliest next light change after the last tick
+    uint64_t changes;               //step changes of the light sets
+    uint64_t toggles;               //changes of active direction
+    uint64_t clocks;                //state machine clocks, including those that changed nothing
+    uint32_t resyncs;               //direction changes too late to keep the schedule
+    histogram_t lateness;           //mS between the scheduled and clocked time of every step change
+    histogram_t* ownLateness;       //optional lateness of each intersection's step changes, indexed like them
+} sweepFleet_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t SWP_init(sweepFleet_t* fleet, const intConfig_t* config, uint32_t count, uint64_t now);
+uint32_t SWP_tick(sweepFleet_t* fleet, uint64_t millis);
+uint64_t SWP_dueMask(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+lightSetState_t SWP_getSetState(const sweepFleet_t* fleet, uint32_t intersection, intDirection_t dir);
+void SWP_attachLateness(sweepFleet_t* fleet, histogram_t* lateness);
+void SWP_close(sweepFleet_t* fleet);
+
+
+#endif //_SWEEP_H_
@@ -0,0 +1,310 @@
+/***************************************************************************************
+ * @file    timeline.c
+ * @date    October 18th 2026
+ *
+ * @brief   Compiles an intersection configuration into a flat timeline of one
+ *          North-South/East-West cycle, so the lights at any time can be
+ *          found with a binary search instead of replaying the patterns.
+ *
+ *          Each phase lasts until both of its light sets reach their end
+ *          step, as the intersection state machine toggles direction only
+ *          then. A set that ends early holds its end state until the toggle,
+ *          as end steps never expire, and starts the next phase from its
+ *          first step.
+ *          Steps whose time has already passed when they start last 0mS,
+ *          and phases with no used light sets are skipped.
+ *
+ ****************************************************************************************/
+
+#include "main.h"
+#include "timeline.h"
+#include "config.h"
+#include "lightSet.h"
+
+//*********************** Local types ****************************************//
+
+//steps visited by a light set during one phase
+typedef struct tlpattern
+{
+    uint64_t starts[MAX_STEPS_IN_PATTERN];  //mS from the phase start at which each step begins
+    uint8_t steps[MAX_STEPS_IN_PATTERN];    //index of each visited step
+    uint8_t count;                          //number of visited steps, 0 for unused sets
+} tlPattern_t;
+
+//********************* Local function prototypes ****************************//
+STATIC error_t compilePattern(const lightSet_t* set, tlPattern_t* pattern);
+STATIC error_t compilePhase(timeline_t* timeline, const intConfig_t* config, intState_t state, uint64_t base, uint64_t* length);
+STATIC void fillEntry(tlEntry_t* entry, const intConfig_t* config, intState_t state, lightSetState_t state1, lightSetState_t state2);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Compile timeline
+ **     Lay out one full cycle of an intersection, starting with North-South.
+ **
+ ** @param timeline: destination timeline
+ ** @param config: intersection config to compile
+ **
+ ** @return error code
+******************************************************************************/
+error_t TL_compile(timeline_t* timeline, const intConfig_t* config)
+{
+    error_t result;
+    uint64_t nsLength;
+    uint64_t ewLength;
+    
+    if(!timeline || !config)
+    {
+        return ERR_nullPtr;
+    }
+    
+    timeline->count = 0;
+    timeline->cycleLength = 0;
+    
+    result = compilePhase(timeline, config, IS_ns, 0, &nsLength);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    result = compilePhase(timeline, config, IS_ew, nsLength, &ewLength);
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
+    //nothing ever changes
+    if(!timeline->count)
+    {
+        return ERR_value;
+    }
+    
+    timeline->cycleLength = nsLength + ewLength;
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Timeline lookup
+ **     Find what the intersection shows at a given time
+ **
+ ** @param timeline: compiled timeline
+ ** @param origin: mS since epoch at which a North-South phase started
+ ** @param millis: mS since epoch to look up; times before the origin give the
+ **     first entry
+ **
+ ** @return entry in effect at the given time, NULL for an empty timeline
+******************************************************************************/
+const tlEntry_t* TL_lookup(const timeline_t* timeline, uint64_t origin, uint64_t millis)
+{
+    uint64_t offset;
+    uint16_t low = 0;
+    uint16_t high;
+    uint16_t mid;
+    
+    if(!timeline || !timeline->count)
+    {
+        return NULL;
+    }
+    
+    offset = (millis > origin) ? ((millis - origin) % timeline->cycleLength) : 0;
+    
+    //last entry starting at or before the offset
+    high = timeline->count - 1;
+    while(low < high)
+    {
+        mid = (uint16_t)((low + high + 1) / 2);
+        if(timeline->offsets[mid] <= offset)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+    
+    return &timeline->entries[low];
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Compile pattern
+ **     List the steps a light set visits from the start of its phase until its
+ **     end step, following the same order as incrementLightSetStep.
+ **
+ ** @param set: light set to compile
+ ** @param pattern: destination for the visited steps
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t compilePattern(const lightSet_t* set, tlPattern_t* pattern)
+{
+    uint64_t start = 0;
+    uint8_t step = 0;
+    
+    pattern->count = 0;
+    
+    //unused sets never change
+    if(!set || !set->pattern->count)
+    {
+        return ERR_success;
+    }
+    
+    while(pattern->count < set->pattern->count)
+    {
+        pattern->starts[pattern->count] = start;
+        pattern->steps[pattern->count] = step;
+        pattern->count++;
+        
+        if(set->pattern->states[step] == LSS_end)
+        {
+            return ERR_success;
+        }
+        
+        //the next step starts when this one expires, or immediately if that has passed
+        if(SET_getOffset(set->pattern, step) > start)
+        {
+            start = SET_getOffset(set->pattern, step);
+        }
+        step = (step + 1 < set->pattern->count) ? step + 1 : 0;
+    }
+    
+    //patterns must finish with an end step
+    return ERR_format;
+}
+
+ /*****************************************************************************
+ ** @brief Compile phase
+ **     Append the entries for one active direction to the timeline
+ **
+ ** @param timeline: timeline being compiled
+ ** @param config: intersection config
+ ** @param state: direction of the phase, IS_ns or IS_ew
+ ** @param base: mS from the cycle start at which the phase starts
+ ** @param length: destination for the length of the phase in mS
+ **
+ ** @return error code
+******************************************************************************/
+STATIC error_t compilePhase(timeline_t* timeline, const intConfig_t* config, intState_t state, uint64_t base, uint64_t* length)
+{
+    const lightSet_t* sets = config->lightSets;
+    tlPattern_t pattern1;
+    tlPattern_t pattern2;
+    error_t result;
+    uint64_t time = 0;
+    uint64_t next;
+    uint8_t index1 = 0;
+    uint8_t index2 = 0;
+    
+    result = compilePattern((state == IS_ns) ? &sets[ID_north] : &sets[ID_east], &pattern1);
+    if(result == ERR_success)
+    {
+        result = compilePattern((state == IS_ns) ? &sets[ID_south] : &sets[ID_west], &pattern2);
+    }
+    if(result != ERR_success)
+    {
+        return result;
+    }
+    
+    //the phase ends when the later of the two sets reaches its end step
+    *length = 0;
+    if(pattern1.count && (pattern1.starts[pattern1.count - 1] > *length))
+    {
+        *length = pattern1.starts[pattern1.count - 1];
+    }
+    if(pattern2.count && (pattern2.starts[pattern2.count - 1] > *length))
+    {
+        *length = pattern2.starts[pattern2.count - 1];
+    }
+    
+    //merge the step changes of both sets
+    while(time < *length)
+    {
+        while((index1 < pattern1.count) && (pattern1.starts[index1] <= time))
+        {
+            index1++;
+        }
+        while((index2 < pattern2.count) && (pattern2.starts[index2] <= time))
+        {
+            index2++;
+        }
+        
+        if(timeline->count >= TL_MAX_ENTRIES)
+        {
+            return ERR_mem;
+        }
+        timeline->offsets[timeline->count] = base + time;
+        fillEntry(&timeline->entries[timeline->count], config, state,
+                  index1 ? sets[(state == IS_ns) ? ID_north : ID_east].pattern->states[pattern1.steps[index1 - 1]] : LSS_end,
+                  index2 ? sets[(state == IS_ns) ? ID_south : ID_west].pattern->states[pattern2.steps[index2 - 1]] : LSS_end);
+        timeline->count++;
+        
+        next = *length;
+        if((index1 < pattern1.count) && (pattern1.starts[index1] < next))
+        {
+            next = pattern1.starts[index1];
+        }
+        if((index2 < pattern2.count) && (pattern2.starts[index2] < next))
+        {
+            next = pattern2.starts[index2];
+        }
+        time = next;
+    }
+    
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Fill entry
+ **     Precompute the light outputs of every direction. Inactive directions
+ **     show their end state.
+ **
+ ** @param entry: entry to fill
+ ** @param config: intersection config
+ ** @param state: active directions, IS_ns or IS_ew
+ ** @param state1: illumination state of North or East
+ ** @param state2: illumination state of South or West
+ **
+ ** @return none
+******************************************************************************/
+STATIC void fillEntry(tlEntry_t* entry, const intConfig_t* config, intState_t state, lightSetState_t state1, lightSetState_t state2)
+{
+    lightSetState_t setState;
+    bool populated;
+    
+    entry->state = state;
+    
+    for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+    {
+        if((state == IS_ns) && (direction == ID_north))
+        {
+            setState = state1;
+        }
+        else if((state == IS_ns) && (direction == ID_south))
+        {
+            setState = state2;
+        }
+        else if((state == IS_ew) && (direction == ID_east))
+        {
+            setState = state1;
+        }
+        else if((state == IS_ew) && (direction == ID_west))
+        {
+            setState = state2;
+        }
+        else
+        {
+            setState = LSS_end;
+        }
+        entry->setStates[direction] = (uint8_t)setState;
+        
+        //lights after the first unused one are never driven
+        populated = true;
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            populated = populated && (config->lightSets[direction].lights[i].type != LDT_unused);
+            entry->lamps[direction][i] = populated ? (uint8_t)SET_getLightState(&config->lightSets[direction].lights[i], setState) : LS_off;
+        }
+    }
+}
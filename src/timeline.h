@@ -0,0 +1,42 @@
+/***************************************************************************************
+ * @file    timeline.h
+ * @date    October 18th 2026
+ *
+ * @brief   Compiled intersection timeline header
+ *
+ ****************************************************************************************/
+
+#ifndef _TIMELINE_H_
+#define _TIMELINE_H_
+
+#include "main.h"
+#include "config.h"
+#include "lightSet.h"
+#include "intersection.h"
+
+#define TL_MAX_ENTRIES          (2 * 2 * MAX_STEPS_IN_PATTERN)  //two phases of two light sets each
+
+//everything shown by the intersection between two light changes
+typedef struct tlentry
+{
+    intState_t state;                                   //active directions
+    uint8_t setStates[INT_DIRECTIONS];                  //lightSetState_t of each direction
+    uint8_t lamps[INT_DIRECTIONS][MAX_LIGHTS_IN_SET];   //lightState_t of each light
+} tlEntry_t;
+
+//one full North-South/East-West cycle of an intersection
+typedef struct timeline
+{
+    uint64_t offsets[TL_MAX_ENTRIES];   //sorted mS from the cycle start at which each entry begins
+    tlEntry_t entries[TL_MAX_ENTRIES];  //light outputs from each offset until the next
+    uint16_t count;                     //number of entries
+    uint64_t cycleLength;               //mS in one full cycle
+} timeline_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t TL_compile(timeline_t* timeline, const intConfig_t* config);
+const tlEntry_t* TL_lookup(const timeline_t* timeline, uint64_t origin, uint64_t millis);
+
+
+#endif //_TIMELINE_H_
@@ -0,0 +1,239 @@
+/***************************************************************************************
+ * @file    timerWheel.c
+ * @date    October 18th 2026
+ *
+ * @brief   Hierarchical timing wheel. Level 0 has one slot per mS, each higher
+ *          level covers a full turn of the level below it per slot. Timers are
+ *          filed by absolute expiry, so scheduling, cancelling and expiring
+ *          are O(1); timers in higher levels are moved down (cascaded) once
+ *          per turn of the level below.
+ *
+ ****************************************************************************************/
+
+#include "main.h"
+#include "timerWheel.h"
+
+//********************* Local function prototypes ****************************//
+STATIC void insertNode(timerWheel_t* wheel, twNode_t* node);
+STATIC void cascade(timerWheel_t* wheel, uint8_t level);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Timing wheel initialization
+ **     Empty the wheel and set its current time
+ **
+ ** @param wheel: timing wheel to initialize
+ ** @param now: mS since epoch from which the wheel starts
+ **
+ ** @return none
+******************************************************************************/
+void TW_init(timerWheel_t* wheel, uint64_t now)
+{
+    for(uint8_t level = 0; level < TW_LEVELS; level++)
+    {
+        for(uint16_t slot = 0; slot < TW_SLOTS; slot++)
+        {
+            wheel->slots[level][slot].next = &wheel->slots[level][slot];
+            wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+        }
+    }
+
+    wheel->now = now;
+    wheel->count = 0;
+}
+
+ /*****************************************************************************
+ ** @brief Schedule timer
+ **     Schedule a timer, moving it if it is already scheduled. Expiries that
+ **     have already passed fire on the next advance.
+ **
+ ** @param wheel: timing wheel
+ ** @param node: timer to schedule
+ ** @param expiry: mS since epoch at which the timer expires
+ **
+ ** @return none
+******************************************************************************/
+void TW_schedule(timerWheel_t* wheel, twNode_t* node, uint64_t expiry)
+{
+    TW_cancel(wheel, node);
+
+    node->expiry = expiry;
+    insertNode(wheel, node);
+    wheel->count++;
+}
+
+ /*****************************************************************************
+ ** @brief Cancel timer
+ **     Remove a timer from the wheel. Nothing happens if it is not scheduled.
+ **
+ ** @param wheel: timing wheel
+ ** @param node: timer to cancel
+ **
+ ** @return none
+******************************************************************************/
+void TW_cancel(timerWheel_t* wheel, twNode_t* node)
+{
+    if(!TW_isScheduled(node))
+    {
+        return;
+    }
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = NULL;
+    node->prev = NULL;
+    wheel->count--;
+}
+
+ /*****************************************************************************
+ ** @brief Is timer scheduled
+ **     Nodes must be zero initialized before first use.
+ **
+ ** @param node: timer to check
+ **
+ ** @return true if the timer is in a wheel
+******************************************************************************/
+bool TW_isScheduled(const twNode_t* node)
+{
+    return node->next != NULL;
+}
+
+ /*****************************************************************************
+ ** @brief Advance wheel
+ **     Process every mS up to and including the given time, calling the
+ **     handler for each timer that expires. Only the slots for the processed
+ **     mS are touched. Timers rescheduled by the handler at or before the mS
+ **     being processed fire in the following mS.
+ **
+ ** @param wheel: timing wheel
+ ** @param millis: current mS since epoch
+ ** @param handler: callback for expired timers
+ ** @param arg: user argument passed to the callback
+ **
+ ** @return number of expired timers
+******************************************************************************/
+uint32_t TW_advance(timerWheel_t* wheel, uint64_t millis, twExpireHandler_t handler, void* arg)
+{
+    uint32_t expired = 0;
+    twNode_t due;       //list of timers expiring in the current mS
+    twNode_t* head;
+    twNode_t* node;
+    uint64_t tick;
+
+    while(wheel->now <= millis)
+    {
+        //nothing can expire in an empty wheel
+        if(!wheel->count)
+        {
+            wheel->now = millis + 1;
+            break;
+        }
+
+        //move timers down from every level that completed a turn, highest first
+        for(uint8_t level = TW_LEVELS - 1; level > 0; level--)
+        {
+            if(!(wheel->now & ((UINT64_C(1) << (level * TW_SLOT_BITS)) - 1)))
+            {
+                cascade(wheel, level);
+            }
+        }
+
+        //detach this mS's timers so handlers rescheduling into the past land in the next mS
+        head = &wheel->slots[0][wheel->now & TW_SLOT_MASK];
+        if(head->next == head)
+        {
+            wheel->now++;
+            continue;
+        }
+        due.next = head->next;
+        due.prev = head->prev;
+        due.next->prev = &due;
+        due.prev->next = &due;
+        head->next = head;
+        head->prev = head;
+        tick = wheel->now++;
+
+        while(due.next != &due)
+        {
+            node = due.next;
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+            node->next = NULL;
+            node->prev = NULL;
+            wheel->count--;
+            handler(node, tick, arg);
+            expired++;
+        }
+    }
+
+    return expired;
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Insert node
+ **     File a timer in the lowest level whose span covers its expiry
+ **
+ ** @param wheel: timing wheel
+ ** @param node: timer to insert, with its expiry set
+ **
+ ** @return none
+******************************************************************************/
+STATIC void insertNode(timerWheel_t* wheel, twNode_t* node)
+{
+    uint64_t expiry = node->expiry;
+    uint64_t delta;
+    uint8_t level;
+    twNode_t* head;
+
+    //overdue timers fire on the next processed mS
+    if(expiry < wheel->now)
+    {
+        expiry = wheel->now;
+    }
+
+    //timers beyond the wheel's span are parked at its far end and re-filed when cascaded
+    delta = expiry - wheel->now;
+    if(delta > TW_MAX_DELTA)
+    {
+        delta = TW_MAX_DELTA;
+        expiry = wheel->now + delta;
+    }
+
+    level = 0;
+    while(delta >= (UINT64_C(1) << ((level + 1) * TW_SLOT_BITS)))
+    {
+        level++;
+    }
+
+    head = &wheel->slots[level][(expiry >> (level * TW_SLOT_BITS)) & TW_SLOT_MASK];
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+ /*****************************************************************************
+ ** @brief Cascade
+ **     Re-file every timer in the current slot of a level into lower levels
+ **
+ ** @param wheel: timing wheel
+ ** @param level: level to cascade
+ **
+ ** @return none
+******************************************************************************/
+STATIC void cascade(timerWheel_t* wheel, uint8_t level)
+{
+    twNode_t* head = &wheel->slots[level][(wheel->now >> (level * TW_SLOT_BITS)) & TW_SLOT_MASK];
+    twNode_t* node;
+
+    while(head->next != head)
+    {
+        node = head->next;
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        insertNode(wheel, node);
+    }
+}
@@ -0,0 +1,48 @@
+/***************************************************************************************
+ * @file    timerWheel.h
+ * @date    October 18th 2026
+ *
+ * @brief   Hierarchical timing wheel header
+ *
+ ****************************************************************************************/
+
+#ifndef _TIMERWHEEL_H_
+#define _TIMERWHEEL_H_
+
+#include "main.h"
+
+#define TW_LEVELS               4                       //number of wheel levels
+#define TW_SLOT_BITS            8                       //log2 of slots per level
+#define TW_SLOTS                (1 << TW_SLOT_BITS)     //slots per level
+#define TW_SLOT_MASK            (TW_SLOTS - 1)
+#define TW_MAX_DELTA            ((UINT64_C(1) << (TW_LEVELS * TW_SLOT_BITS)) - 1)   //longest span the wheel covers (~49 days of mS)
+
+//timer entry; embedded in the object being scheduled
+typedef struct twnode
+{
+    struct twnode* next;
+    struct twnode* prev;
+    uint64_t expiry;        //mS since epoch at which the timer expires
+} twNode_t;
+
+//callback for an expired timer; the node has been removed from the wheel and may be rescheduled
+typedef void (*twExpireHandler_t)(twNode_t* node, uint64_t millis, void* arg);
+
+//timing wheel with 1mS resolution
+typedef struct timerwheel
+{
+    uint64_t now;                           //next mS to be processed
+    uint32_t count;                         //number of scheduled timers
+    twNode_t slots[TW_LEVELS][TW_SLOTS];    //list heads of each slot
+} timerWheel_t;
+
+//********************* Public function prototypes ****************************//
+
+void TW_init(timerWheel_t* wheel, uint64_t now);
+void TW_schedule(timerWheel_t* wheel, twNode_t* node, uint64_t expiry);
+void TW_cancel(timerWheel_t* wheel, twNode_t* node);
+bool TW_isScheduled(const twNode_t* node);
+uint32_t TW_advance(timerWheel_t* wheel, uint64_t millis, twExpireHandler_t handler, void* arg);
+
+
+#endif //_TIMERWHEEL_H_
@@ -0,0 +1,518 @@
+/***************************************************************************************
+ * @file    workerPool.c
+ * @date    October 18th 2026
+ *
+ * @brief   Shards intersections across worker threads. Each worker keeps the
+ *          next light change of its own intersections in a private timing
+ *          wheel; on every tick it moves its due intersections into a queue
+ *          and clocks them, and workers that run out of due intersections
+ *          steal from the queues of busier workers.
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for clock_gettime
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "main.h"
+#include "workerPool.h"
+#include "fleet.h"
+#include "timerWheel.h"
+
+//*********************** Static variables ***********************************//
+STATIC void* (*calloc_ptr)(size_t, size_t) = calloc;    //function ptr for mocking
+
+//********************* Local function prototypes ****************************//
+STATIC void* workerThread(void* arg);
+STATIC uint32_t runTick(worker_t* worker, uint64_t millis);
+STATIC void collectDue(twNode_t* node, uint64_t millis, void* arg);
+STATIC intersection_t* takeDue(worker_t* worker);
+STATIC intersection_t* stealDue(worker_t* worker);
+STATIC worker_t* getOwner(workerPool_t* pool, const intersection_t* intersection);
+STATIC uint64_t getNanos(void);
+
+//************************ Public functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Worker pool initialization
+ **     Share the intersections out between the workers, schedule each one for
+ **     its first clock and start the worker threads. The intersections must
+ **     already be initialized.
+ **
+ ** @param pool: pool to initialize
+ ** @param intersections: array of intersections to drive
+ ** @param count: number of intersections in the array
+ ** @param numWorkers: number of worker threads to start
+ ** @param now: current mS since epoch
+ **
+ ** @return error code
+******************************************************************************/
+error_t WRK_init(workerPool_t* pool, intersection_t* intersections, uint32_t count, uint8_t numWorkers, uint64_t now)
+{
+    worker_t* worker;
+    uint32_t capacity;
+    uint8_t started;
+
+    if(!pool || (!intersections && count))
+    {
+        return ERR_nullPtr;
+    }
+    if(!numWorkers || (numWorkers > WRK_MAX_WORKERS))
+    {
+        return ERR_value;
+    }
+
+    pool->intersections = intersections;
+    pool->count = count;
+    pool->numWorkers = numWorkers;
+    pool->generation = 0;
+    pool->active = 0;
+    pool->clocked = 0;
+    pool->running = true;
+
+    //a worker's queue only has to hold the intersections it owns
+    capacity = (count + numWorkers - 1) / numWorkers;
+
+    pool->workers = calloc_ptr(numWorkers, sizeof(worker_t));
+    if(!pool->workers)
+    {
+        printf("Failed to allocate %u workers\n", numWorkers);
+        return ERR_mem;
+    }
+    for(uint8_t i = 0; i < numWorkers; i++)
+    {
+        worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->due = calloc_ptr(capacity ? capacity : 1, sizeof(intersection_t*));
+        if(!worker->due)
+        {
+            printf("Failed to allocate worker queue\n");
+            for(uint8_t j = 0; j < i; j++)
+            {
+                free(pool->workers[j].due);
+            }
+            free(pool->workers);
+            pool->workers = NULL;
+            return ERR_mem;
+        }
+        pthread_mutex_init(&worker->lock, NULL);
+        TW_init(&worker->wheel, now);
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        intersections[i].timer.next = NULL;
+        TW_schedule(&pool->workers[i % numWorkers].wheel, &intersections[i].timer, INT_nextDeadlineCtx(&intersections[i]));
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->startNs = getNanos();
+
+    for(started = 0; started < numWorkers; started++)
+    {
+        if(pthread_create(&pool->workers[started].thread, NULL, workerThread, &pool->workers[started]))
+        {
+            printf("Failed to start worker thread\n");
+            break;
+        }
+    }
+    if(started < numWorkers)
+    {
+        pool->numWorkers = started;
+        WRK_close(pool);
+        return ERR_other;
+    }
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Worker pool tick
+ **     Have the workers clock every intersection whose next light change is
+ **     due by the given time, and wait for them to finish.
+ **
+ ** @param pool: pool to tick
+ ** @param millis: current mS since epoch
+ **
+ ** @return number of intersections clocked
+******************************************************************************/
+uint32_t WRK_tick(workerPool_t* pool, uint64_t millis)
+{
+    uint32_t clocked;
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->millis = millis;
+    pool->clocked = 0;
+    pool->active = pool->numWorkers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+
+    while(pool->active)
+    {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    clocked = pool->clocked;
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return clocked;
+}
+
+ /*****************************************************************************
+ ** @brief Get worker stats
+ **     Copy a worker's counters. Must not be called during a tick.
+ **
+ ** @param pool: worker pool
+ ** @param worker: index of the worker
+ ** @param stats: destination for the counters
+ **
+ ** @return error code
+******************************************************************************/
+error_t WRK_getStats(workerPool_t* pool, uint8_t worker, wrkStats_t* stats)
+{
+    if(!pool || !stats || !pool->workers)
+    {
+        return ERR_nullPtr;
+    }
+    if(worker >= pool->numWorkers)
+    {
+        return ERR_value;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    *stats = pool->workers[worker].stats;
+    pthread_mutex_unlock(&pool->lock);
+    stats->totalNs = getNanos() - pool->startNs;
+
+    return ERR_success;
+}
+
+ /*****************************************************************************
+ ** @brief Print worker stats
+ **     Print the utilization and counters of every worker
+ **
+ ** @param pool: worker pool
+ **
+ ** @return none
+******************************************************************************/
+void WRK_printStats(workerPool_t* pool)
+{
+    wrkStats_t stats;
+
+    for(uint8_t i = 0; i < pool->numWorkers; i++)
+    {
+        if(WRK_getStats(pool, i, &stats) != ERR_success)
+        {
+            return;
+        }
+
+        printf("Worker %u: %5.1f%% busy, %llu clocks, %llu stolen\n", i,
+               stats.totalNs ? (100.0 * (double)stats.busyNs / (double)stats.totalNs) : 0.0,
+               (unsigned long long)stats.clocks, (unsigned long long)stats.steals);
+    }
+}
+
+ /*****************************************************************************
+ ** @brief Get pool lateness
+ **     Combine the step change lateness recorded by every worker in the
+ **     pool. Must not be called during a tick.
+ **
+ ** @param pool: worker pool
+ ** @param lateness: destination histogram, overwritten
+ **
+ ** @return none
+******************************************************************************/
+void WRK_getLateness(workerPool_t* pool, histogram_t* lateness)
+{
+    HIST_reset(lateness);
+    
+    pthread_mutex_lock(&pool->lock);
+    for(uint8_t i = 0; i < pool->numWorkers; i++)
+    {
+        HIST_merge(lateness, &pool->workers[i].lateness);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+ /*****************************************************************************
+ ** @brief Attach intersection lateness
+ **     Also record the step change lateness of each intersection in the pool
+ **     in a histogram of its own, whichever worker clocks it. Must not be
+ **     called during a tick.
+ **
+ ** @param pool: worker pool
+ ** @param lateness: caller's histograms, one per intersection in the same
+ **     order, reset here; NULL to stop recording them
+ **
+ ** @return none
+******************************************************************************/
+void WRK_attachLateness(workerPool_t* pool, histogram_t* lateness)
+{
+    pthread_mutex_lock(&pool->lock);
+    for(uint32_t i = 0; i < pool->count; i++)
+    {
+        if(lateness)
+        {
+            HIST_reset(&lateness[i]);
+        }
+        pool->intersections[i].sets.ownLateness = lateness ? &lateness[i] : NULL;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+ /*****************************************************************************
+ ** @brief Close worker pool
+ **     Stop and join the worker threads and free the pool's memory. The
+ **     intersections stop recording step lateness.
+ **
+ ** @param pool: pool to close
+ **
+ ** @return none
+******************************************************************************/
+void WRK_close(workerPool_t* pool)
+{
+    if(!pool || !pool->workers)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->running = false;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(uint8_t i = 0; i < pool->numWorkers; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    //the workers' histograms go with them
+    for(uint32_t i = 0; i < pool->count; i++)
+    {
+        pool->intersections[i].sets.lateness = NULL;
+    }
+    for(uint8_t i = 0; i < pool->numWorkers; i++)
+    {
+        pthread_mutex_destroy(&pool->workers[i].lock);
+        free(pool->workers[i].due);
+    }
+    free(pool->workers);
+    pool->workers = NULL;
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+//************************* Local functions *********************************//
+
+ /*****************************************************************************
+ ** @brief Worker thread
+ **     Wait for each tick, run it and report back until the pool closes
+ **
+ ** @param arg: worker
+ **
+ ** @return NULL
+******************************************************************************/
+STATIC void* workerThread(void* arg)
+{
+    worker_t* worker = arg;
+    workerPool_t* pool = worker->pool;
+    uint64_t generation = 0;
+    uint64_t millis;
+    uint32_t clocked;
+
+    pthread_mutex_lock(&pool->lock);
+    while(1)
+    {
+        while(pool->running && (pool->generation == generation))
+        {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if(!pool->running)
+        {
+            break;
+        }
+        generation = pool->generation;
+        millis = pool->millis;
+        pthread_mutex_unlock(&pool->lock);
+
+        clocked = runTick(worker, millis);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->clocked += clocked;
+        if(!--pool->active)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+ /*****************************************************************************
+ ** @brief Run tick
+ **     Queue the worker's due intersections, then clock its own and other
+ **     workers' due intersections until none are left.
+ **
+ ** @param worker: worker running the tick
+ ** @param millis: current mS since epoch
+ **
+ ** @return number of intersections clocked by this worker
+******************************************************************************/
+STATIC uint32_t runTick(worker_t* worker, uint64_t millis)
+{
+    intersection_t* intersection;
+    worker_t* owner;
+    uint64_t deadline;
+    uint64_t startNs;
+    uint32_t clocked = 0;
+
+    pthread_mutex_lock(&worker->lock);
+    worker->dueHead = 0;
+    worker->dueTail = 0;
+    TW_advance(&worker->wheel, millis, collectDue, worker);
+    pthread_mutex_unlock(&worker->lock);
+
+    startNs = getNanos();
+    while(1)
+    {
+        intersection = takeDue(worker);
+        if(!intersection)
+        {
+            intersection = stealDue(worker);
+            if(!intersection)
+            {
+                break;
+            }
+            worker->stats.steals++;
+        }
+
+        //record into the clocking worker's histogram, which no other thread writes
+        intersection->sets.lateness = &worker->lateness;
+        deadline = FLT_clockDue(intersection, millis);
+
+        //the owner's wheel has already been advanced; deadlines still in the past are retried in the next mS
+        owner = getOwner(worker->pool, intersection);
+        pthread_mutex_lock(&owner->lock);
+        TW_schedule(&owner->wheel, &intersection->timer, deadline);
+        pthread_mutex_unlock(&owner->lock);
+
+        clocked++;
+    }
+    if(clocked)
+    {
+        worker->stats.busyNs += getNanos() - startNs;
+        worker->stats.clocks += clocked;
+    }
+
+    return clocked;
+}
+
+ /*****************************************************************************
+ ** @brief Collect due intersection
+ **     Timing wheel callback queueing an expired intersection. Called with the
+ **     worker's lock held.
+ **
+ ** @param node: timer of the due intersection
+ ** @param millis: mS in which the timer expired
+ ** @param arg: worker that owns the wheel
+ **
+ ** @return none
+******************************************************************************/
+STATIC void collectDue(twNode_t* node, uint64_t millis, void* arg)
+{
+    worker_t* worker = arg;
+
+    (void)millis;
+
+    //every owned intersection is in the wheel at most once, so the queue cannot overflow
+    worker->due[worker->dueTail++] = INT_FROM_TIMER(node);
+}
+
+ /*****************************************************************************
+ ** @brief Take due intersection
+ **     Pop the most recently queued intersection from the worker's own queue
+ **
+ ** @param worker: worker taking the intersection
+ **
+ ** @return due intersection, NULL if the queue is empty
+******************************************************************************/
+STATIC intersection_t* takeDue(worker_t* worker)
+{
+    intersection_t* intersection = NULL;
+
+    pthread_mutex_lock(&worker->lock);
+    if(worker->dueTail > worker->dueHead)
+    {
+        intersection = worker->due[--worker->dueTail];
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    return intersection;
+}
+
+ /*****************************************************************************
+ ** @brief Steal due intersection
+ **     Take the oldest queued intersection from the first other worker that
+ **     has one, starting with the worker's neighbour to spread out thieves.
+ **
+ ** @param worker: worker looking for work
+ **
+ ** @return due intersection, NULL if every queue is empty
+******************************************************************************/
+STATIC intersection_t* stealDue(worker_t* worker)
+{
+    workerPool_t* pool = worker->pool;
+    uint8_t self = (uint8_t)(worker - pool->workers);
+    intersection_t* intersection = NULL;
+    worker_t* victim;
+
+    for(uint8_t i = 1; (i < pool->numWorkers) && !intersection; i++)
+    {
+        victim = &pool->workers[(self + i) % pool->numWorkers];
+
+        pthread_mutex_lock(&victim->lock);
+        if(victim->dueTail > victim->dueHead)
+        {
+            intersection = victim->due[victim->dueHead++];
+        }
+        pthread_mutex_unlock(&victim->lock);
+    }
+
+    return intersection;
+}
+
+ /*****************************************************************************
+ ** @brief Get owner
+ **     Find the worker whose wheel holds an intersection
+ **
+ ** @param pool: worker pool
+ ** @param intersection: intersection in the pool
+ **
+ ** @return owning worker
+******************************************************************************/
+STATIC worker_t* getOwner(workerPool_t* pool, const intersection_t* intersection)
+{
+    return &pool->workers[(uint32_t)(intersection - pool->intersections) % pool->numWorkers];
+}
+
+ /*****************************************************************************
+ ** @brief Get nanoseconds
+ **
+ ** @param none
+ **
+ ** @return nS of monotonic time
+******************************************************************************/
+STATIC uint64_t getNanos(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((uint64_t)time.tv_sec * 1000000000) + (uint64_t)time.tv_nsec;
+}
@@ -0,0 +1,75 @@
+/***************************************************************************************
+ * @file    workerPool.h
+ * @date    October 18th 2026
+ *
+ * @brief   Work-stealing worker pool header
+ *
+ ****************************************************************************************/
+
+#ifndef _WORKERPOOL_H_
+#define _WORKERPOOL_H_
+
+#include <pthread.h>
+
+#include "main.h"
+#include "intersection.h"
+#include "timerWheel.h"
+#include "histogram.h"
+
+#define WRK_MAX_WORKERS         64  //max number of worker threads in a pool
+
+//per-worker counters
+typedef struct wrkstats
+{
+    uint64_t clocks;        //intersections clocked by this worker
+    uint64_t steals;        //intersections clocked on behalf of other workers
+    uint64_t busyNs;        //time spent clocking intersections
+    uint64_t totalNs;       //time since the pool started
+} wrkStats_t;
+
+struct workerpool;
+
+//worker thread and the share of intersections it owns
+typedef struct worker
+{
+    struct workerpool* pool;        //pool the worker belongs to
+    pthread_t thread;
+    pthread_mutex_t lock;           //guards the wheel and the due queue
+    timerWheel_t wheel;             //next light change of the owned intersections
+    intersection_t** due;           //owned intersections due in the current tick
+    uint32_t dueHead;               //next entry taken by thieves
+    uint32_t dueTail;               //one past the next entry taken by the owner
+    wrkStats_t stats;
+    histogram_t lateness;           //step change lateness of the intersections this worker clocked
+} worker_t;
+
+//intersections sharded across worker threads
+typedef struct workerpool
+{
+    intersection_t* intersections;  //array of intersections in the pool
+    uint32_t count;                 //number of intersections in the array
+    uint8_t numWorkers;             //number of worker threads
+    worker_t* workers;              //worker array; intersection i is owned by worker i % numWorkers
+    pthread_mutex_t lock;           //guards the tick hand-off below
+    pthread_cond_t start;           //signalled when a tick starts or the pool closes
+    pthread_cond_t done;            //signalled when the last worker finishes a tick
+    uint64_t generation;            //incremented for every tick
+    uint64_t millis;                //time of the tick in progress
+    uint8_t active;                 //workers still running the current tick
+    uint32_t clocked;               //intersections clocked in the current tick
+    bool running;                   //workers exit when cleared
+    uint64_t startNs;               //time the pool started, for utilization
+} workerPool_t;
+
+//********************* Public function prototypes ****************************//
+
+error_t WRK_init(workerPool_t* pool, intersection_t* intersections, uint32_t count, uint8_t numWorkers, uint64_t now);
+uint32_t WRK_tick(workerPool_t* pool, uint64_t millis);
+error_t WRK_getStats(workerPool_t* pool, uint8_t worker, wrkStats_t* stats);
+void WRK_printStats(workerPool_t* pool);
+void WRK_getLateness(workerPool_t* pool, histogram_t* lateness);
+void WRK_attachLateness(workerPool_t* pool, histogram_t* lateness);
+void WRK_close(workerPool_t* pool);
+
+
+#endif //_WORKERPOOL_H_
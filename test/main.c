@@ -10,6 +10,20 @@
 #include "test_intersection.h"
 #include "test_lightSet.h"
 #include "test_config.h"
+#include "test_configFleet.h"
+#include "test_configCache.h"
+#include "test_eventLoop.h"
+#include "test_timerWheel.h"
+#include "test_fleet.h"
+#include "test_workerPool.h"
+#include "test_simulation.h"
+#include "test_timeline.h"
+#include "test_histogram.h"
+#include "test_arena.h"
+#include "test_image.h"
+#include "test_configReloader.h"
+#include "test_sweep.h"
+#include "test_patternPool.h"
 
 /*****************************************************************************
  ** @brief dummy test
@@ -50,6 +64,20 @@ int main(void)
     result += test_intersection();
     result += test_lightSet();
     result += test_config();
+    result += test_configFleet();
+    result += test_configCache();
+    result += test_eventLoop();
+    result += test_timerWheel();
+    result += test_fleet();
+    result += test_workerPool();
+    result += test_simulation();
+    result += test_timeline();
+    result += test_histogram();
+    result += test_arena();
+    result += test_image();
+    result += test_configReloader();
+    result += test_sweep();
+    result += test_patternPool();
     
     return result;
 }
@@ -0,0 +1,124 @@
+/***************************************************************************************
+ * @file    test_arena.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_main.h"
+#include "test_arena.h"
+#include "arena.h"
+
+//from arena.c
+extern void* (*blockMalloc_ptr)(size_t);  //function ptr for mocking
+
+static arena_t arena;
+
+static void test_ARN_init(void **state);
+static void test_ARN_alloc(void **state);
+static void test_ARN_allocGrow(void **state);
+
+static void* MOCK_blockMalloc(size_t size)
+{
+    (void)size;
+    return NULL;
+}
+
+int test_arena(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_ARN_init),
+        cmocka_unit_test(test_ARN_alloc),
+        cmocka_unit_test(test_ARN_allocGrow),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t ARN_init(arena_t* arena, size_t size)
+static void test_ARN_init(void **state)
+{
+    (void)state;
+    
+    //small arenas get a minimum sized block
+    assert_int_equal(ARN_init(&arena, 10), ERR_success);
+    assert_non_null(arena.head);
+    assert_int_equal(arena.head->size, ARN_MIN_BLOCK);
+    assert_int_equal(arena.blocks, 1);
+    ARN_release(&arena);
+    assert_null(arena.head);
+    
+    assert_int_equal(ARN_init(&arena, 3 * ARN_MIN_BLOCK), ERR_success);
+    assert_int_equal(arena.head->size, 3 * ARN_MIN_BLOCK);
+    ARN_release(&arena);
+    
+    //out of memory
+    blockMalloc_ptr = MOCK_blockMalloc;
+    assert_int_equal(ARN_init(&arena, 10), ERR_mem);
+    assert_null(arena.head);
+    blockMalloc_ptr = malloc;
+}
+
+//void* ARN_alloc(arena_t* arena, size_t size)
+static void test_ARN_alloc(void **state)
+{
+    (void)state;
+    char* first;
+    char* second;
+    
+    assert_int_equal(ARN_init(&arena, ARN_MIN_BLOCK), ERR_success);
+    
+    //allocations are aligned and consecutive
+    first = ARN_alloc(&arena, 1);
+    second = ARN_alloc(&arena, 3);
+    assert_non_null(first);
+    assert_non_null(second);
+    assert_int_equal((uintptr_t)first % ARN_ALIGN, 0);
+    assert_int_equal((uintptr_t)second % ARN_ALIGN, 0);
+    assert_true(second == first + ARN_ALIGN);
+    assert_int_equal(arena.allocated, 2 * ARN_ALIGN);
+    
+    //memory is usable
+    memset(first, 0xAA, ARN_ALIGN);
+    memset(second, 0x55, 3);
+    assert_int_equal((uint8_t)first[ARN_ALIGN - 1], 0xAA);
+    
+    //the whole block can be used before another is added
+    assert_non_null(ARN_alloc(&arena, ARN_MIN_BLOCK - 2 * ARN_ALIGN));
+    assert_int_equal(arena.blocks, 1);
+    
+    ARN_release(&arena);
+}
+
+//void* ARN_alloc(arena_t* arena, size_t size) when the block is full
+static void test_ARN_allocGrow(void **state)
+{
+    (void)state;
+    char* big;
+    
+    assert_int_equal(ARN_init(&arena, ARN_MIN_BLOCK), ERR_success);
+    
+    //full block; the next one is twice as large
+    assert_non_null(ARN_alloc(&arena, ARN_MIN_BLOCK));
+    assert_non_null(ARN_alloc(&arena, 1));
+    assert_int_equal(arena.blocks, 2);
+    assert_int_equal(arena.head->size, 2 * ARN_MIN_BLOCK);
+    
+    //requests larger than a block get a block of their own
+    big = ARN_alloc(&arena, 10 * ARN_MIN_BLOCK);
+    assert_non_null(big);
+    memset(big, 0, 10 * ARN_MIN_BLOCK);
+    assert_int_equal(arena.blocks, 3);
+    assert_int_equal(arena.head->size, 10 * ARN_MIN_BLOCK);
+    
+    //out of memory
+    blockMalloc_ptr = MOCK_blockMalloc;
+    assert_null(ARN_alloc(&arena, 20 * ARN_MIN_BLOCK));
+    blockMalloc_ptr = malloc;
+    
+    ARN_release(&arena);
+    assert_null(arena.head);
+}
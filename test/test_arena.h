@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_arena.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_ARENA_H_
+#define _TEST_ARENA_H_
+
+int test_arena(void);
+
+
+#endif //_TEST_ARENA_H_
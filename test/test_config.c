@@ -5,12 +5,17 @@
  * @brief   
  *
  ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "test_main.h"
 #include "test_config.h"
 //#include "intersection.h"
 #include "config.h"
+#include "configParser.h"
 #include "lightSet.h"
 #include "cJSON/cJSON.h"
 
@@ -26,28 +31,46 @@
 //from intersection.c
 //extern intState_t intState;
 
+//test intersection config
+static intConfig_t config = {.lightSets = UNUSED_CONFIG};
+
 //from config.c
-extern lightSet_t lightConfigs[];
-extern error_t parseConfig(const char* json);
-extern error_t parseDirection(const cJSON* direction);
+extern error_t parseDirection(intConfig_t* config, const cJSON* direction);
 extern error_t parseLights(lightSet_t* lightConfig, const cJSON* lights);
 extern error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps);
+extern cfgKey_t getKeyFromString(const char* key);
 extern intDirection_t getDirectionIdxFromString(char* dir);
 extern lightDisplayType_t getLightTypeFromString(char* type);
 extern lightSetState_t getStepStateFromString(char* state);
 extern void* (*malloc_ptr)(size_t);  //function ptr for mocking
 extern size_t (*fread_ptr)(void*, size_t, size_t, FILE*);  //function ptr for mocking
+extern void* (*mmap_ptr)(void*, size_t, int, int, int, off_t);  //function ptr for mocking
+
+//from arena.c
+extern void* (*blockMalloc_ptr)(size_t);  //function ptr for mocking
+
+//from patternPool.c
+extern void* (*patternAlloc_ptr)(size_t, size_t);  //function ptr for mocking
 
 static size_t rcvdFileSize = 0;
 static size_t rcvdMemSize = 0;
+static uint8_t mmapCalls = 0;
+static uint8_t blockCalls = 0;
 
 static void test_CFG_init(void **state);
 static void test_CFG_loadDefaults(void **state);
 static void test_CFG_getLightSet(void **state);
-static void test_parseConfig(void **state);
+static void test_CFG_load(void **state);
+static void test_CFG_validate(void **state);
+static void test_CFG_apply(void **state);
+static void test_CFG_parse(void **state);
+static void test_CFG_initStream(void **state);
+static void test_streamConfig(void **state);
+static void test_parseConfigTree(void **state);
 static void test_parseDirection(void **state);
 static void test_parseLights(void **state);
 static void test_parseSteps(void **state);
+static void test_getKeyFromString(void **state);
 static void test_getDirectionIdxFromString(void **state);
 static void test_getLightTypeFromString(void **state);
 static void test_getStepStateFromString(void **state);
@@ -59,6 +82,24 @@ static void* MOCK_malloc(size_t size)
     return NULL;
 }
 
+//compare the light sets of two configs field by field; their padding is not copied reliably
+static void assertSameSets(const lightSet_t* a, const lightSet_t* b)
+{
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        assert_memory_equal(&a[dir].lights, &b[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(a[dir].pattern, b[dir].pattern);
+        assert_int_equal(a[dir].currentStep, b[dir].currentStep);
+    }
+}
+
+static void* MOCK_patternAlloc(size_t alignment, size_t size)
+{
+    (void)alignment;
+    (void)size;
+    return NULL;
+}
+
 static size_t MOCK_fread(void* ptr, size_t size, size_t count, FILE* stream)
 {
     (void)ptr;
@@ -68,16 +109,85 @@ static size_t MOCK_fread(void* ptr, size_t size, size_t count, FILE* stream)
     return 0;
 }
 
+static error_t parseWithBoth(const char* json, size_t length)
+{
+    intConfig_t streamed = {.lightSets = UNUSED_CONFIG};
+    intConfig_t tree = {.lightSets = UNUSED_CONFIG};
+    error_t result;
+    
+    //both parsers must agree on the result and, on success, on the config
+    CFG_setParser(CP_tree);
+    result = CFG_parse(&tree, json, length);
+    CFG_setParser(CP_stream);
+    assert_int_equal(CFG_parse(&streamed, json, length), result);
+    
+    if(result == ERR_success)
+    {
+        for(uint8_t set = 0; set < INT_DIRECTIONS; set++)
+        {
+            for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+            {
+                assert_int_equal(streamed.lightSets[set].lights[i].type, tree.lightSets[set].lights[i].type);
+                assert_int_equal(streamed.lightSets[set].lights[i].state, tree.lightSets[set].lights[i].state);
+            }
+            assert_ptr_equal(streamed.lightSets[set].pattern, tree.lightSets[set].pattern);
+        }
+    }
+    
+    return result;
+}
+
+static error_t parseStringWithBoth(const char* json)
+{
+    return parseWithBoth(json, strlen(json));
+}
+
+static void* MOCK_blockMalloc(size_t size)
+{
+    blockCalls++;
+    return malloc(size);
+}
+
+static void* MOCK_blockMallocFail(size_t size)
+{
+    (void)size;
+    return NULL;
+}
+
+static void* MOCK_mmapFail(void* addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    (void)addr;
+    (void)length;
+    (void)prot;
+    (void)flags;
+    (void)fd;
+    (void)offset;
+    return MAP_FAILED;
+}
+
+static void* MOCK_mmap(void* addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    mmapCalls++;
+    return mmap(addr, length, prot, flags, fd, offset);
+}
+
 int test_config(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_CFG_init),
         cmocka_unit_test(test_CFG_loadDefaults),
         cmocka_unit_test(test_CFG_getLightSet),
-        cmocka_unit_test(test_parseConfig),
+        cmocka_unit_test(test_CFG_load),
+        cmocka_unit_test(test_CFG_validate),
+        cmocka_unit_test(test_CFG_apply),
+        cmocka_unit_test(test_CFG_parse),
+        cmocka_unit_test(test_CFG_initStream),
+        cmocka_unit_test(test_streamConfig),
+        cmocka_unit_test(test_parseConfigTree),
         cmocka_unit_test(test_parseDirection),
         cmocka_unit_test(test_parseLights),
         cmocka_unit_test(test_parseSteps),
+        cmocka_unit_test(test_getKeyFromString),
         cmocka_unit_test(test_getDirectionIdxFromString),
         cmocka_unit_test(test_getLightTypeFromString),
         cmocka_unit_test(test_getStepStateFromString),
@@ -88,34 +198,57 @@ int test_config(void)
 
 
  
-//error_t CFG_init(char* filepath)
+//error_t CFG_init(intConfig_t* config, char* filepath)
 static void test_CFG_init(void **state)
 {
     (void)state;
     
-    //invalid file path
-    assert_int_equal(CFG_init(TEST_CFG1_PATH TEST_CFG1_PATH), ERR_file);
+    lightSet_t defaultConfigs[INT_DIRECTIONS] = DEFAULT_CONFIG;
+    
+    //invalid file path loads the defaults
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH TEST_CFG1_PATH), ERR_file);
+    assertSameSets(config.lightSets, defaultConfigs);
+    
+    //no file path is the defaults
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_init(&config, NULL), ERR_success);
+    assertSameSets(config.lightSets, defaultConfigs);
+    assert_int_equal(CFG_load(&config, NULL), ERR_file);
+    
+    //regular files are mapped rather than read
+    mmapCalls = 0;
+    mmap_ptr = MOCK_mmap;
+    malloc_ptr = MOCK_malloc;
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(mmapCalls, 1);
+    malloc_ptr = malloc;
+    
+    //files that cannot be mapped are read into a buffer
+    mmap_ptr = MOCK_mmapFail;
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
     
     //mock malloc failure and confirm correct file size
     malloc_ptr = MOCK_malloc;
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_mem);
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_mem);
     assert_int_equal(rcvdFileSize, TEST_CFG1_SIZE+1);
     malloc_ptr = malloc;
     
     //mock fread failure and confirm correct memory size was allocated
     fread_ptr = MOCK_fread;
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_other);
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_other);
     assert_int_equal(rcvdMemSize, TEST_CFG1_SIZE);
     fread_ptr = fread;
+    mmap_ptr = mmap;
     
     //parse config failure
-    assert_int_equal(CFG_init(TEST_CFG_INV1_PATH), ERR_format); //invalid JSON object (incorrectly spelled "intersection" key)
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV1_PATH), ERR_format); //invalid JSON object (incorrectly spelled "intersection" key)
     
     //successful init
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
 }
 
-//void CFG_loadDefaults(void)
+//void CFG_loadDefaults(intConfig_t* config)
 static void test_CFG_loadDefaults(void **state)
 {
     (void)state;
@@ -123,25 +256,25 @@ static void test_CFG_loadDefaults(void **state)
     lightSet_t defaultConfigs[INT_DIRECTIONS] = DEFAULT_CONFIG;
     
     //test update to default config
-    assert_int_equal(CFG_init(TEST_CFG2_PATH), ERR_success);    
+    assert_int_equal(CFG_init(&config, TEST_CFG2_PATH), ERR_success);    
     //confirm no light or step arrays match
     for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
     {
-        assert_memory_not_equal(&lightConfigs[dir].lights, &defaultConfigs[dir].lights, SIZE_LIGHT_ARRAY);
-        assert_memory_not_equal(&lightConfigs[dir].steps, &defaultConfigs[dir].steps, SIZE_STEP_ARRAY);
+        assert_memory_not_equal(&config.lightSets[dir].lights, &defaultConfigs[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_not_equal(config.lightSets[dir].pattern, defaultConfigs[dir].pattern);
     }
     //load defaults
-    CFG_loadDefaults();
+    CFG_loadDefaults(&config);
     //confirm all light and step arrays match
     for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
     {
-        assert_memory_equal(&lightConfigs[dir].lights, &defaultConfigs[dir].lights, SIZE_LIGHT_ARRAY);
-        assert_memory_equal(&lightConfigs[dir].steps, &defaultConfigs[dir].steps, SIZE_STEP_ARRAY);
+        assert_memory_equal(&config.lightSets[dir].lights, &defaultConfigs[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(config.lightSets[dir].pattern, defaultConfigs[dir].pattern);
     }
     
 }
 
-//lightSet_t* CFG_getLightSet(intDirection_t direction)
+//lightSet_t* CFG_getLightSet(intConfig_t* config, intDirection_t direction)
 static void test_CFG_getLightSet(void **state)
 {
     (void)state;
@@ -149,63 +282,288 @@ static void test_CFG_getLightSet(void **state)
     //valid directions
     for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
     {
-        assert_ptr_equal(CFG_getLightSet(dir), &lightConfigs[dir]);
+        assert_ptr_equal(CFG_getLightSet(&config, dir), &config.lightSets[dir]);
     }
     
     //invalid direction
-    assert_ptr_equal(CFG_getLightSet(ID_numDirections), NULL);
+    assert_ptr_equal(CFG_getLightSet(&config, ID_numDirections), NULL);
+    
+    //invalid config
+    assert_ptr_equal(CFG_getLightSet(NULL, ID_north), NULL);
 }
 
-//error_t parseConfig(const char* json)
-static void test_parseConfig(void **state)
+//error_t CFG_load(intConfig_t* config, const char* filepath)
+static void test_CFG_load(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    lightSet_t defaultConfigs[INT_DIRECTIONS] = DEFAULT_CONFIG;
+    intConfig_t loaded = unusedConfig;
+    
+    //loads like init
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_load(&loaded, TEST_CFG1_PATH), ERR_success);
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        assert_memory_equal(&loaded.lightSets[dir].lights, &config.lightSets[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(loaded.lightSets[dir].pattern, config.lightSets[dir].pattern);
+    }
+    
+    //files being reloaded may be rewritten while parsed, so they are read rather than mapped
+    mmapCalls = 0;
+    mmap_ptr = MOCK_mmap;
+    loaded = unusedConfig;
+    assert_int_equal(CFG_load(&loaded, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(mmapCalls, 0);
+    mmap_ptr = mmap;
+    
+    //failures do not fall back to the defaults
+    loaded = unusedConfig;
+    assert_int_equal(CFG_load(&loaded, TEST_CFG_INV2_PATH), ERR_json);
+    assert_ptr_not_equal(loaded.lightSets[ID_north].pattern, defaultConfigs[ID_north].pattern);
+    assert_int_equal(CFG_load(&loaded, TEST_CFG1_PATH TEST_CFG1_PATH), ERR_file);
+}
+
+//error_t CFG_validate(const intConfig_t* config)
+static void test_CFG_validate(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    const setPattern_t endless = {.offsets = (const uint32_t[]){1000, 2000}, .states = (const uint8_t[]){LSS_LRSG, LSS_LRSR}, .count = 2};
+    intConfig_t checked = unusedConfig;
+    
+    //loaded and default configs are valid
+    assert_int_equal(CFG_load(&checked, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_validate(&checked), ERR_success);
+    checked = unusedConfig;
+    assert_int_equal(CFG_load(&checked, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(CFG_validate(&checked), ERR_success);
+    CFG_loadDefaults(&checked);
+    assert_int_equal(CFG_validate(&checked), ERR_success);
+    
+    //pattern without an end step
+    checked.lightSets[ID_west].pattern = &endless;
+    assert_int_equal(CFG_validate(&checked), ERR_format);
+    
+    //direction pair without a pattern
+    checked.lightSets[ID_west] = unusedConfig.lightSets[ID_west];
+    assert_int_equal(CFG_validate(&checked), ERR_success);
+    checked.lightSets[ID_east] = unusedConfig.lightSets[ID_east];
+    assert_int_equal(CFG_validate(&checked), ERR_value);
+    assert_int_equal(CFG_validate(&unusedConfig), ERR_value);
+}
+
+//void CFG_apply(intConfig_t* config, const intConfig_t* update)
+static void test_CFG_apply(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t update = unusedConfig;
+    
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_load(&update, TEST_CFG3_PATH), ERR_success);
+    config.lightSets[ID_east].currentStep = 2;
+    
+    //lights and patterns are copied
+    CFG_apply(&config, &update);
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        assert_memory_equal(&config.lightSets[dir].lights, &update.lightSets[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(config.lightSets[dir].pattern, update.lightSets[dir].pattern);
+    }
+    
+    //the starting step is not
+    assert_int_equal(config.lightSets[ID_east].currentStep, 2);
+}
+
+//error_t CFG_parse(intConfig_t* config, const char* json, size_t length)
+static void test_CFG_parse(void **state)
 {
     (void)state;
     
     //invalid JSON format
-    assert_int_equal(CFG_init(TEST_CFG_INV2_PATH), ERR_json);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV2_PATH), ERR_json);
     
     //invalid intersection object
-    assert_int_equal(CFG_init(TEST_CFG_INV1_PATH), ERR_format); //invalid JSON object (incorrectly spelled "intersection" key)
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV1_PATH), ERR_format); //invalid JSON object (incorrectly spelled "intersection" key)
     
     //no directions in config
-    assert_int_equal(CFG_init(TEST_CFG_INV5_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV5_PATH), ERR_format);
     
     //one bad direction
-    assert_int_equal(CFG_init(TEST_CFG_INV6_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV6_PATH), ERR_format);
     
     //only one direction per NS/EW
-    assert_int_equal(CFG_init(TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(CFG_init(&config, TEST_CFG3_PATH), ERR_success);
     
     //four valid directions
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+}
+
+//error_t CFG_init(intConfig_t* config, char* filepath) with a pipe
+static void test_CFG_initStream(void **state)
+{
+    (void)state;
+    int fds[2];
+    char path[32];
+    char* json;
+    FILE* file;
+    
+    //read the whole test config
+    json = malloc(TEST_CFG1_SIZE);
+    assert_non_null(json);
+    file = fopen(TEST_CFG1_PATH, "r");
+    assert_non_null(file);
+    assert_int_equal(fread(json, 1, TEST_CFG1_SIZE, file), TEST_CFG1_SIZE);
+    fclose(file);
+    
+    //pipes cannot be mapped and are read until EOF
+    assert_int_equal(pipe(fds), 0);
+    assert_int_equal(write(fds[1], json, TEST_CFG1_SIZE), TEST_CFG1_SIZE);
+    close(fds[1]);
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fds[0]);
+    mmapCalls = 0;
+    mmap_ptr = MOCK_mmap;
+    assert_int_equal(CFG_init(&config, path), ERR_success);
+    assert_int_equal(mmapCalls, 0);
+    mmap_ptr = mmap;
+    close(fds[0]);
+    
+    //buffers are parsed up to their length, without a null terminator
+    json = realloc(json, TEST_CFG1_SIZE + 2);
+    assert_non_null(json);
+    memcpy(&json[TEST_CFG1_SIZE], "}}", 2);
+    assert_int_equal(CFG_parse(&config, json, TEST_CFG1_SIZE), ERR_success);
+    assert_int_equal(CFG_parse(&config, json, TEST_CFG1_SIZE - 2), ERR_json);
+    
+    free(json);
+}
+
+//error_t streamConfig(intConfig_t* config, const char* json, size_t length)
+static void test_streamConfig(void **state)
+{
+    (void)state;
+    const char* paths[] = {TEST_CFG1_PATH, TEST_CFG2_PATH, TEST_CFG3_PATH,
+                           TEST_CFG_INV1_PATH, TEST_CFG_INV2_PATH, TEST_CFG_INV3_PATH, TEST_CFG_INV4_PATH,
+                           TEST_CFG_INV5_PATH, TEST_CFG_INV6_PATH, TEST_CFG_INV7_PATH, TEST_CFG_INV8_PATH,
+                           TEST_CFG_INV9_PATH, TEST_CFG_INV10_PATH, TEST_CFG_INV11_PATH, TEST_CFG_INV12_PATH,
+                           TEST_CFG_INV13_PATH, TEST_CFG_INV14_PATH};
+    char json[4096];
+    char* nested;
+    size_t length;
+    FILE* file;
+    
+    //every test config gives the same result with both parsers
+    for(uint8_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+    {
+        file = fopen(paths[i], "r");
+        assert_non_null(file);
+        length = fread(json, 1, sizeof(json), file);
+        fclose(file);
+        assert_true(length < sizeof(json));
+        parseWithBoth(json, length);
+    }
+    
+    //keys in any order, unknown keys ignored
+    assert_int_equal(parseStringWithBoth("{\"version\":[1,{\"a\":null,\"b\":false}],\"INTERSECTION\":[{\"steps\":[{\"time\":0,\"state\":\"LUSG\"},{\"state\":\"end\",\"time\":4e3}],\"lights\":[\"<\",\"o\"],\"id\":true,\"direction\":\"east\"}]}"), ERR_success);
+    
+    //escapes, byte order mark and long strings
+    assert_int_equal(parseStringWithBoth("\xEF\xBB\xBF{\"intersection\":[{\"direction\":\"nor\\u0074h\",\"note\":\"\\ud83d\\ude00\\n\",\"lights\":[\"\\u003c\",\"oooooooooooooooooooooooooooooooooooooooo\"],\"steps\":[{\"state\":\"LUSG\",\"time\":0},{\"state\":\"end\",\"time\":1e12}]}]}"), ERR_success);
+    
+    //duplicate keys are rejected at every level, whatever their case
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"west\",\"direction\":\"up\",\"lights\":[\"o\"],\"steps\":[{\"state\":\"LRSR\",\"time\":0},{\"state\":\"end\",\"time\":-5}]}]}"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[],\"Intersection\":[]}"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"west\",\"lights\":[\"o\"],\"LIGHTS\":[\"o\"],\"steps\":[{\"state\":\"end\",\"time\":0}]}]}"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"west\",\"lights\":[\"o\"],\"steps\":[{\"state\":\"LRSR\",\"time\":0,\"time\":1},{\"state\":\"end\",\"time\":-5}]}]}"), ERR_format);
+    
+    //keys of other levels are unknown where they do not belong
+    assert_int_equal(parseStringWithBoth("{\"direction\":\"west\",\"intersection\":[{\"direction\":\"west\",\"time\":1,\"lights\":[\"o\"],\"steps\":[{\"state\":\"end\",\"steps\":[],\"time\":0}]}]}"), ERR_success);
+    
+    //empty intersection
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[]}"), ERR_success);
+    
+    //format errors
+    assert_int_equal(parseStringWithBoth("[1,2]"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":{}}"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"north\",\"lights\":[\"o\"]}]}"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"north\",\"lights\":[\"o\"],\"steps\":[{\"state\":\"LRSR\"}]}]}"), ERR_format);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[\"north\"]}"), ERR_format);
+    
+    //syntax errors take precedence over format errors
+    assert_int_equal(parseStringWithBoth(""), ERR_json);
+    assert_int_equal(parseStringWithBoth("   "), ERR_json);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[}"), ERR_json);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"up\"}],}"), ERR_json);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"\\ud800x\"}]}"), ERR_json);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"\\q\"}]}"), ERR_json);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":nul}]}"), ERR_json);
+    assert_int_equal(parseStringWithBoth("{\"intersection\":[{\"direction\":\"north"), ERR_json);
+    
+    //nesting limit
+    nested = malloc(CJSON_NESTING_LIMIT + 2);
+    assert_non_null(nested);
+    memset(nested, '[', CJSON_NESTING_LIMIT + 1);
+    assert_int_equal(parseWithBoth(nested, CJSON_NESTING_LIMIT + 1), ERR_json);
+    free(nested);
+}
+
+//error_t parseConfigTree(intConfig_t* config, const char* json, size_t length)
+static void test_parseConfigTree(void **state)
+{
+    (void)state;
+    cJSON* item;
+    
+    CFG_setParser(CP_tree);
+    
+    //the whole tree fits in the arena sized from the file
+    blockCalls = 0;
+    blockMalloc_ptr = MOCK_blockMalloc;
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 1);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV2_PATH), ERR_json);
+    assert_int_equal(blockCalls, 2);
+    blockMalloc_ptr = malloc;
+    
+    //arena allocation failure
+    blockMalloc_ptr = MOCK_blockMallocFail;
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_mem);
+    blockMalloc_ptr = malloc;
+    
+    //cJSON uses the heap outside of a config parse
+    item = cJSON_CreateString("north");
+    assert_non_null(item);
+    assert_string_equal(item->valuestring, "north");
+    cJSON_Delete(item);
+    
+    CFG_setParser(CP_stream);
 }
 
-//error_t parseDirection(const cJSON* direction)
+//error_t parseDirection(intConfig_t* config, const cJSON* direction)
 static void test_parseDirection(void **state)
 {
     (void)state;
     
     //direction not a string (does not exist)
-    assert_int_equal(CFG_init(TEST_CFG_INV5_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV5_PATH), ERR_format);
     
     //invalid direction string
-    assert_int_equal(CFG_init(TEST_CFG_INV6_PATH), ERR_format); //spelled wring
-    assert_int_equal(CFG_init(TEST_CFG_INV3_PATH), ERR_format); //number
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV6_PATH), ERR_format); //spelled wring
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV3_PATH), ERR_format); //number
     
     //invalid lights array
-    assert_int_equal(CFG_init(TEST_CFG_INV4_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV4_PATH), ERR_format);
     
     //failed to parse lights
-    assert_int_equal(CFG_init(TEST_CFG_INV7_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV7_PATH), ERR_format);
     
     //invalid steps array
-    assert_int_equal(CFG_init(TEST_CFG_INV8_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV8_PATH), ERR_format);
     
     //failed to parse steps
-    assert_int_equal(CFG_init(TEST_CFG_INV9_PATH), ERR_format);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV9_PATH), ERR_format);
     
     //success
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
 }
 
 //error_t parseLights(lightSet_t* lightConfig, const cJSON* lights)
@@ -214,41 +572,97 @@ static void test_parseLights(void **state)
     (void)state;
     
     //too many lights
-    assert_int_equal(CFG_init(TEST_CFG_INV10_PATH), ERR_format);    //6 lights
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV10_PATH), ERR_format);    //6 lights
     
     //invalid light string
-    assert_int_equal(CFG_init(TEST_CFG_INV7_PATH), ERR_format); //second light is 2 instead of "<" or "o"
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV7_PATH), ERR_format); //second light is 2 instead of "<" or "o"
     
     //valid light arrays
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success); //2, 3, 4, and 5 lights
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success); //2, 3, 4, and 5 lights
 }
 
 //error_t parseSteps(lightSet_t* lightConfig, const cJSON* steps)
 static void test_parseSteps(void **state)
 {
     (void)state;
+    char json[4096];
+    size_t length;
     
     //too many steps
-    assert_int_equal(CFG_init(TEST_CFG_INV11_PATH), ERR_format);    //11 steps
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV11_PATH), ERR_format);    //MAX_STEPS_IN_PATTERN + 1 steps
     
     //invalid step state string
-    assert_int_equal(CFG_init(TEST_CFG_INV12_PATH), ERR_format);    //"State1" instead of "State" or "state"
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV12_PATH), ERR_format);    //"State1" instead of "State" or "state"
     
     //invalid step state value type
-    assert_int_equal(CFG_init(TEST_CFG_INV9_PATH), ERR_format);     //2 instead of "LxSx", "end", or "disable"
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV9_PATH), ERR_format);     //2 instead of "LxSx", "end", or "disable"
     
     //invalid step state string
-    assert_int_equal(CFG_init(TEST_CFG_INV14_PATH), ERR_format);     //"badString"
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV14_PATH), ERR_format);     //"badString"
     
     //invalid time value
-    assert_int_equal(CFG_init(TEST_CFG_INV13_PATH), ERR_format);    //"0" instead of 0
-    
-    //correct time value parsing
-    assert_int_equal(CFG_init(TEST_CFG3_PATH), ERR_success);
-    assert_int_equal(lightConfigs[ID_north].steps[0].expirationOffset, 2000);
-    assert_int_equal(lightConfigs[ID_north].steps[1].expirationOffset, 3000);
-    assert_int_equal(lightConfigs[ID_north].steps[2].expirationOffset, 4000);
-    assert_int_equal(lightConfigs[ID_north].steps[3].expirationOffset, (uint64_t)-1);
+    assert_int_equal(CFG_init(&config, TEST_CFG_INV13_PATH), ERR_format);    //"0" instead of 0
+    
+    //correct time value parsing, into a pattern of exactly the given steps
+    assert_int_equal(CFG_init(&config, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(config.lightSets[ID_north].pattern->count, 4);
+    assert_int_equal(SET_getOffset(config.lightSets[ID_north].pattern, 0), 2000);
+    assert_int_equal(SET_getOffset(config.lightSets[ID_north].pattern, 1), 3000);
+    assert_int_equal(SET_getOffset(config.lightSets[ID_north].pattern, 2), 4000);
+    assert_int_equal(SET_getOffset(config.lightSets[ID_north].pattern, 3), (uint64_t)-1);
+    
+    //patterns longer than the old fixed arrays, up to the limit
+    for(uint8_t count = 11; count <= MAX_STEPS_IN_PATTERN; count += MAX_STEPS_IN_PATTERN - 11)
+    {
+        length = (size_t)snprintf(json, sizeof(json), "{\"intersection\":[{\"direction\":\"east\",\"lights\":[\"o\"],\"steps\":[");
+        for(uint8_t i = 0; i < count; i++)
+        {
+            length += (size_t)snprintf(&json[length], sizeof(json) - length, "%s{\"state\":\"%s\",\"time\":%u}",
+                                       i ? "," : "", (i == count - 1) ? "end" : "LRSR", i * 100u);
+        }
+        length += (size_t)snprintf(&json[length], sizeof(json) - length, "]}]}");
+        assert_true(length < sizeof(json));
+        assert_int_equal(parseWithBoth(json, length), ERR_success);
+        assert_int_equal(CFG_parse(&config, json, length), ERR_success);
+        assert_int_equal(config.lightSets[ID_east].pattern->count, count);
+        assert_int_equal(SET_getOffset(config.lightSets[ID_east].pattern, count - 2), (count - 1) * 100u);
+        assert_int_equal(SET_getStepState(config.lightSets[ID_east].pattern, count - 1), LSS_end);
+    }
+    
+    //failure to intern a pattern not already in the pool
+    length = (size_t)snprintf(json, sizeof(json), "{\"intersection\":[{\"direction\":\"east\",\"lights\":[\"o\"],"
+                              "\"steps\":[{\"state\":\"LRSR\",\"time\":0},{\"state\":\"end\",\"time\":123457}]}]}");
+    patternAlloc_ptr = MOCK_patternAlloc;
+    CFG_setParser(CP_tree);
+    assert_int_equal(CFG_parse(&config, json, length), ERR_mem);
+    CFG_setParser(CP_stream);
+    assert_int_equal(CFG_parse(&config, json, length), ERR_mem);
+    patternAlloc_ptr = aligned_alloc;
+}
+
+//cfgKey_t getKeyFromString(const char* key)
+static void test_getKeyFromString(void **state)
+{
+    (void)state;
+    
+    //successes
+    assert_int_equal(getKeyFromString("intersection"), CK_intersection);
+    assert_int_equal(getKeyFromString("INTERSECTION"), CK_intersection);
+    assert_int_equal(getKeyFromString("direction"), CK_direction);
+    assert_int_equal(getKeyFromString("Lights"), CK_lights);
+    assert_int_equal(getKeyFromString("steps"), CK_steps);
+    assert_int_equal(getKeyFromString("STATE"), CK_state);
+    assert_int_equal(getKeyFromString("time"), CK_time);
+    assert_int_equal(getKeyFromString("nAmE"), CK_name);
+    
+    //fails
+    assert_int_equal(getKeyFromString(""), CK_unknown);
+    assert_int_equal(getKeyFromString("stats"), CK_unknown);
+    assert_int_equal(getKeyFromString("stepe"), CK_unknown);
+    assert_int_equal(getKeyFromString("tame"), CK_unknown);
+    assert_int_equal(getKeyFromString("lights "), CK_unknown);
+    assert_int_equal(getKeyFromString("intersections"), CK_unknown);
+    assert_int_equal(getKeyFromString("version"), CK_unknown);
 }
 
 //intDirection_t getDirectionIdxFromString(char* dir)
@@ -271,6 +685,11 @@ static void test_getDirectionIdxFromString(void **state)
     assert_int_equal(getDirectionIdxFromString("north "), ID_numDirections);
     assert_int_equal(getDirectionIdxFromString(" east"), ID_numDirections);
     assert_int_equal(getDirectionIdxFromString("0"), ID_numDirections);
+    assert_int_equal(getDirectionIdxFromString(""), ID_numDirections);
+    assert_int_equal(getDirectionIdxFromString("nort"), ID_numDirections);
+    assert_int_equal(getDirectionIdxFromString("nEst"), ID_numDirections);
+    assert_int_equal(getDirectionIdxFromString("southh"), ID_numDirections);
+    assert_int_equal(getDirectionIdxFromString("Weak"), ID_numDirections);
 }
 
 //lightDisplayType_t getLightTypeFromString(char* type)
@@ -318,5 +737,16 @@ static void test_getStepStateFromString(void **state)
     assert_int_equal(getStepStateFromString("0"), LSS_unused);
     assert_int_equal(getStepStateFromString("END "), LSS_unused);
     assert_int_equal(getStepStateFromString(" END"), LSS_unused);
+    assert_int_equal(getStepStateFromString(""), LSS_unused);
+    assert_int_equal(getStepStateFromString("LPS"), LSS_unused);
+    assert_int_equal(getStepStateFromString("LPSGG"), LSS_unused);
+    assert_int_equal(getStepStateFromString("LGSG"), LSS_unused);
+    assert_int_equal(getStepStateFromString("LPSP"), LSS_unused);
+    assert_int_equal(getStepStateFromString("RPSG"), LSS_unused);
+    assert_int_equal(getStepStateFromString("LPRG"), LSS_unused);
+    assert_int_equal(getStepStateFromString("ebd"), LSS_unused);
+    assert_int_equal(getStepStateFromString("disablE"), LSS_disable);
+    assert_int_equal(getStepStateFromString("disables"), LSS_unused);
+    assert_int_equal(getStepStateFromString("lUsY"), LSS_LUSY);
 }
 
@@ -0,0 +1,166 @@
+/***************************************************************************************
+ * @file    test_configCache.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "test_main.h"
+#include "test_configCache.h"
+#include "config.h"
+#include "configCache.h"
+#include "image.h"
+#include "lightSet.h"
+
+#define TEST_CACHE_DIR          "bin/test_cache"
+
+//from arena.c
+extern void* (*blockMalloc_ptr)(size_t);  //function ptr for mocking
+
+static uint8_t blockCalls = 0;
+
+static void test_CFG_setCacheDir(void **state);
+
+static void* MOCK_blockMalloc(size_t size)
+{
+    blockCalls++;
+    return malloc(size);
+}
+
+//compare the light sets of two configs field by field; their padding is not copied reliably
+static void assertSameSets(const lightSet_t* a, const lightSet_t* b)
+{
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        assert_memory_equal(&a[dir].lights, &b[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(a[dir].pattern, b[dir].pattern);
+        assert_int_equal(a[dir].currentStep, b[dir].currentStep);
+    }
+}
+
+int test_configCache(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_CFG_setCacheDir),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+
+//void CFG_setCacheDir(const char* directory)
+static void test_CFG_setCacheDir(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t expected = unusedConfig;
+    intConfig_t cached = unusedConfig;
+    intConfig_t uncached;
+    intConfig_t base;
+    char json[4096];
+    char path[256];
+    uint8_t entry[512];
+    size_t length;
+    size_t entryLength;
+    uint32_t count;
+    FILE* file;
+    
+    file = fopen(TEST_CFG1_PATH, "r");
+    assert_non_null(file);
+    length = fread(json, 1, sizeof(json), file);
+    fclose(file);
+    snprintf(path, sizeof(path), TEST_CACHE_DIR "/%016" PRIx64 "-%zx.img", IMG_hash(json, length), length);
+    remove(path);
+    assert_int_equal(CFG_load(&expected, TEST_CFG1_PATH), ERR_success);
+    
+    //miss parses and stores the entry
+    CFG_setCacheDir(TEST_CACHE_DIR);
+    CFG_setParser(CP_tree);
+    blockMalloc_ptr = MOCK_blockMalloc;
+    blockCalls = 0;
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 1);
+    assertSameSets(cached.lightSets, expected.lightSets);
+    file = fopen(path, "rb");
+    assert_non_null(file);
+    fclose(file);
+    
+    //hit does not parse, even over a config that held something else
+    blockCalls = 0;
+    CFG_loadDefaults(&cached);
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 0);
+    assertSameSets(cached.lightSets, expected.lightSets);
+    
+    //loading without the cache over a config with more lights agrees with a hit and a miss
+    CFG_loadDefaults(&base);
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            base.lightSets[dir].lights[i].type = LDT_solid;
+        }
+    }
+    cached = base;
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    CFG_setCacheDir(NULL);
+    uncached = base;
+    assert_int_equal(CFG_init(&uncached, TEST_CFG1_PATH), ERR_success);
+    assertSameSets(uncached.lightSets, cached.lightSets);
+    assertSameSets(uncached.lightSets, expected.lightSets);
+    CFG_setCacheDir(TEST_CACHE_DIR);
+    remove(path);
+    blockCalls = 0;
+    cached = base;
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 1);
+    assertSameSets(uncached.lightSets, cached.lightSets);
+    blockCalls = 0;
+    
+    //corrupt entry is detected and rebuilt
+    file = fopen(path, "r+b");
+    assert_non_null(file);
+    fseek(file, -1, SEEK_END);
+    fputc(0x55, file);
+    fclose(file);
+    cached = unusedConfig;
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 1);
+    assertSameSets(cached.lightSets, expected.lightSets);
+    file = fopen(path, "rb");
+    assert_non_null(file);
+    entryLength = fread(entry, 1, sizeof(entry), file);
+    fclose(file);
+    assert_int_equal(IMG_check(entry, entryLength, &count), ERR_success);
+    assert_int_equal(count, 1);
+    
+    //truncated entry is rebuilt
+    file = fopen(path, "wb");
+    assert_non_null(file);
+    fwrite(entry, 1, sizeof(imgHeader_t), file);
+    fclose(file);
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 2);
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(blockCalls, 2);
+    
+    //invalid configs are not cached
+    assert_int_equal(CFG_init(&cached, TEST_CFG_INV2_PATH), ERR_json);
+    blockMalloc_ptr = malloc;
+    CFG_setParser(CP_stream);
+    
+    //unwritable cache directory still loads
+    CFG_setCacheDir("bin/missing/cache");
+    cached = unusedConfig;
+    assert_int_equal(CFG_init(&cached, TEST_CFG1_PATH), ERR_success);
+    assertSameSets(cached.lightSets, expected.lightSets);
+    
+    //only the valid config has an entry
+    CFG_setCacheDir(NULL);
+    assert_int_equal(remove(path), 0);
+    assert_int_equal(remove(TEST_CACHE_DIR), 0);
+}
@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_configCache.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_CONFIGCACHE_H_
+#define _TEST_CONFIGCACHE_H_
+
+int test_configCache(void);
+
+
+#endif //_TEST_CONFIGCACHE_H_
@@ -0,0 +1,185 @@
+/***************************************************************************************
+ * @file    test_configFleet.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_main.h"
+#include "test_configFleet.h"
+#include "config.h"
+#include "configFleet.h"
+#include "lightSet.h"
+
+#define TEST_FLEET_PATH         "bin/test_fleet.json"
+#define TEST_FLEET_SIZE         5000    //enough intersections for every thread to take several batches
+
+//from configFleet.c
+extern error_t splitFleet(const char* json, size_t length, cfgSpan_t** spans, uint32_t* count);
+extern void* (*fleetMalloc_ptr)(size_t);  //function ptr for mocking
+
+static void test_CFG_loadFleet(void **state);
+static void test_splitFleet(void **state);
+
+static void* MOCK_malloc(size_t size)
+{
+    (void)size;
+    return NULL;
+}
+
+//compare the light sets of two configs field by field; their padding is not copied reliably
+static void assertSameSets(const lightSet_t* a, const lightSet_t* b)
+{
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        assert_memory_equal(&a[dir].lights, &b[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(a[dir].pattern, b[dir].pattern);
+        assert_int_equal(a[dir].currentStep, b[dir].currentStep);
+    }
+}
+
+int test_configFleet(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_CFG_loadFleet),
+        cmocka_unit_test(test_splitFleet),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+
+//error_t CFG_loadFleet(cfgFleet_t* fleet, const char* filepath, uint8_t threads)
+static void test_CFG_loadFleet(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    const char* paths[TEST_CFG_FLEET_COUNT] = {TEST_CFG1_PATH, TEST_CFG3_PATH, TEST_CFG2_PATH};
+    const char* names[TEST_CFG_FLEET_COUNT] = {"Main & 1st", "Elm \"North\"", ""};
+    intConfig_t expected[TEST_CFG_FLEET_COUNT];
+    cfgFleet_t fleet;
+    cfgFleet_t serial;
+    FILE* file;
+    
+    //each intersection matches its single intersection config
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_CFG_FLEET_PATH, 0), ERR_success);
+    assert_int_equal(fleet.count, TEST_CFG_FLEET_COUNT);
+    for(uint8_t i = 0; i < TEST_CFG_FLEET_COUNT; i++)
+    {
+        expected[i] = unusedConfig;
+        assert_int_equal(CFG_load(&expected[i], paths[i]), ERR_success);
+        assertSameSets(fleet.configs[i].lightSets, expected[i].lightSets);
+        assert_string_equal(fleet.names[i], names[i]);
+    }
+    CFG_freeFleet(&fleet);
+    assert_null(fleet.configs);
+    
+    //large fleets give the same result on one thread as on many
+    file = fopen(TEST_FLEET_PATH, "w");
+    assert_non_null(file);
+    fputc('[', file);
+    for(uint32_t i = 0; i < TEST_FLEET_SIZE; i++)
+    {
+        fprintf(file, "%s{\"name\":\"int-%u\",\"intersection\":[{\"direction\":\"%s\",\"lights\":[\"o\"],\"steps\":[{\"state\":\"LRSR\",\"time\":%u},{\"state\":\"end\",\"time\":%u}]}]}\n",
+                i ? "," : "", i, (i % 2) ? "east" : "north", i, i + 1000);
+    }
+    fputc(']', file);
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 8), ERR_success);
+    assert_int_equal(CFG_loadFleet(&serial, TEST_FLEET_PATH, 1), ERR_success);
+    assert_int_equal(fleet.count, TEST_FLEET_SIZE);
+    assert_int_equal(serial.count, TEST_FLEET_SIZE);
+    assert_memory_equal(fleet.configs, serial.configs, TEST_FLEET_SIZE * sizeof(intConfig_t));
+    assert_memory_equal(fleet.names, serial.names, TEST_FLEET_SIZE * sizeof(*fleet.names));
+    assert_string_equal(fleet.names[TEST_FLEET_SIZE - 1], "int-4999");
+    assert_int_equal(SET_getOffset(fleet.configs[TEST_FLEET_SIZE - 1].lightSets[ID_east].pattern, 0), TEST_FLEET_SIZE - 1 + 1000);
+    assert_ptr_equal(fleet.configs[TEST_FLEET_SIZE - 1].lightSets[ID_north].pattern, &SET_unusedPattern);
+    CFG_freeFleet(&fleet);
+    CFG_freeFleet(&serial);
+    
+    //nothing is loaded when any intersection fails
+    file = fopen(TEST_FLEET_PATH, "w");
+    assert_non_null(file);
+    fprintf(file, "[{\"intersection\":[]},{\"name\":\"bad\",\"intersection\":[{\"direction\":\"up\"}]},{\"intersection\":[]}]");
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 2), ERR_format);
+    assert_null(fleet.configs);
+    assert_null(fleet.names);
+    assert_int_equal(fleet.count, 0);
+    
+    //intersections must be objects with a string name
+    file = fopen(TEST_FLEET_PATH, "w");
+    assert_non_null(file);
+    fprintf(file, "[{\"intersection\":[]}, 5]");
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 1), ERR_format);
+    file = fopen(TEST_FLEET_PATH, "w");
+    assert_non_null(file);
+    fprintf(file, "[{\"name\":5,\"intersection\":[]}]");
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 1), ERR_format);
+    
+    //missing comma between intersections
+    file = fopen(TEST_FLEET_PATH, "w");
+    assert_non_null(file);
+    fprintf(file, "[{\"intersection\":[]} {\"intersection\":[]}]");
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 1), ERR_json);
+    
+    //empty fleet
+    file = fopen(TEST_FLEET_PATH, "w");
+    assert_non_null(file);
+    fprintf(file, " [ ] ");
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 1), ERR_value);
+    remove(TEST_FLEET_PATH);
+    
+    //single intersection configs and missing files
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_CFG1_PATH, 1), ERR_format);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_FLEET_PATH, 1), ERR_file);
+    
+    //out of memory
+    fleetMalloc_ptr = MOCK_malloc;
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_CFG_FLEET_PATH, 1), ERR_mem);
+    fleetMalloc_ptr = malloc;
+}
+
+//error_t splitFleet(const char* json, size_t length, cfgSpan_t** spans, uint32_t* count)
+static void test_splitFleet(void **state)
+{
+    (void)state;
+    const char* json = "\xEF\xBB\xBF [ {\"a\":\"]},[\\\"\"} ,\n[1,[2]],\"x\" ,{}\t]\n";
+    cfgSpan_t* spans;
+    uint32_t count;
+    
+    //brackets and escaped quotes in strings are not boundaries
+    assert_int_equal(splitFleet(json, strlen(json), &spans, &count), ERR_success);
+    assert_int_equal(count, 4);
+    assert_memory_equal(json + spans[0].start, "{\"a\":\"]},[\\\"\"}", spans[0].length);
+    assert_memory_equal(json + spans[1].start, "[1,[2]]", spans[1].length);
+    assert_memory_equal(json + spans[2].start, "\"x\"", spans[2].length);
+    assert_memory_equal(json + spans[3].start, "{}", spans[3].length);
+    assert_int_equal(spans[3].length, 2);
+    free(spans);
+    
+    //empty array
+    assert_int_equal(splitFleet("[]", 2, &spans, &count), ERR_success);
+    assert_int_equal(count, 0);
+    free(spans);
+    
+    //not an array
+    assert_int_equal(splitFleet("{\"intersection\":[]}", 19, &spans, &count), ERR_format);
+    assert_int_equal(splitFleet("   ", 3, &spans, &count), ERR_format);
+    
+    //malformed arrays
+    assert_int_equal(splitFleet("[{},]", 5, &spans, &count), ERR_json);
+    assert_int_equal(splitFleet("[,{}]", 5, &spans, &count), ERR_json);
+    assert_int_equal(splitFleet("[{}}]", 5, &spans, &count), ERR_json);
+    assert_int_equal(splitFleet("[{}", 3, &spans, &count), ERR_json);
+    assert_int_equal(splitFleet("[{}] {}", 7, &spans, &count), ERR_json);
+    assert_int_equal(splitFleet("[\"]", 3, &spans, &count), ERR_json);
+    assert_null(spans);
+}
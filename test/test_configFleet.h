@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_configFleet.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_CONFIGFLEET_H_
+#define _TEST_CONFIGFLEET_H_
+
+int test_configFleet(void);
+
+
+#endif //_TEST_CONFIGFLEET_H_
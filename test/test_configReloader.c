@@ -0,0 +1,230 @@
+/***************************************************************************************
+ * @file    test_configReloader.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "test_main.h"
+#include "test_configReloader.h"
+#include "configReloader.h"
+#include "config.h"
+
+#define TEST_RLD_PATH           "bin/test_reload.json"
+#define TEST_RLD_TMP_PATH       "bin/test_reload.json.tmp"
+#define TEST_RLD_WAIT_MS        2000    //longest wait for the thread to see a change
+
+//from configReloader.c
+extern void* (*reloadMalloc_ptr)(size_t);  //function ptr for mocking
+
+static void test_RLD_start(void **state);
+static void test_RLD_reload(void **state);
+static void test_reloaderThread(void **state);
+
+static volatile sig_atomic_t signalsHandled;
+
+static void countSignal(int signum)
+{
+    (void)signum;
+    signalsHandled++;
+}
+
+static void* MOCK_reloadMalloc(size_t size)
+{
+    (void)size;
+    return NULL;
+}
+
+static void copyFile(const char* from, const char* to)
+{
+    char buffer[4096];
+    FILE* source = fopen(from, "r");
+    FILE* destination = fopen(to, "w");
+    size_t length;
+    
+    assert_non_null(source);
+    assert_non_null(destination);
+    while((length = fread(buffer, 1, sizeof(buffer), source)) > 0)
+    {
+        assert_int_equal(fwrite(buffer, 1, length, destination), length);
+    }
+    fclose(source);
+    fclose(destination);
+}
+
+//wait for the thread to publish or reject a change, returning the published config
+static intConfig_t* waitForChange(reloader_t* reloader, uint32_t rejected)
+{
+    const struct timespec delay = {.tv_sec = 0, .tv_nsec = 1000000};
+    intConfig_t* update = NULL;
+    
+    for(uint32_t waited = 0; (waited < TEST_RLD_WAIT_MS) && !update && (atomic_load(&reloader->rejected) == rejected); waited++)
+    {
+        nanosleep(&delay, NULL);
+        update = RLD_take(reloader);
+    }
+    
+    return update;
+}
+
+int test_configReloader(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_RLD_start),
+        cmocka_unit_test(test_RLD_reload),
+        cmocka_unit_test(test_reloaderThread),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t RLD_start(reloader_t* reloader, const char* filepath)
+static void test_RLD_start(void **state)
+{
+    (void)state;
+    reloader_t reloader;
+    const struct timespec noWait = {0};
+    const struct timespec settle = {.tv_sec = 0, .tv_nsec = 10000000};    //time for another thread to take a signal
+    sigset_t signals;
+    sigset_t callerMask;
+    sigset_t restoredMask;
+    sigset_t pending;
+    void (*oldHandler)(int);
+    
+    //missing directory
+    assert_int_equal(RLD_start(&reloader, "bin/missing/config.json"), ERR_file);
+    assert_null(reloader.filepath);
+    
+    //path is split into the watched directory and file name
+    assert_int_equal(RLD_start(&reloader, TEST_RLD_PATH), ERR_success);
+    assert_string_equal(reloader.directory, "bin");
+    assert_string_equal(reloader.filename, "test_reload.json");
+    assert_null(RLD_take(&reloader));
+    RLD_stop(&reloader);
+    assert_null(reloader.filepath);
+    
+    //the caller's mask is left as it was
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    signalsHandled = 0;
+    oldHandler = signal(SIGUSR1, countSignal);
+    pthread_sigmask(SIG_UNBLOCK, &signals, &callerMask);
+    assert_int_equal(RLD_start(&reloader, TEST_RLD_PATH), ERR_success);
+    pthread_sigmask(SIG_BLOCK, NULL, &restoredMask);
+    assert_false(sigismember(&restoredMask, SIGUSR1));
+    
+    //signals the caller blocks later, as an event loop does, stay pending
+    //for it rather than being taken by the thread
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    kill(getpid(), SIGUSR1);
+    nanosleep(&settle, NULL);
+    sigpending(&pending);
+    assert_true(sigismember(&pending, SIGUSR1));
+    assert_int_equal(sigtimedwait(&signals, NULL, &noWait), SIGUSR1);
+    assert_int_equal(signalsHandled, 0);
+    RLD_stop(&reloader);
+    pthread_sigmask(SIG_SETMASK, &callerMask, NULL);
+    signal(SIGUSR1, oldHandler);
+    
+    //files in the working directory
+    assert_int_equal(RLD_start(&reloader, "config.json"), ERR_success);
+    assert_string_equal(reloader.directory, ".");
+    assert_string_equal(reloader.filename, "config.json");
+    RLD_stop(&reloader);
+}
+
+//error_t RLD_reload(reloader_t* reloader)
+static void test_RLD_reload(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t expected = unusedConfig;
+    reloader_t reloader;
+    intConfig_t* update;
+    
+    //fixtures are never written, so the thread stays idle
+    assert_int_equal(RLD_start(&reloader, TEST_CFG1_PATH), ERR_success);
+    
+    //valid config is published once
+    assert_int_equal(RLD_reload(&reloader), ERR_success);
+    update = RLD_take(&reloader);
+    assert_non_null(update);
+    assert_null(RLD_take(&reloader));
+    assert_int_equal(CFG_load(&expected, TEST_CFG1_PATH), ERR_success);
+    for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        assert_memory_equal(&update->lightSets[dir].lights, &expected.lightSets[dir].lights, SIZE_LIGHT_ARRAY);
+        assert_ptr_equal(update->lightSets[dir].pattern, expected.lightSets[dir].pattern);
+    }
+    free(update);
+    
+    //an untaken config is replaced by the next one
+    assert_int_equal(RLD_reload(&reloader), ERR_success);
+    assert_int_equal(RLD_reload(&reloader), ERR_success);
+    assert_int_equal(atomic_load(&reloader.reloads), 3);
+    update = RLD_take(&reloader);
+    assert_non_null(update);
+    assert_null(RLD_take(&reloader));
+    free(update);
+    
+    //out of memory
+    reloadMalloc_ptr = MOCK_reloadMalloc;
+    assert_int_equal(RLD_reload(&reloader), ERR_mem);
+    reloadMalloc_ptr = malloc;
+    assert_int_equal(atomic_load(&reloader.rejected), 1);
+    assert_null(RLD_take(&reloader));
+    
+    //untaken config is freed on stop
+    assert_int_equal(RLD_reload(&reloader), ERR_success);
+    RLD_stop(&reloader);
+    
+    //invalid configs are not published
+    assert_int_equal(RLD_start(&reloader, TEST_CFG_INV2_PATH), ERR_success);
+    assert_int_equal(RLD_reload(&reloader), ERR_json);
+    assert_null(RLD_take(&reloader));
+    assert_int_equal(atomic_load(&reloader.rejected), 1);
+    RLD_stop(&reloader);
+}
+
+//void* reloaderThread(void* arg)
+static void test_reloaderThread(void **state)
+{
+    (void)state;
+    reloader_t reloader;
+    intConfig_t* update;
+    
+    copyFile(TEST_CFG1_PATH, TEST_RLD_PATH);
+    assert_int_equal(RLD_start(&reloader, TEST_RLD_PATH), ERR_success);
+    
+    //other files in the directory are ignored
+    copyFile(TEST_CFG1_PATH, TEST_RLD_TMP_PATH);
+    assert_null(waitForChange(&reloader, 0));
+    
+    //renamed over the config, as most editors save
+    assert_int_equal(rename(TEST_RLD_TMP_PATH, TEST_RLD_PATH), 0);
+    update = waitForChange(&reloader, 0);
+    assert_non_null(update);
+    free(update);
+    
+    //written in place
+    copyFile(TEST_CFG3_PATH, TEST_RLD_PATH);
+    update = waitForChange(&reloader, 0);
+    assert_non_null(update);
+    assert_ptr_equal(update->lightSets[ID_west].pattern, &SET_unusedPattern);
+    free(update);
+    
+    //invalid change is rejected
+    copyFile(TEST_CFG_INV2_PATH, TEST_RLD_PATH);
+    assert_null(waitForChange(&reloader, 0));
+    assert_int_equal(atomic_load(&reloader.rejected), 1);
+    
+    RLD_stop(&reloader);
+    remove(TEST_RLD_PATH);
+}
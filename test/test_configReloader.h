@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_configReloader.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_CONFIGRELOADER_H_
+#define _TEST_CONFIGRELOADER_H_
+
+int test_configReloader(void);
+
+
+#endif //_TEST_CONFIGRELOADER_H_
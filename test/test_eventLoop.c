@@ -0,0 +1,245 @@
+/***************************************************************************************
+ * @file    test_eventLoop.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "test_main.h"
+#include "test_eventLoop.h"
+#include "eventLoop.h"
+
+//from eventLoop.c
+extern int epollFd;
+extern int timerFd;
+extern int signalFd;
+extern bool running;
+
+static int handledFd = -1;
+static int handledCount = 0;
+static int handledSignal = 0;
+
+static void test_EVT_init(void **state);
+static void test_EVT_addFd(void **state);
+static void test_EVT_removeFd(void **state);
+static void test_EVT_timer(void **state);
+static void test_EVT_addSignal(void **state);
+
+static uint64_t getTestMillis(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((uint64_t)(ts.tv_sec) * 1000) + (ts.tv_nsec / 1000000));
+}
+
+static void MOCK_stopHandler(int fd, void* arg)
+{
+    char c;
+    
+    (void)arg;
+    handledFd = fd;
+    handledCount++;
+    if(read(fd, &c, 1) < 0)
+    {
+        handledCount = -1;
+    }
+    EVT_stop();
+}
+
+static void MOCK_timerHandler(int fd, void* arg)
+{
+    (void)arg;
+    handledFd = fd;
+    handledCount++;
+    EVT_stop();
+}
+
+static void MOCK_signalHandler(int signo, void* arg)
+{
+    (void)arg;
+    handledSignal = signo;
+    EVT_stop();
+}
+
+int test_eventLoop(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_EVT_init),
+        cmocka_unit_test(test_EVT_addFd),
+        cmocka_unit_test(test_EVT_removeFd),
+        cmocka_unit_test(test_EVT_timer),
+        cmocka_unit_test(test_EVT_addSignal),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t EVT_init(void) and void EVT_close(void)
+static void test_EVT_init(void **state)
+{
+    (void)state;
+    
+    //not initialized
+    EVT_close();
+    assert_int_equal(epollFd, -1);
+    assert_int_equal(EVT_run(), ERR_value);
+    
+    //initialized
+    assert_int_equal(EVT_init(), ERR_success);
+    assert_true(epollFd >= 0);
+    
+    //closed
+    EVT_close();
+    assert_int_equal(epollFd, -1);
+}
+
+//error_t EVT_addFd(int fd, evtHandler_t handler, void* arg)
+static void test_EVT_addFd(void **state)
+{
+    (void)state;
+    int fds[2];
+    int extra[EVT_MAX_HANDLERS];
+    
+    assert_int_equal(pipe(fds), 0);
+    
+    //not initialized
+    EVT_close();
+    assert_int_equal(EVT_addFd(fds[0], MOCK_stopHandler, NULL), ERR_value);
+    
+    assert_int_equal(EVT_init(), ERR_success);
+    
+    //invalid arguments
+    assert_int_equal(EVT_addFd(fds[0], NULL, NULL), ERR_nullPtr);
+    assert_int_equal(EVT_addFd(-1, MOCK_stopHandler, NULL), ERR_value);
+    assert_int_equal(EVT_addFd(12345, MOCK_stopHandler, NULL), ERR_other);  //not an open fd
+    
+    //handler called when fd is readable
+    assert_int_equal(EVT_addFd(fds[0], MOCK_stopHandler, NULL), ERR_success);
+    assert_int_equal(EVT_addFd(fds[0], MOCK_stopHandler, NULL), ERR_value);  //already watched
+    handledFd = -1;
+    handledCount = 0;
+    assert_int_equal(write(fds[1], "x", 1), 1);
+    assert_int_equal(EVT_run(), ERR_success);
+    assert_int_equal(handledFd, fds[0]);
+    assert_int_equal(handledCount, 1);
+    assert_false(running);
+    
+    //handler table full
+    for(uint8_t i = 0; i < EVT_MAX_HANDLERS - 1; i++)
+    {
+        extra[i] = dup(fds[1]);
+        assert_int_equal(EVT_addFd(extra[i], MOCK_stopHandler, NULL), ERR_success);
+    }
+    extra[EVT_MAX_HANDLERS - 1] = dup(fds[1]);
+    assert_int_equal(EVT_addFd(extra[EVT_MAX_HANDLERS - 1], MOCK_stopHandler, NULL), ERR_mem);
+    
+    EVT_close();
+    for(uint8_t i = 0; i < EVT_MAX_HANDLERS; i++)
+    {
+        close(extra[i]);
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+//error_t EVT_removeFd(int fd)
+static void test_EVT_removeFd(void **state)
+{
+    (void)state;
+    int fds[2];
+    
+    assert_int_equal(pipe(fds), 0);
+    assert_int_equal(EVT_init(), ERR_success);
+    
+    //not watched
+    assert_int_equal(EVT_removeFd(fds[0]), ERR_value);
+    assert_int_equal(EVT_removeFd(-1), ERR_value);
+    
+    //removed fd is no longer handled
+    assert_int_equal(EVT_addFd(fds[0], MOCK_stopHandler, NULL), ERR_success);
+    assert_int_equal(EVT_removeFd(fds[0]), ERR_success);
+    assert_int_equal(EVT_removeFd(fds[0]), ERR_value);
+    
+    //entry can be reused
+    assert_int_equal(EVT_addFd(fds[0], MOCK_stopHandler, NULL), ERR_success);
+    
+    EVT_close();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+//error_t EVT_setTimer(evtHandler_t handler, void* arg) and error_t EVT_armTimer(uint64_t deadline)
+static void test_EVT_timer(void **state)
+{
+    (void)state;
+    uint64_t msTime;
+    
+    //not initialized
+    EVT_close();
+    assert_int_equal(EVT_armTimer(0), ERR_value);
+    assert_int_equal(EVT_init(), ERR_success);
+    assert_int_equal(EVT_armTimer(0), ERR_value);
+    assert_int_equal(EVT_setTimer(NULL, NULL), ERR_nullPtr);
+    
+    //timer created once
+    assert_int_equal(EVT_setTimer(MOCK_timerHandler, NULL), ERR_success);
+    assert_true(timerFd >= 0);
+    assert_int_equal(EVT_setTimer(MOCK_timerHandler, NULL), ERR_success);
+    
+    //past deadline fires immediately
+    handledCount = 0;
+    msTime = getTestMillis();
+    assert_int_equal(EVT_armTimer(0), ERR_success);
+    assert_int_equal(EVT_run(), ERR_success);
+    assert_int_equal(handledFd, timerFd);
+    assert_int_equal(handledCount, 1);
+    assert_in_range(getTestMillis(), msTime, msTime+2);
+    
+    //future deadline
+    msTime = getTestMillis();
+    assert_int_equal(EVT_armTimer(msTime + 50), ERR_success);
+    assert_int_equal(EVT_run(), ERR_success);
+    assert_int_equal(handledCount, 2);
+    assert_in_range(getTestMillis(), msTime+50, msTime+52);
+    
+    EVT_close();
+    assert_int_equal(timerFd, -1);
+}
+
+//error_t EVT_addSignal(int signo, evtSignalHandler_t handler, void* arg)
+static void test_EVT_addSignal(void **state)
+{
+    (void)state;
+    sigset_t mask;
+    
+    //not initialized
+    EVT_close();
+    assert_int_equal(EVT_addSignal(SIGUSR2, MOCK_signalHandler, NULL), ERR_value);
+    assert_int_equal(EVT_init(), ERR_success);
+    
+    //invalid arguments
+    assert_int_equal(EVT_addSignal(SIGUSR2, NULL, NULL), ERR_nullPtr);
+    assert_int_equal(EVT_addSignal(0, MOCK_signalHandler, NULL), ERR_value);
+    assert_int_equal(EVT_addSignal(65, MOCK_signalHandler, NULL), ERR_value);
+    
+    //signal delivered through the loop
+    assert_int_equal(EVT_addSignal(SIGUSR2, MOCK_signalHandler, NULL), ERR_success);
+    assert_int_equal(EVT_addSignal(SIGUSR1, MOCK_signalHandler, NULL), ERR_success);
+    assert_true(signalFd >= 0);
+    handledSignal = 0;
+    raise(SIGUSR2);
+    assert_int_equal(EVT_run(), ERR_success);
+    assert_int_equal(handledSignal, SIGUSR2);
+    
+    //signal mask restored on close
+    EVT_close();
+    sigprocmask(SIG_BLOCK, NULL, &mask);
+    assert_false(sigismember(&mask, SIGUSR2));
+    assert_int_equal(signalFd, -1);
+}
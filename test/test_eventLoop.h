@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_eventLoop.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_EVENTLOOP_H_
+#define _TEST_EVENTLOOP_H_
+
+int test_eventLoop(void);
+
+
+#endif //_TEST_EVENTLOOP_H_
@@ -0,0 +1,124 @@
+/***************************************************************************************
+ * @file    test_fleet.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include "test_main.h"
+#include "test_fleet.h"
+#include "fleet.h"
+#include "intersection.h"
+
+static fleet_t fleet;
+static intersection_t intersections[2] = {INTERSECTION_INIT, INTERSECTION_INIT};
+
+static void test_FLT_init(void **state);
+static void test_FLT_tick(void **state);
+static void test_FLT_getLateness(void **state);
+
+int test_fleet(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_FLT_init),
+        cmocka_unit_test(test_FLT_tick),
+        cmocka_unit_test(test_FLT_getLateness),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t FLT_init(fleet_t* fleet, intersection_t* intersections, uint32_t count, uint64_t now)
+static void test_FLT_init(void **state)
+{
+    (void)state;
+    
+    //invalid arguments
+    assert_int_equal(FLT_init(NULL, intersections, 2, 0), ERR_nullPtr);
+    assert_int_equal(FLT_init(&fleet, NULL, 2, 0), ERR_nullPtr);
+    assert_int_equal(FLT_init(&fleet, NULL, 0, 0), ERR_success);
+    
+    //every intersection scheduled
+    assert_int_equal(INT_initCtx(&intersections[0], TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(INT_initCtx(&intersections[1], TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(FLT_init(&fleet, intersections, 2, 1000), ERR_success);
+    assert_int_equal(fleet.wheel.count, 2);
+    assert_true(TW_isScheduled(&intersections[0].timer));
+    assert_true(TW_isScheduled(&intersections[1].timer));
+}
+
+//uint32_t FLT_tick(fleet_t* fleet, uint64_t millis)
+static void test_FLT_tick(void **state)
+{
+    (void)state;
+    
+    intersections[0] = (intersection_t)INTERSECTION_INIT;
+    intersections[1] = (intersection_t)INTERSECTION_INIT;
+    assert_int_equal(INT_initCtx(&intersections[0], TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(INT_initCtx(&intersections[1], TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(FLT_init(&fleet, intersections, 2, 1000), ERR_success);
+    
+    //off intersections start and enter their first step in the first tick
+    assert_int_equal(FLT_tick(&fleet, 1000), 2);
+    assert_int_equal(intersections[0].state, IS_ns);
+    assert_int_equal(intersections[1].state, IS_ns);
+    assert_int_equal(intersections[0].sets.set1->currentStep, 0);
+    assert_int_equal(intersections[1].sets.set1->currentStep, 0);
+    assert_int_equal(intersections[0].timer.expiry, 3000);
+    assert_int_equal(intersections[1].timer.expiry, 3000);
+    
+    //nothing due
+    assert_int_equal(FLT_tick(&fleet, 2999), 0);
+    
+    //only the due intersection is clocked
+    intersections[1].sets.cycleStartTime = 1500;
+    TW_schedule(&fleet.wheel, &intersections[1].timer, INT_nextDeadlineCtx(&intersections[1]));
+    assert_int_equal(FLT_tick(&fleet, 3000), 1);
+    assert_int_equal(intersections[0].sets.set1->currentStep, 1);
+    assert_int_equal(intersections[0].sets.set2->currentStep, 1);
+    assert_int_equal(intersections[1].sets.set1->currentStep, 0);
+    assert_int_equal(FLT_tick(&fleet, 3500), 1);
+    assert_int_equal(intersections[1].sets.set1->currentStep, 1);
+    
+    //late ticks catch up using the current time
+    assert_true(FLT_tick(&fleet, 10000) >= 2);
+    assert_true(intersections[0].timer.expiry > 10000);
+    assert_true(intersections[1].timer.expiry > 10000);
+    assert_int_equal(fleet.wheel.count, 2);
+}
+
+//void FLT_getLateness(const fleet_t* fleet, histogram_t* lateness)
+static void test_FLT_getLateness(void **state)
+{
+    (void)state;
+    histogram_t lateness;
+    histogram_t own[2];
+    
+    intersections[0] = (intersection_t)INTERSECTION_INIT;
+    intersections[1] = (intersection_t)INTERSECTION_INIT;
+    assert_int_equal(INT_initCtx(&intersections[0], TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(INT_initCtx(&intersections[1], TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(FLT_init(&fleet, intersections, 2, 1000), ERR_success);
+    FLT_attachLateness(&fleet, own);
+    
+    //on time and late step changes from both intersections
+    assert_int_equal(FLT_tick(&fleet, 1000), 2);
+    assert_int_equal(FLT_tick(&fleet, 3000), 2);
+    assert_int_equal(FLT_tick(&fleet, 4006), 2);
+    FLT_getLateness(&fleet, &lateness);
+    assert_int_equal(lateness.total, 5);
+    assert_int_equal(lateness.counts[0], 3);
+    assert_int_equal(lateness.counts[6], 2);
+    assert_int_equal(lateness.max, 6);
+    
+    //each intersection's own share: both cfg1 sets change, only one cfg3 set
+    assert_int_equal(own[0].total, 3);
+    assert_int_equal(own[1].total, 2);
+    assert_int_equal(own[0].max, 6);
+    assert_int_equal(own[1].max, 6);
+    
+    //detached intersections record into the fleet's histogram only
+    FLT_attachLateness(&fleet, NULL);
+    assert_null(intersections[0].sets.ownLateness);
+    assert_null(intersections[1].sets.ownLateness);
+}
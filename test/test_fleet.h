@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_fleet.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_FLEET_H_
+#define _TEST_FLEET_H_
+
+int test_fleet(void);
+
+
+#endif //_TEST_FLEET_H_
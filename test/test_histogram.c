@@ -0,0 +1,146 @@
+/***************************************************************************************
+ * @file    test_histogram.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include "test_main.h"
+#include "test_histogram.h"
+#include "histogram.h"
+
+//from histogram.c
+extern uint16_t getBucket(uint64_t value);
+extern uint64_t getBucketLimit(uint16_t bucket);
+
+static histogram_t histogram;
+
+static void test_HIST_record(void **state);
+static void test_HIST_merge(void **state);
+static void test_HIST_percentile(void **state);
+static void test_getBucket(void **state);
+
+int test_histogram(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_HIST_record),
+        cmocka_unit_test(test_HIST_merge),
+        cmocka_unit_test(test_HIST_percentile),
+        cmocka_unit_test(test_getBucket),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//void HIST_record(histogram_t* histogram, uint64_t value)
+static void test_HIST_record(void **state)
+{
+    (void)state;
+    
+    HIST_reset(&histogram);
+    assert_int_equal(histogram.total, 0);
+    assert_int_equal(histogram.max, 0);
+    
+    HIST_record(&histogram, 0);
+    HIST_record(&histogram, 0);
+    HIST_record(&histogram, 100);
+    assert_int_equal(histogram.total, 3);
+    assert_int_equal(histogram.max, 100);
+    assert_int_equal(histogram.counts[0], 2);
+    assert_int_equal(histogram.counts[getBucket(100)], 1);
+    
+    //values beyond the range still counted
+    HIST_record(&histogram, UINT64_MAX);
+    assert_int_equal(histogram.counts[HIST_BUCKETS - 1], 1);
+    assert_true(histogram.max == UINT64_MAX);
+    
+    HIST_reset(&histogram);
+    assert_int_equal(histogram.total, 0);
+    assert_int_equal(histogram.counts[0], 0);
+}
+
+//void HIST_merge(histogram_t* dest, const histogram_t* src)
+static void test_HIST_merge(void **state)
+{
+    (void)state;
+    histogram_t other;
+    
+    HIST_reset(&histogram);
+    HIST_reset(&other);
+    HIST_record(&histogram, 1);
+    HIST_record(&other, 1);
+    HIST_record(&other, 50);
+    
+    HIST_merge(&histogram, &other);
+    assert_int_equal(histogram.total, 3);
+    assert_int_equal(histogram.counts[1], 2);
+    assert_int_equal(histogram.max, 50);
+}
+
+//uint64_t HIST_percentile(const histogram_t* histogram, double percentile)
+static void test_HIST_percentile(void **state)
+{
+    (void)state;
+    
+    //empty histogram
+    HIST_reset(&histogram);
+    assert_int_equal(HIST_percentile(&histogram, 50.0), 0);
+    
+    //exact below the linear range
+    for(uint64_t i = 1; i <= 10; i++)
+    {
+        HIST_record(&histogram, i);
+    }
+    assert_int_equal(HIST_percentile(&histogram, 0.0), 1);
+    assert_int_equal(HIST_percentile(&histogram, 50.0), 5);
+    assert_int_equal(HIST_percentile(&histogram, 60.0), 6);
+    assert_int_equal(HIST_percentile(&histogram, 100.0), 10);
+    
+    //tail values within the bucket precision, capped by the max
+    HIST_reset(&histogram);
+    for(uint16_t i = 0; i < 998; i++)
+    {
+        HIST_record(&histogram, 1);
+    }
+    HIST_record(&histogram, 1000);
+    HIST_record(&histogram, 5000);
+    assert_int_equal(HIST_percentile(&histogram, 99.0), 1);
+    assert_in_range(HIST_percentile(&histogram, 99.9), 1000, 1000 + (1000 / HIST_SUB_BUCKETS));
+    assert_int_equal(HIST_percentile(&histogram, 99.99), 5000);
+    assert_int_equal(HIST_percentile(&histogram, 100.0), 5000);
+    
+    //buckets hold more samples than 32 bits can count, as a large sweep fleet records
+    HIST_reset(&histogram);
+    histogram.counts[0] = UINT32_MAX;
+    histogram.total = UINT32_MAX;
+    HIST_record(&histogram, 0);
+    HIST_record(&histogram, 5000);
+    assert_true(histogram.counts[0] == UINT64_C(1) << 32);
+    assert_int_equal(HIST_percentile(&histogram, 50.0), 0);
+    assert_int_equal(HIST_percentile(&histogram, 100.0), 5000);
+}
+
+//uint16_t getBucket(uint64_t value)
+static void test_getBucket(void **state)
+{
+    (void)state;
+    uint64_t value;
+    
+    //one bucket per value in the linear range
+    assert_int_equal(getBucket(0), 0);
+    assert_int_equal(getBucket(HIST_SUB_BUCKETS - 1), HIST_SUB_BUCKETS - 1);
+    assert_int_equal(getBucket(HIST_SUB_BUCKETS), HIST_SUB_BUCKETS);
+    
+    //buckets are contiguous and every value is within its bucket's limits
+    for(uint16_t bucket = 1; bucket < HIST_BUCKETS - 1; bucket++)
+    {
+        value = getBucketLimit(bucket - 1) + 1;
+        assert_int_equal(getBucket(value), bucket);
+        assert_int_equal(getBucket(getBucketLimit(bucket)), bucket);
+    }
+    
+    //everything past the range shares the last bucket
+    assert_int_equal(getBucket(UINT64_C(1) << HIST_MAX_BITS), HIST_BUCKETS - 1);
+    assert_int_equal(getBucket(UINT64_MAX), HIST_BUCKETS - 1);
+    assert_true(getBucketLimit(HIST_BUCKETS - 1) == UINT64_MAX);
+}
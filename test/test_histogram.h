@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_histogram.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_HISTOGRAM_H_
+#define _TEST_HISTOGRAM_H_
+
+int test_histogram(void);
+
+
+#endif //_TEST_HISTOGRAM_H_
@@ -0,0 +1,297 @@
+/***************************************************************************************
+ * @file    test_image.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_main.h"
+#include "test_image.h"
+#include "image.h"
+#include "config.h"
+#include "configFleet.h"
+
+#define TEST_IMG_PATH           "bin/test_image.img"
+
+//from image.c
+extern uint64_t readLE(const uint8_t* bytes, uint8_t size);
+extern void writeLE(uint8_t* bytes, uint8_t size, uint64_t value);
+extern uint64_t getChecksum(const uint8_t* data, size_t length);
+extern void* (*imageMalloc_ptr)(size_t);  //function ptr for mocking
+
+static intConfig_t configs[2];
+
+static void test_IMG_encode(void **state);
+static void test_IMG_check(void **state);
+static void test_IMG_write(void **state);
+static void test_readLE(void **state);
+static void test_IMG_hash(void **state);
+
+static void* MOCK_imageMalloc(size_t size)
+{
+    (void)size;
+    return NULL;
+}
+
+static void assertSameConfig(const intConfig_t* a, const intConfig_t* b)
+{
+    for(uint8_t set = 0; set < INT_DIRECTIONS; set++)
+    {
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            assert_int_equal(a->lightSets[set].lights[i].type, b->lightSets[set].lights[i].type);
+            assert_int_equal(a->lightSets[set].lights[i].state, b->lightSets[set].lights[i].state);
+        }
+        assert_ptr_equal(a->lightSets[set].pattern, b->lightSets[set].pattern);
+    }
+}
+
+static void loadConfigs(void)
+{
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    
+    configs[0] = unusedConfig;
+    configs[1] = unusedConfig;
+    assert_int_equal(CFG_init(&configs[0], TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(CFG_init(&configs[1], TEST_CFG3_PATH), ERR_success);
+}
+
+int test_image(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_IMG_encode),
+        cmocka_unit_test(test_IMG_check),
+        cmocka_unit_test(test_IMG_write),
+        cmocka_unit_test(test_readLE),
+        cmocka_unit_test(test_IMG_hash),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//void IMG_encode(void* data, const intConfig_t* configs, uint32_t count)
+static void test_IMG_encode(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t decoded;
+    uint8_t* image;
+    uint32_t count = 0;
+    uint32_t steps;
+    
+    loadConfigs();
+    steps = IMG_countSteps(configs, 2);
+    assert_int_equal(steps, 4 * 6 + 2 * 4);
+    image = malloc(IMG_size(2, steps));
+    assert_non_null(image);
+    IMG_encode(image, configs, 2);
+    
+    //detected and valid
+    assert_true(IMG_isImage(image, IMG_size(2, steps)));
+    assert_int_equal(IMG_check(image, IMG_size(2, steps), &count), ERR_success);
+    assert_int_equal(count, 2);
+    assert_int_equal(((imgHeader_t*)image)->steps, 6);
+    
+    //decodes to the parsed configs, sharing their interned patterns
+    decoded = unusedConfig;
+    assert_int_equal(IMG_decode(image, 0, &decoded), ERR_success);
+    assertSameConfig(&decoded, &configs[0]);
+    assert_int_equal(IMG_decode(image, 1, &decoded), ERR_success);
+    assertSameConfig(&decoded, &configs[1]);
+    assert_int_equal(SET_getOffset(decoded.lightSets[ID_north].pattern, 3), (uint64_t)-1);
+    
+    //runtime fields are left alone
+    decoded.lightSets[ID_east].currentStep = 3;
+    assert_int_equal(IMG_decode(image, 0, &decoded), ERR_success);
+    assert_int_equal(decoded.lightSets[ID_east].currentStep, 3);
+    
+    //empty images are valid
+    IMG_encode(image, configs, 0);
+    assert_int_equal(IMG_check(image, IMG_size(0, 0), &count), ERR_success);
+    assert_int_equal(count, 0);
+    
+    free(image);
+}
+
+//error_t IMG_check(const void* data, size_t length, uint32_t* count)
+static void test_IMG_check(void **state)
+{
+    (void)state;
+    intConfig_t invalid;
+    size_t size;
+    imgHeader_t* header;
+    imgLightSet_t* sets;
+    imgStep_t* steps;
+    uint8_t* image;
+    
+    loadConfigs();
+    invalid = configs[0];
+    size = IMG_size(1, IMG_countSteps(configs, 1));
+    image = malloc(size + 1);
+    assert_non_null(image);
+    header = (imgHeader_t*)image;
+    sets = (imgLightSet_t*)(header + 1);
+    steps = (imgStep_t*)&sets[INT_DIRECTIONS];
+    
+    //JSON is not an image
+    assert_false(IMG_isImage("{\"intersection\":[]}", 19));
+    assert_false(IMG_isImage(IMG_MAGIC, IMG_MAGIC_SIZE - 1));
+    assert_int_equal(IMG_check("{\"intersection\":[]}", 19, NULL), ERR_format);
+    
+    //truncated or padded
+    IMG_encode(image, configs, 1);
+    assert_int_equal(IMG_check(image, sizeof(imgHeader_t) - 1, NULL), ERR_format);
+    assert_int_equal(IMG_check(image, size - 1, NULL), ERR_format);
+    assert_int_equal(IMG_check(image, size + 1, NULL), ERR_format);
+    
+    //unsupported version or layout
+    header->version[0]++;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_format);
+    header->version[0]--;
+    header->steps = MAX_STEPS_IN_PATTERN + 1;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_format);
+    header->steps = 6;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_success);
+    header->stepCount[0]++;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_format);
+    header->stepCount[0]--;
+    
+    //corrupted payload
+    image[size - 1] ^= 0x01;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_format);
+    image[size - 1] ^= 0x01;
+    header->checksum[7] ^= 0x80;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_format);
+    
+    //enum values out of range
+    invalid.lightSets[ID_west].lights[4].type = LDT_numTypes;
+    IMG_encode(image, &invalid, 1);
+    assert_int_equal(IMG_check(image, size, NULL), ERR_value);
+    invalid.lightSets[ID_west].lights[4].type = LDT_unused;
+    IMG_encode(image, &invalid, 1);
+    steps[5].state = LSS_unused + 1;
+    writeLE(header->checksum, sizeof(header->checksum), getChecksum((const uint8_t*)sets, size - sizeof(imgHeader_t)));
+    assert_int_equal(IMG_check(image, size, NULL), ERR_value);
+    
+    //patterns longer than the longest or outside the step table
+    IMG_encode(image, &invalid, 1);
+    sets[ID_west].steps = 7;
+    writeLE(header->checksum, sizeof(header->checksum), getChecksum((const uint8_t*)sets, size - sizeof(imgHeader_t)));
+    assert_int_equal(IMG_check(image, size, NULL), ERR_value);
+    header->steps = 7;
+    assert_int_equal(IMG_check(image, size, NULL), ERR_value);
+    
+    free(image);
+}
+
+//error_t IMG_write(const char* filepath, const intConfig_t* configs, uint32_t count)
+static void test_IMG_write(void **state)
+{
+    (void)state;
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    intConfig_t loaded = unusedConfig;
+    cfgFleet_t fleet;
+    FILE* file;
+    
+    loadConfigs();
+    
+    //controller loads an image as it would the JSON config
+    assert_int_equal(IMG_write(TEST_IMG_PATH, configs, 1), ERR_success);
+    assert_int_equal(CFG_init(&loaded, TEST_IMG_PATH), ERR_success);
+    assertSameConfig(&loaded, &configs[0]);
+    
+    //images of several intersections are fleets; the controller rejects them
+    assert_int_equal(IMG_write(TEST_IMG_PATH, configs, 2), ERR_success);
+    loaded = unusedConfig;
+    assert_int_equal(CFG_load(&loaded, TEST_IMG_PATH), ERR_value);
+    assert_ptr_equal(loaded.lightSets[ID_north].pattern, &SET_unusedPattern);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_IMG_PATH, 0), ERR_success);
+    assert_int_equal(fleet.count, 2);
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        assertSameConfig(&fleet.configs[i], &configs[i]);
+        assert_string_equal(fleet.names[i], "");
+    }
+    CFG_freeFleet(&fleet);
+    
+    //no temporary file left behind
+    file = fopen(TEST_IMG_PATH ".tmp", "r");
+    assert_null(file);
+    
+    //empty images load the defaults, and are empty fleets
+    assert_int_equal(IMG_write(TEST_IMG_PATH, configs, 0), ERR_success);
+    assert_int_equal(CFG_init(&loaded, TEST_IMG_PATH), ERR_value);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_IMG_PATH, 0), ERR_value);
+    
+    //corrupt images load the defaults
+    file = fopen(TEST_IMG_PATH, "r+");
+    assert_non_null(file);
+    fputc('X', file);
+    fclose(file);
+    assert_int_equal(CFG_init(&loaded, TEST_IMG_PATH), ERR_json);
+    
+    //fleets are rejected whole if their image fails its check
+    assert_int_equal(IMG_write(TEST_IMG_PATH, configs, 2), ERR_success);
+    file = fopen(TEST_IMG_PATH, "r+");
+    assert_non_null(file);
+    fseek(file, -1, SEEK_END);
+    fputc('X', file);
+    fclose(file);
+    assert_int_equal(CFG_loadFleet(&fleet, TEST_IMG_PATH, 0), ERR_format);
+    assert_null(fleet.configs);
+    
+    //bad path
+    assert_int_equal(IMG_write("bin/missing/test.img", configs, 1), ERR_file);
+    
+    //out of memory
+    imageMalloc_ptr = MOCK_imageMalloc;
+    assert_int_equal(IMG_write(TEST_IMG_PATH, configs, 1), ERR_mem);
+    imageMalloc_ptr = malloc;
+    
+    remove(TEST_IMG_PATH);
+}
+
+//uint64_t readLE(const uint8_t* bytes, uint8_t size)
+static void test_readLE(void **state)
+{
+    (void)state;
+    uint8_t bytes[8] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80};
+    
+    assert_int_equal(readLE(bytes, 1), 0x01);
+    assert_int_equal(readLE(bytes, 2), 0x0201);
+    assert_int_equal(readLE(bytes, 4), 0x04030201);
+    assert_true(readLE(bytes, 8) == UINT64_C(0x8007060504030201));
+    
+    writeLE(bytes, 8, UINT64_C(0x1122334455667788));
+    assert_int_equal(bytes[0], 0x88);
+    assert_int_equal(bytes[7], 0x11);
+    assert_true(readLE(bytes, 8) == UINT64_C(0x1122334455667788));
+}
+
+//uint64_t IMG_hash(const void* data, size_t length)
+static void test_IMG_hash(void **state)
+{
+    (void)state;
+    char data[32] = "{\"intersection\":[]}";
+    uint64_t hash = IMG_hash(data, sizeof(data));
+    
+    //same contents, same hash
+    assert_true(IMG_hash(data, sizeof(data)) == hash);
+    
+    //any changed byte, including in the tail, changes the hash
+    for(uint8_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] ^= 0x01;
+        assert_true(IMG_hash(data, sizeof(data)) != hash);
+        data[i] ^= 0x01;
+    }
+    data[sizeof(data) - 1] = 'x';
+    assert_true(IMG_hash(data, sizeof(data) - 3) != IMG_hash(data, sizeof(data) - 2));
+    
+    //trailing zero bytes change the length and so the hash
+    assert_true(IMG_hash(data, 20) != IMG_hash(data, 21));
+    assert_true(IMG_hash(data, 0) != IMG_hash(data, 8));
+}
@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_image.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_IMAGE_H_
+#define _TEST_IMAGE_H_
+
+int test_image(void);
+
+
+#endif //_TEST_IMAGE_H_
@@ -5,8 +5,11 @@
  * @brief   
  *
  ****************************************************************************************/
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200809L
 #include <time.h>
+#include <signal.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "test_main.h"
 #include "test_intersection.h"
@@ -14,53 +17,144 @@
 #include "config.h"
 #include "lightSet.h"
 
-//from lightSet.c
-extern lightSet_t* lightSet1;
-extern lightSet_t* lightSet2;
-
-//from config.c
-extern lightSet_t lightConfigs[];
-
-//from display.c
-extern uint8_t printedSetSteps[];
-
 //from intersection.c
-extern intState_t intState;
-extern const lightSetStep_t errorSteps[];
-extern error_t (*changeActiveDirection_ptr)(intState_t, uint64_t);
-extern lightSet_t* (*CFG_getLightSet_ptr)(intDirection_t);
+extern intersection_t defaultIntersection;
+extern const setPattern_t errorPattern;
+extern error_t (*changeActiveDirection_ptr)(intersection_t*, intState_t, uint64_t);
+extern lightSet_t* (*CFG_getLightSet_ptr)(intConfig_t*, intDirection_t);
 extern uint64_t getMillis(void);
-extern error_t toggleActiveDirection(uint64_t millis);
-extern error_t changeActiveDirection(intState_t state, uint64_t millis);
+extern uint64_t getCycleAnchor(intersection_t* intersection, uint64_t millis);
+extern error_t toggleActiveDirection(intersection_t* intersection, uint64_t millis);
+extern error_t changeActiveDirection(intersection_t* intersection, intState_t state, uint64_t millis);
+
+//intersection driven by the non-context API
+static intersection_t* const intersection = &defaultIntersection;
+
+//writable copies of interned patterns, handed out in turn
+static setPattern_t editedPatterns[8];
+static uint32_t editedOffsets[8][MAX_STEPS_IN_PATTERN];
+static uint8_t nextEdited;
 
 static void test_INT_init(void **state);
 static void test_INT_stateMachine(void **state);
+static void test_INT_nextDeadline(void **state);
+static void test_INT_contexts(void **state);
+static void test_INT_waitForNextTransition(void **state);
+static void test_INT_runEventLoop(void **state);
 static void test_getMillis(void **state);
+static void test_getCycleAnchor(void **state);
 static void test_toggleActiveDirection(void **state);
 static void test_changeActiveDirection(void **state);
+static void test_INT_getLamps(void **state);
+static void test_INT_fullCycle(void **state);
 
-error_t MOCK_changeActiveDirection(intState_t state, uint64_t millis)
+error_t MOCK_changeActiveDirection(intersection_t* intersection, intState_t state, uint64_t millis)
 {
+    (void)intersection;
     (void)state;
     (void)millis;
     
     return ERR_other;
 }
 
-lightSet_t* MOCK_CFG_getLightSet(intDirection_t dir)
+lightSet_t* MOCK_CFG_getLightSet(intConfig_t* config, intDirection_t dir)
 {
+    (void)config;
     (void)dir;
     return (lightSet_t*)mock();
 }
 
+static void ignoreSignal(int signo)
+{
+    (void)signo;
+}
+
+//interrupt a thread partway through a wait
+static void* interruptLater(void* arg)
+{
+    struct timespec ts = {0, 50000000};
+    
+    nanosleep(&ts, NULL);
+    pthread_kill(*(pthread_t*)arg, SIGUSR2);
+    
+    return NULL;
+}
+
+//point a light set at a writable copy of its pattern, leaving the pool untouched
+static uint32_t* editOffsets(packedSet_t* set)
+{
+    uint8_t edited = nextEdited++ % (sizeof(editedPatterns) / sizeof(editedPatterns[0]));
+    
+    editedPatterns[edited] = *set->pattern;
+    memcpy(editedOffsets[edited], set->pattern->offsets, set->pattern->count * sizeof(uint32_t));
+    editedPatterns[edited].offsets = editedOffsets[edited];
+    set->pattern = &editedPatterns[edited];
+    
+    return editedOffsets[edited];
+}
+
+//mS from the cycle start at which a light set reaches its end step
+static uint64_t getEndOffset(const lightSet_t* set)
+{
+    for(uint8_t i = 1; i < set->pattern->count; i++)
+    {
+        if(SET_getStepState(set->pattern, i) == LSS_end)
+        {
+            return SET_getOffset(set->pattern, i - 1);
+        }
+    }
+    
+    return 0;
+}
+
+//clock an intersection at each of its deadlines until it toggles direction,
+//checking that a set which finishes first holds its end step meanwhile
+static uint64_t runPhase(intersection_t* ctx, uint64_t millis, const uint64_t* ends, uint32_t maxClocks)
+{
+    intState_t state = ctx->state;
+    uint64_t deadline;
+    uint32_t clocks = 0;
+    
+    while((ctx->state == state) && (clocks <= maxClocks))
+    {
+        deadline = INT_nextDeadlineCtx(ctx);
+        if(deadline > millis)
+        {
+            millis = deadline;
+        }
+        if(millis - ctx->sets.cycleStartTime > ends[(state == IS_ns) ? ID_north : ID_east])
+        {
+            assert_int_equal(SET_getStepState(ctx->sets.set1->pattern, ctx->sets.set1->currentStep), LSS_end);
+        }
+        if(millis - ctx->sets.cycleStartTime > ends[(state == IS_ns) ? ID_south : ID_west])
+        {
+            assert_int_equal(SET_getStepState(ctx->sets.set2->pattern, ctx->sets.set2->currentStep), LSS_end);
+        }
+        INT_clockCtx(ctx, millis);
+        clocks++;
+    }
+    
+    //one clock per step change at most, and one for the toggle
+    assert_true(clocks <= maxClocks);
+    
+    return millis;
+}
+
 int test_intersection(void)
 {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_INT_init),
         cmocka_unit_test(test_INT_stateMachine),
+        cmocka_unit_test(test_INT_nextDeadline),
+        cmocka_unit_test(test_INT_contexts),
+        cmocka_unit_test(test_INT_waitForNextTransition),
+        cmocka_unit_test(test_INT_runEventLoop),
         cmocka_unit_test(test_getMillis),
+        cmocka_unit_test(test_getCycleAnchor),
         cmocka_unit_test(test_toggleActiveDirection),
         cmocka_unit_test(test_changeActiveDirection),
+        cmocka_unit_test(test_INT_getLamps),
+        cmocka_unit_test(test_INT_fullCycle),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -72,8 +166,8 @@ static void test_INT_init(void **state)
     
     //ensure expected config was received
     assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
-    assert_int_equal(lightConfigs[ID_east].steps[4].expirationOffset, 7777);
-    assert_int_equal(lightConfigs[ID_west].steps[4].expirationOffset, 7890);
+    assert_int_equal(SET_getOffset(intersection->config.lightSets[ID_east].pattern, 4), 7777);
+    assert_int_equal(SET_getOffset(intersection->config.lightSets[ID_west].pattern, 4), 7890);
 }
 
 static void test_INT_stateMachine(void **state)
@@ -84,70 +178,242 @@ static void test_INT_stateMachine(void **state)
     assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
     
     //switch from off to ns
-    intState = IS_off;
+    intersection->state = IS_off;
     INT_stateMachine();
-    assert_int_equal(intState, IS_ns);
+    assert_int_equal(intersection->state, IS_ns);
     //ensure correct sets have been loaded based on unique light type configs
-    assert_int_equal(lightSet1->lights[2].type, LDT_unused);
-    assert_int_equal(lightSet2->lights[2].type, LDT_solid);
-    assert_int_equal(lightSet2->lights[3].type, LDT_unused);
+    assert_int_equal(SET_getLampType(intersection->sets.set1, 2), LDT_unused);
+    assert_int_equal(SET_getLampType(intersection->sets.set2, 2), LDT_solid);
+    assert_int_equal(SET_getLampType(intersection->sets.set2, 3), LDT_unused);
     
     //switch from ns to ew
     //setup config to ensure state change
-    lightSet1->currentStep = TEST_CFG1_OFF_STEP - 1;
-    lightSet1->steps[TEST_CFG1_OFF_STEP - 1].expirationOffset = 0;
-    lightSet1->cycleStartTime = 0;
-    lightSet2->currentStep = TEST_CFG1_OFF_STEP - 1;
-    lightSet2->steps[TEST_CFG1_OFF_STEP - 1].expirationOffset = 0;
-    lightSet2->cycleStartTime = 0;
+    intersection->sets.set1->currentStep = TEST_CFG1_OFF_STEP - 1;
+    editOffsets(intersection->sets.set1)[TEST_CFG1_OFF_STEP - 1] = 0;
+    intersection->sets.cycleStartTime = 0;
+    intersection->sets.set2->currentStep = TEST_CFG1_OFF_STEP - 1;
+    editOffsets(intersection->sets.set2)[TEST_CFG1_OFF_STEP - 1] = 0;
     INT_stateMachine();
-    assert_int_equal(intState, IS_ew);
+    assert_int_equal(intersection->state, IS_ew);
     
     //switch from ew to ns
     //setup config to ensure state change
-    lightSet1->currentStep = TEST_CFG1_OFF_STEP - 1;
-    lightSet1->steps[TEST_CFG1_OFF_STEP - 1].expirationOffset = 0;
-    lightSet1->cycleStartTime = 0;
-    lightSet2->currentStep = TEST_CFG1_OFF_STEP - 1;
-    lightSet2->steps[TEST_CFG1_OFF_STEP - 1].expirationOffset = 0;
-    lightSet2->cycleStartTime = 0;
+    intersection->sets.set1->currentStep = TEST_CFG1_OFF_STEP - 1;
+    editOffsets(intersection->sets.set1)[TEST_CFG1_OFF_STEP - 1] = 0;
+    intersection->sets.cycleStartTime = 0;
+    intersection->sets.set2->currentStep = TEST_CFG1_OFF_STEP - 1;
+    editOffsets(intersection->sets.set2)[TEST_CFG1_OFF_STEP - 1] = 0;
     INT_stateMachine();
-    assert_int_equal(intState, IS_ns);
+    assert_int_equal(intersection->state, IS_ns);
     
     //confirm DISP_printLightStates is getting called
-    printedSetSteps[ID_north] = MAX_STEPS_IN_PATTERN;
-    printedSetSteps[ID_south] = MAX_STEPS_IN_PATTERN;
+    intersection->display.printedSetSteps[ID_north] = MAX_STEPS_IN_PATTERN;
+    intersection->display.printedSetSteps[ID_south] = MAX_STEPS_IN_PATTERN;
     INT_stateMachine();
-    assert_int_equal(printedSetSteps[ID_north], 0);
-    assert_int_equal(printedSetSteps[ID_south], 0);
+    assert_int_equal(intersection->display.printedSetSteps[ID_north], 0);
+    assert_int_equal(intersection->display.printedSetSteps[ID_south], 0);
     
     //check default case error check
-    intState = IS_off;
+    intersection->state = IS_off;
     changeActiveDirection_ptr = MOCK_changeActiveDirection;
-    assert_memory_not_equal(lightConfigs[ID_north].steps, &errorSteps, SIZE_STEP_ARRAY);
+    assert_ptr_not_equal(intersection->config.lightSets[ID_north].pattern, &errorPattern);
     INT_stateMachine();
-    assert_memory_equal(lightConfigs[ID_north].steps, &errorSteps, SIZE_STEP_ARRAY);
+    assert_ptr_equal(intersection->config.lightSets[ID_north].pattern, &errorPattern);
     
     //reset configs
     assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
     
     //check default case error check
-    assert_int_equal(intState, IS_ew);
-    assert_memory_not_equal(lightConfigs[ID_north].steps, &errorSteps, SIZE_STEP_ARRAY);
+    assert_int_equal(intersection->state, IS_ew);
+    assert_ptr_not_equal(intersection->config.lightSets[ID_north].pattern, &errorPattern);
     //setup config to ensure state change
-    lightSet1->currentStep = TEST_CFG1_OFF_STEP - 1;
-    lightSet1->steps[TEST_CFG1_OFF_STEP - 1].expirationOffset = 0;
-    lightSet1->cycleStartTime = 0;
-    lightSet2->currentStep = TEST_CFG1_OFF_STEP - 1;
-    lightSet2->steps[TEST_CFG1_OFF_STEP - 1].expirationOffset = 0;
-    lightSet2->cycleStartTime = 0;
+    intersection->sets.set1->currentStep = TEST_CFG1_OFF_STEP - 1;
+    editOffsets(intersection->sets.set1)[TEST_CFG1_OFF_STEP - 1] = 0;
+    intersection->sets.cycleStartTime = 0;
+    intersection->sets.set2->currentStep = TEST_CFG1_OFF_STEP - 1;
+    editOffsets(intersection->sets.set2)[TEST_CFG1_OFF_STEP - 1] = 0;
     INT_stateMachine();
-    assert_memory_equal(lightConfigs[ID_north].steps, &errorSteps, SIZE_STEP_ARRAY);
+    assert_ptr_equal(intersection->config.lightSets[ID_north].pattern, &errorPattern);
     
     //reset function pointer
     changeActiveDirection_ptr = changeActiveDirection;
 }
 
+static void test_INT_nextDeadline(void **state)
+{
+    (void)state;
+    
+    //initialize system with the appropriate test configuration
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    
+    //off and error states are due immediately
+    intersection->state = IS_off;
+    assert_int_equal(INT_nextDeadline(), 0);
+    intersection->state = IS_error;
+    assert_int_equal(INT_nextDeadline(), 0);
+    
+    //active sets' deadline
+    intersection->state = IS_off;
+    INT_stateMachine();
+    intersection->sets.set1->currentStep = 0;
+    intersection->sets.cycleStartTime = 1000;
+    intersection->sets.set2->currentStep = 0;
+    assert_int_equal(INT_nextDeadline(), 3000);
+    
+    //last step's expiration is the direction toggle
+    intersection->sets.set1->currentStep = TEST_CFG1_OFF_STEP - 1;
+    intersection->sets.set2->currentStep = TEST_CFG1_OFF_STEP - 1;
+    assert_int_equal(INT_nextDeadline(), 8000);
+    intersection->state = IS_ns;
+    intersection->sets.cycleStartTime = getMillis() - 7000;
+    INT_stateMachine();
+    assert_int_equal(intersection->state, IS_ew);
+    //new sets enter their first step on the next clock
+    assert_true(INT_nextDeadline() <= getMillis());
+    INT_stateMachine();
+    assert_int_equal(intersection->sets.set1->currentStep, 0);
+    assert_int_equal(INT_nextDeadline(), intersection->sets.cycleStartTime + 2000);
+    
+    //a set that finishes first holds its end step instead of making the
+    //deadline due at once, so a sleeping main loop does not spin
+    intersection->sets.cycleStartTime = 1000;
+    intersection->sets.set1->currentStep = TEST_CFG1_OFF_STEP;
+    intersection->sets.set2->currentStep = TEST_CFG1_OFF_STEP - 1;
+    assert_int_equal(INT_nextDeadline(), 1000 + SET_getOffset(intersection->sets.set2->pattern, TEST_CFG1_OFF_STEP - 1));
+    INT_clockCtx(intersection, 8000);
+    assert_int_equal(intersection->state, IS_ew);
+    assert_int_equal(intersection->sets.set1->currentStep, TEST_CFG1_OFF_STEP);
+    assert_int_equal(INT_nextDeadline(), 1000 + SET_getOffset(intersection->sets.set2->pattern, TEST_CFG1_OFF_STEP - 1));
+    
+    //finished sets toggle immediately
+    intersection->sets.set1->pattern = &SET_unusedPattern;
+    intersection->sets.set2->pattern = &SET_unusedPattern;
+    assert_int_equal(INT_nextDeadline(), 0);
+}
+
+static void test_INT_contexts(void **state)
+{
+    (void)state;
+    intersection_t int1 = INTERSECTION_INIT;
+    intersection_t int2 = INTERSECTION_INIT;
+    
+    //default context
+    assert_ptr_equal(INT_getDefault(), &defaultIntersection);
+    
+    //contexts are initialized independently
+    assert_int_equal(INT_initCtx(&int1, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(INT_initCtx(&int2, TEST_CFG3_PATH), ERR_success);
+    
+    //only the default intersection has its own step lateness histogram
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    assert_non_null(defaultIntersection.sets.lateness);
+    assert_null(int1.sets.lateness);
+    assert_int_equal(SET_getOffset(int1.config.lightSets[ID_east].pattern, 4), 7777);
+    assert_int_not_equal(SET_getOffset(int2.config.lightSets[ID_east].pattern, 4), 7777);
+    
+    //and clocked independently
+    assert_int_equal(int1.state, IS_off);
+    INT_stateMachineCtx(&int1);
+    assert_int_equal(int1.state, IS_ns);
+    assert_int_equal(int2.state, IS_off);
+    assert_ptr_equal(int1.sets.set1, &int1.lightSets[ID_north]);
+    assert_null(int2.sets.set1);
+    INT_stateMachineCtx(&int2);
+    assert_int_equal(int2.state, IS_ns);
+    assert_ptr_equal(int2.sets.set1, &int2.lightSets[ID_north]);
+    assert_ptr_equal(int1.sets.set1, &int1.lightSets[ID_north]);
+    
+    //next deadlines come from each context's own sets
+    int1.sets.set1->currentStep = 0;
+    int1.sets.set2->currentStep = 0;
+    int1.sets.cycleStartTime = 0;
+    assert_int_equal(INT_nextDeadlineCtx(&int1), 2000);
+    assert_int_not_equal(INT_nextDeadlineCtx(&int2), 2000);
+}
+
+static void test_INT_waitForNextTransition(void **state)
+{
+    (void)state;
+    uint64_t msTime;
+    struct sigaction handler = {.sa_handler = ignoreSignal};
+    struct sigaction oldHandler;
+    pthread_t self;
+    pthread_t interrupter;
+    
+    //initialize system with the appropriate test configuration
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    
+    //off state returns immediately
+    intersection->state = IS_off;
+    msTime = getMillis();
+    INT_waitForNextTransition();
+    assert_in_range(getMillis(), msTime, msTime+2);
+    
+    //sleep until the step expires
+    intersection->state = IS_off;
+    INT_stateMachine();
+    assert_int_equal(intersection->state, IS_ns);
+    msTime = getMillis();
+    intersection->sets.set1->currentStep = 0;
+    intersection->sets.cycleStartTime = msTime + 100 - SET_getOffset(intersection->sets.set1->pattern, 0);
+    intersection->sets.set2->currentStep = 0;
+    editOffsets(intersection->sets.set2)[0] = intersection->sets.set1->pattern->offsets[0] + 100;
+    INT_waitForNextTransition();
+    assert_in_range(getMillis(), msTime+100, msTime+102);
+    
+    //the state machine changes step right on return
+    INT_stateMachine();
+    assert_int_equal(intersection->sets.set1->currentStep, 1);
+    assert_int_equal(intersection->sets.set2->currentStep, 0);
+    
+    //expired deadline returns immediately
+    intersection->sets.cycleStartTime = 0;
+    msTime = getMillis();
+    INT_waitForNextTransition();
+    assert_in_range(getMillis(), msTime, msTime+2);
+    
+    //no pending deadline returns immediately
+    intersection->sets.set1->pattern = &SET_unusedPattern;
+    intersection->sets.set2->pattern = &SET_unusedPattern;
+    msTime = getMillis();
+    INT_waitForNextTransition();
+    assert_in_range(getMillis(), msTime, msTime+2);
+    
+    //a signal ends the wait so the caller can handle it
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    intersection->state = IS_off;
+    INT_stateMachine();
+    msTime = getMillis();
+    intersection->sets.set1->currentStep = 0;
+    intersection->sets.set2->currentStep = 0;
+    intersection->sets.cycleStartTime = msTime + 1000;
+    sigaction(SIGUSR2, &handler, &oldHandler);
+    self = pthread_self();
+    assert_int_equal(pthread_create(&interrupter, NULL, interruptLater, &self), 0);
+    INT_waitForNextTransition();
+    assert_in_range(getMillis(), msTime+50, msTime+500);
+    pthread_join(interrupter, NULL);
+    sigaction(SIGUSR2, &oldHandler, NULL);
+}
+
+static void test_INT_runEventLoop(void **state)
+{
+    (void)state;
+    sigset_t mask;
+    
+    //initialize system with the appropriate test configuration
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    intersection->state = IS_off;
+    
+    //pending termination signal stops the loop after the first wakeup
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    raise(SIGTERM);
+    assert_int_equal(INT_runEventLoop(), ERR_success);
+    sigprocmask(SIG_UNBLOCK, &mask, NULL);
+}
+
 static void test_getMillis(void **state)
 {
     (void)state;
@@ -160,30 +426,99 @@ static void test_getMillis(void **state)
     assert_in_range(getMillis(), msTime+2000, msTime+2002);
 }
 
+static void test_getCycleAnchor(void **state)
+{
+    (void)state;
+    intersection_t late = INTERSECTION_INIT;
+    uint64_t millis;
+    
+    //cfg3 cycle: north from 0 to 4000, east from 4000 to 8000
+    assert_int_equal(INT_initCtx(&late, TEST_CFG3_PATH), ERR_success);
+    INT_clockCtx(&late, 1000);
+    INT_clockCtx(&late, 1000);
+    assert_int_equal(late.state, IS_ns);
+    
+    //late direction change starts the next pattern on schedule
+    INT_clockCtx(&late, 3001);
+    INT_clockCtx(&late, 4002);
+    INT_clockCtx(&late, 5010);
+    assert_int_equal(late.state, IS_ew);
+    assert_int_equal(late.sets.cycleStartTime, 5000);
+    assert_int_equal(late.lateness, 10);
+    assert_int_equal(late.maxLateness, 10);
+    
+    //constant lateness does not accumulate over many cycles
+    for(uint16_t i = 0; i < 1000; i++)
+    {
+        millis = INT_nextDeadlineCtx(&late) + 7;
+        INT_clockCtx(&late, millis);
+        INT_clockCtx(&late, millis);
+    }
+    assert_int_equal((late.sets.cycleStartTime - 1000) % 4000, 0);
+    assert_int_equal(late.maxLateness, 10);
+    assert_int_equal(late.resyncs, 0);
+    
+    //lateness beyond the catch-up limit restarts the schedule at the current time
+    late.sets.cycleStartTime = 0;
+    late.sets.set1->stepStart = 1000;
+    late.sets.set2->stepStart = 1000;
+    assert_int_equal(getCycleAnchor(&late, 1000 + INT_MAX_CATCH_UP), 1000);
+    assert_int_equal(late.lateness, INT_MAX_CATCH_UP);
+    assert_int_equal(getCycleAnchor(&late, 1001 + INT_MAX_CATCH_UP), 1001 + INT_MAX_CATCH_UP);
+    assert_int_equal(late.lateness, INT_MAX_CATCH_UP + 1);
+    assert_int_equal(late.maxLateness, INT_MAX_CATCH_UP + 1);
+    assert_int_equal(late.resyncs, 1);
+    
+    //no schedule for unused sets
+    late.sets.set1 = &late.lightSets[ID_south];
+    late.sets.set2 = &late.lightSets[ID_west];
+    assert_int_equal(getCycleAnchor(&late, 123456), 123456);
+    assert_int_equal(late.lateness, 0);
+}
+
 static void test_toggleActiveDirection(void **state)
 {
     (void)state;
+    reloader_t reloader;
 
     //Change from NS to EW
-    intState = IS_ns;
-    assert_int_equal(toggleActiveDirection(0), ERR_success);
-    assert_int_equal(intState, IS_ew);
+    intersection->state = IS_ns;
+    assert_int_equal(toggleActiveDirection(intersection, 0), ERR_success);
+    assert_int_equal(intersection->state, IS_ew);
     
     //Change from EW to NS
-    assert_int_equal(toggleActiveDirection(0), ERR_success);
-    assert_int_equal(intState, IS_ns);
+    assert_int_equal(toggleActiveDirection(intersection, 0), ERR_success);
+    assert_int_equal(intersection->state, IS_ns);
     
     //Stay in any state other than NS or EW
-    intState = IS_off;
-    assert_int_equal(toggleActiveDirection(0), ERR_success);
-    assert_int_equal(intState, IS_off);
+    intersection->state = IS_off;
+    assert_int_equal(toggleActiveDirection(intersection, 0), ERR_success);
+    assert_int_equal(intersection->state, IS_off);
     
     //check other return val
     changeActiveDirection_ptr = MOCK_changeActiveDirection;
-    intState = IS_ns;
-    assert_int_equal(toggleActiveDirection(0), ERR_other);
-    assert_int_equal(intState, IS_ns);
+    intersection->state = IS_ns;
+    assert_int_equal(toggleActiveDirection(intersection, 0), ERR_other);
+    assert_int_equal(intersection->state, IS_ns);
     changeActiveDirection_ptr = changeActiveDirection;
+    
+    //reloaded config is applied at the direction change
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    intersection->state = IS_ns;
+    assert_int_equal(RLD_start(&reloader, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(RLD_reload(&reloader), ERR_success);
+    intersection->reloader = &reloader;
+    assert_ptr_not_equal(intersection->config.lightSets[ID_west].pattern, &SET_unusedPattern);
+    assert_int_equal(toggleActiveDirection(intersection, 0), ERR_success);
+    assert_int_equal(intersection->state, IS_ew);
+    assert_ptr_equal(intersection->config.lightSets[ID_west].pattern, &SET_unusedPattern);
+    assert_null(RLD_take(&reloader));
+    
+    //nothing pending
+    assert_int_equal(toggleActiveDirection(intersection, 0), ERR_success);
+    assert_int_equal(intersection->state, IS_ns);
+    intersection->reloader = NULL;
+    RLD_stop(&reloader);
 }
 
 
@@ -195,68 +530,177 @@ static void test_changeActiveDirection(void **state)
     assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
     
     //state validity check
-    intState = IS_ns;
-    assert_int_equal(changeActiveDirection(IS_off, 0), ERR_value);
-    assert_int_equal(intState, IS_ns);
+    intersection->state = IS_ns;
+    assert_int_equal(changeActiveDirection(intersection, IS_off, 0), ERR_value);
+    assert_int_equal(intersection->state, IS_ns);
     
     //state difference check
-    intState = IS_ns;
-    lightSet1->cycleStartTime = 0;
-    assert_int_equal(changeActiveDirection(IS_ns, 1), ERR_success);
-    assert_int_equal(intState, IS_ns);
-    assert_int_equal(lightSet1->cycleStartTime, 0); //confirms function returned where expected
+    intersection->state = IS_ns;
+    intersection->sets.cycleStartTime = 0;
+    assert_int_equal(changeActiveDirection(intersection, IS_ns, 1), ERR_success);
+    assert_int_equal(intersection->state, IS_ns);
+    assert_int_equal(intersection->sets.cycleStartTime, 0); //confirms function returned where expected
     
     //ns to ew change
-    intState = IS_ns;
-    lightSet1 = NULL;
-    lightSet2 = NULL;
-    assert_int_equal(changeActiveDirection(IS_ew, 1), ERR_success);
-    assert_int_equal(intState, IS_ew);
-    assert_non_null(lightSet1);
-    assert_non_null(lightSet2);
-    assert_int_equal(lightSet1->cycleStartTime, 1);
-    assert_int_equal(lightSet2->cycleStartTime, 1);
-    assert_ptr_equal(lightSet1, &lightConfigs[ID_east]);
-    assert_ptr_equal(lightSet2, &lightConfigs[ID_west]);
+    intersection->state = IS_ns;
+    intersection->sets.set1 = NULL;
+    intersection->sets.set2 = NULL;
+    assert_int_equal(changeActiveDirection(intersection, IS_ew, 1), ERR_success);
+    assert_int_equal(intersection->state, IS_ew);
+    assert_non_null(intersection->sets.set1);
+    assert_non_null(intersection->sets.set2);
+    assert_int_equal(intersection->sets.cycleStartTime, 1);
+    assert_ptr_equal(intersection->sets.set1, &intersection->lightSets[ID_east]);
+    assert_ptr_equal(intersection->sets.set2, &intersection->lightSets[ID_west]);
     
     //ew to ns change
-    lightSet1 = NULL;
-    lightSet2 = NULL;
-    assert_int_equal(changeActiveDirection(IS_ns, 5), ERR_success);
-    assert_int_equal(intState, IS_ns);
-    assert_non_null(lightSet1);
-    assert_non_null(lightSet2);
-    assert_int_equal(lightSet1->cycleStartTime, 5);
-    assert_int_equal(lightSet2->cycleStartTime, 5);
-    assert_ptr_equal(lightSet1, &lightConfigs[ID_north]);
-    assert_ptr_equal(lightSet2, &lightConfigs[ID_south]);
+    intersection->sets.set1 = NULL;
+    intersection->sets.set2 = NULL;
+    assert_int_equal(changeActiveDirection(intersection, IS_ns, 5), ERR_success);
+    assert_int_equal(intersection->state, IS_ns);
+    assert_non_null(intersection->sets.set1);
+    assert_non_null(intersection->sets.set2);
+    assert_int_equal(intersection->sets.cycleStartTime, 5);
+    assert_ptr_equal(intersection->sets.set1, &intersection->lightSets[ID_north]);
+    assert_ptr_equal(intersection->sets.set2, &intersection->lightSets[ID_south]);
     
     //ns to error change
-    intState = IS_ns;
-    lightSet1 = NULL;
-    lightSet2 = NULL;
-    assert_memory_not_equal(lightConfigs[ID_north].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_memory_not_equal(lightConfigs[ID_south].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_memory_not_equal(lightConfigs[ID_east].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_memory_not_equal(lightConfigs[ID_west].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_int_equal(changeActiveDirection(IS_error, 1), ERR_success);
-    assert_int_equal(intState, IS_ew);
-    assert_non_null(lightSet1);
-    assert_non_null(lightSet2);
-    assert_memory_equal(lightConfigs[ID_north].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_memory_equal(lightConfigs[ID_south].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_memory_equal(lightConfigs[ID_east].steps, &errorSteps, SIZE_STEP_ARRAY);
-    assert_memory_equal(lightConfigs[ID_west].steps, &errorSteps, SIZE_STEP_ARRAY);
-    
-    //fail to assign lights
+    intersection->state = IS_ns;
+    intersection->sets.set1 = NULL;
+    intersection->sets.set2 = NULL;
+    assert_ptr_not_equal(intersection->config.lightSets[ID_north].pattern, &errorPattern);
+    assert_ptr_not_equal(intersection->config.lightSets[ID_south].pattern, &errorPattern);
+    assert_ptr_not_equal(intersection->config.lightSets[ID_east].pattern, &errorPattern);
+    assert_ptr_not_equal(intersection->config.lightSets[ID_west].pattern, &errorPattern);
+    assert_int_equal(changeActiveDirection(intersection, IS_error, 1), ERR_success);
+    assert_int_equal(intersection->state, IS_ew);
+    assert_non_null(intersection->sets.set1);
+    assert_non_null(intersection->sets.set2);
+    assert_ptr_equal(intersection->config.lightSets[ID_north].pattern, &errorPattern);
+    assert_ptr_equal(intersection->config.lightSets[ID_south].pattern, &errorPattern);
+    assert_ptr_equal(intersection->config.lightSets[ID_east].pattern, &errorPattern);
+    assert_ptr_equal(intersection->config.lightSets[ID_west].pattern, &errorPattern);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        assert_ptr_equal(intersection->lightSets[dir].pattern, &errorPattern);
+        assert_int_equal(SET_getStepState(intersection->lightSets[dir].pattern, 0), LSS_disable);
+        assert_int_equal(SET_getOffset(intersection->lightSets[dir].pattern, 0), 1000);
+        assert_int_equal(SET_getStepState(intersection->lightSets[dir].pattern, 1), LSS_end);
+    }
+    
+    //fail to find the configs for the error pattern
     CFG_getLightSet_ptr = MOCK_CFG_getLightSet;
-    intState = IS_ns;
-    lightSet1 = NULL;
-    lightSet2 = NULL;
+    intersection->state = IS_ns;
+    intersection->sets.set1 = NULL;
+    intersection->sets.set2 = NULL;
     will_return(MOCK_CFG_getLightSet, NULL);
-    will_return(MOCK_CFG_getLightSet, NULL);
-    assert_int_equal(changeActiveDirection(IS_ew, 1), ERR_nullPtr);
+    assert_int_equal(changeActiveDirection(intersection, IS_error, 1), ERR_nullPtr);
+    assert_int_equal(intersection->state, IS_ns);
     CFG_getLightSet_ptr = CFG_getLightSet;
     
 }
 
+//uint64_t INT_getLampsCtx(const intersection_t* intersection)
+static void test_INT_getLamps(void **state)
+{
+    (void)state;
+    uint64_t snapshot;
+    uint64_t changed;
+    
+    //board of the packed config, all lamps red
+    assert_int_equal(INT_init(TEST_CFG1_PATH), ERR_success);
+    assert_true(INT_getLamps() == INT_getLampsCtx(intersection));
+    assert_int_equal(INT_getLamps() & (SET_BOARD_YELLOWS | SET_BOARD_GREENS), 0);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        assert_int_equal(intersection->lightSets[dir].lane, dir);
+        for(uint8_t light = 0; light < MAX_LIGHTS_IN_SET; light++)
+        {
+            assert_int_equal(SET_getBoardLamp(INT_getLamps(), dir, light),
+                             (SET_getLampType(&intersection->lightSets[dir], light) == LDT_unused) ? LS_off : LS_red);
+        }
+    }
+    
+    //the first step changes only the lanes of the active directions
+    snapshot = INT_getLamps();
+    intersection->state = IS_off;
+    INT_clockCtx(intersection, 0);
+    INT_clockCtx(intersection, 0);
+    changed = snapshot ^ INT_getLamps();
+    assert_int_not_equal(changed & INT_LANES_NS, 0);
+    assert_int_equal(changed & INT_LANES_EW, 0);
+    for(uint8_t light = 0; (light < MAX_LIGHTS_IN_SET) && (SET_getLampType(&intersection->lightSets[ID_north], light) != LDT_unused); light++)
+    {
+        assert_int_equal(SET_getBoardLamp(INT_getLamps(), ID_north, light), SET_getLamp(&intersection->lightSets[ID_north], light));
+    }
+    assert_false(INT_lampsConflict(INT_getLamps()));
+    
+    //green or yellow arrows in crossing directions conflict
+    assert_false(INT_lampsConflict(0));
+    assert_false(INT_lampsConflict(SET_BOARD_GREENS & INT_LANES_NS));
+    assert_false(INT_lampsConflict(SET_BOARD_REDS));
+    assert_true(INT_lampsConflict(((uint64_t)SET_BOARD_GREEN << (ID_south * SET_BOARD_LANE_BITS)) |
+                                  ((uint64_t)(SET_BOARD_YELLOW | SET_BOARD_GREEN) << (ID_east * SET_BOARD_LANE_BITS + 3))));
+    assert_false(INT_lampsConflict((uint64_t)SET_BOARD_YELLOW << (ID_east * SET_BOARD_LANE_BITS)));
+    
+    //arrow lamps are told apart from solid ones by the arrow mask, which is a subset of the lamps in use
+    assert_true(INT_getArrows() == INT_getArrowsCtx(intersection));
+    assert_int_not_equal(INT_getArrows(), 0);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        for(uint8_t light = 0; light < MAX_LIGHTS_IN_SET; light++)
+        {
+            assert_true(((INT_getArrows() >> (dir * SET_BOARD_LANE_BITS + light * SET_BOARD_LAMP_BITS)) & SET_BOARD_LAMP_MASK) ==
+                        ((SET_getLampType(&intersection->lightSets[dir], light) == LDT_arrow) ? SET_BOARD_LAMP_MASK : 0));
+        }
+    }
+    
+    //the first North step is a protected left: a green arrow while the solid lamps stay red
+    assert_int_not_equal(INT_getLamps() & INT_getArrows() & SET_BOARD_GREENS & SET_BOARD_LANE(ID_north), 0);
+    assert_int_equal(INT_getLamps() & ~INT_getArrows() & SET_BOARD_GREENS & SET_BOARD_LANE(ID_north), 0);
+}
+
+static void test_INT_fullCycle(void **state)
+{
+    (void)state;
+    intersection_t ctx = INTERSECTION_INIT;
+    uint64_t ends[INT_DIRECTIONS];
+    uint64_t nsLength;
+    uint64_t ewLength;
+    uint64_t millis;
+    uint32_t nsSteps;
+    uint32_t ewSteps;
+    
+    //the test config's sets end at different times
+    assert_int_equal(INT_initCtx(&ctx, TEST_CFG1_PATH), ERR_success);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        ends[dir] = getEndOffset(&ctx.config.lightSets[dir]);
+    }
+    assert_int_not_equal(ends[ID_east], ends[ID_west]);
+    nsLength = (ends[ID_north] > ends[ID_south]) ? ends[ID_north] : ends[ID_south];
+    ewLength = (ends[ID_east] > ends[ID_west]) ? ends[ID_east] : ends[ID_west];
+    nsSteps = ctx.lightSets[ID_north].pattern->count + ctx.lightSets[ID_south].pattern->count + 1;
+    ewSteps = ctx.lightSets[ID_east].pattern->count + ctx.lightSets[ID_west].pattern->count + 1;
+    
+    //start North-South
+    INT_clockCtx(&ctx, 0);
+    assert_int_equal(ctx.state, IS_ns);
+    
+    //each direction lasts until its later set ends, twice over so the second
+    //cycle starts its sets again from their first steps
+    millis = 0;
+    for(uint8_t cycle = 1; cycle <= 2; cycle++)
+    {
+        millis = runPhase(&ctx, millis, ends, nsSteps);
+        assert_int_equal(ctx.state, IS_ew);
+        assert_int_equal(millis, cycle * nsLength + (cycle - 1) * ewLength);
+        assert_int_equal(ctx.sets.cycleStartTime, millis);
+        
+        millis = runPhase(&ctx, millis, ends, ewSteps);
+        assert_int_equal(ctx.state, IS_ns);
+        assert_int_equal(millis, cycle * (nsLength + ewLength));
+        assert_int_equal(ctx.sets.cycleStartTime, millis);
+    }
+    assert_int_equal(ctx.resyncs, 0);
+}
@@ -11,145 +11,433 @@
 #include "lightSet.h"
 
 //from lightSet.c
-extern lightSet_t* lightSet1;
-extern lightSet_t* lightSet2;
-extern lightSetState_t clockLightSetStateMachine(lightSet_t* set, uint64_t millis);
-extern lightSetState_t incrementLightSetStep(lightSet_t* set);
+extern lightSetState_t clockLightSetStateMachine(packedSet_t* set, uint64_t cycleStartTime, uint64_t millis, histogram_t* lateness, histogram_t* ownLateness, uint64_t* board);
+extern uint64_t getLightSetDeadline(const packedSet_t* set, uint64_t cycleStartTime);
+extern lightSetState_t incrementLightSetStep(packedSet_t* set);
+extern uint64_t widenOffset(uint32_t offset);
 extern lightState_t getArrowState(lightSetState_t setState);
 extern lightState_t getSolidGreenState(lightSetState_t setState);
 
-//from config.c
-extern lightSet_t lightConfigs[];
+//test intersection state
+static intConfig_t config = {.lightSets = UNUSED_CONFIG};
+static packedSet_t packed[INT_DIRECTIONS];
+static activeLightSets_t sets;
+static histogram_t lateness;
+static histogram_t ownLateness;
 
+ /*****************************************************************************
+ ** @brief Load packed sets
+ **     Load a test config and pack every direction of it
+ **
+ ** @param filepath: config to load
+ **
+ ** @return none
+******************************************************************************/
+static void loadPacked(char* filepath)
+{
+    assert_int_equal(CFG_init(&config, filepath), ERR_success);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        SET_pack(&packed[dir], &config.lightSets[dir]);
+    }
+}
+
+static void test_SET_pack(void **state);
 
 static void test_SET_assignLights(void **state);
 static void test_SET_stateMachine(void **state);
+static void test_SET_nextDeadline(void **state);
+static void test_SET_getLightState(void **state);
+static void test_SET_endTime(void **state);
+static void test_SET_updateBoard(void **state);
 static void test_clockLightSetStateMachine(void **state);
+static void test_getLightSetDeadline(void **state);
 static void test_incrementLightSetStep(void **state);
 static void test_getArrowState(void **state);
 static void test_getSolidGreenState(void **state);
+static void test_widenOffset(void **state);
 
 int test_lightSet(void)
 {
     const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_SET_pack),
         cmocka_unit_test(test_SET_assignLights),
         cmocka_unit_test(test_SET_stateMachine),
+        cmocka_unit_test(test_SET_nextDeadline),
+        cmocka_unit_test(test_SET_getLightState),
+        cmocka_unit_test(test_SET_endTime),
+        cmocka_unit_test(test_SET_updateBoard),
         cmocka_unit_test(test_clockLightSetStateMachine),
+        cmocka_unit_test(test_getLightSetDeadline),
         cmocka_unit_test(test_incrementLightSetStep),
         cmocka_unit_test(test_getArrowState),
         cmocka_unit_test(test_getSolidGreenState),
+        cmocka_unit_test(test_widenOffset),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
 
-//error_t SET_assignLights(lightSet_t* set1, lightSet_t* set2, uint64_t startTime)
+//void SET_pack(packedSet_t* packed, const lightSet_t* set)
+static void test_SET_pack(void **state)
+{
+    (void)state;
+    lightSet_t set = DEFAULT_LIGHT_SET_N;
+    const setPattern_t errors = PATTERN_FLASH_RED;
+    packedSet_t small;
+    
+    //lights, pattern and the lead-in before its first step
+    set.lights[1].state = LS_yellow;
+    SET_pack(&small, &set);
+    assert_int_equal(SET_getLampType(&small, 0), LDT_arrow);
+    assert_int_equal(SET_getLampType(&small, 1), LDT_solid);
+    assert_int_equal(SET_getLampType(&small, 2), LDT_unused);
+    assert_int_equal(SET_getLamp(&small, 0), LS_red);
+    assert_int_equal(SET_getLamp(&small, 1), LS_yellow);
+    assert_ptr_equal(small.pattern, &CFG_advGreenPattern);
+    assert_int_equal(small.currentStep, CFG_advGreenPattern.count);
+    assert_int_equal(small.stepStart, 0);
+    
+    //a starting step within the pattern is kept, one past it is the lead-in
+    set.currentStep = 2;
+    SET_pack(&small, &set);
+    assert_int_equal(small.currentStep, 2);
+    set.pattern = &errors;
+    set.currentStep = SET_LEAD_IN;
+    SET_pack(&small, &set);
+    assert_int_equal(small.currentStep, 2);
+    assert_int_equal(SET_getStepState(small.pattern, 0), LSS_disable);
+    assert_int_equal(SET_getOffset(small.pattern, 0), 1000);
+    assert_int_equal(SET_getStepState(small.pattern, 1), LSS_end);
+    assert_int_equal(SET_getOffset(small.pattern, 1), (uint64_t)-1);
+    
+    //the lead-in expires at the start of the cycle
+    assert_int_equal(SET_getStepState(small.pattern, 2), LSS_unused);
+    assert_int_equal(SET_getOffset(small.pattern, 2), 0);
+    
+    //unused sets have no steps
+    set.pattern = &SET_unusedPattern;
+    SET_pack(&small, &set);
+    assert_int_equal(small.currentStep, 0);
+    assert_int_equal(SET_getStepState(small.pattern, 0), LSS_unused);
+    
+    //every config pattern and light round trips
+    loadPacked(TEST_CFG1_PATH);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        assert_ptr_equal(packed[dir].pattern, config.lightSets[dir].pattern);
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            assert_int_equal(SET_getLampType(&packed[dir], i), config.lightSets[dir].lights[i].type);
+            assert_int_equal(SET_getLamp(&packed[dir], i), config.lightSets[dir].lights[i].state);
+        }
+    }
+}
+
+//error_t SET_assignLights(activeLightSets_t* active, packedSet_t* set1, packedSet_t* set2, uint64_t startTime)
 static void test_SET_assignLights(void **state)
 {
     (void)state;
     
-    lightSet_t set1, set2;
+    packedSet_t set1 = SET_PACKED_UNUSED;
+    packedSet_t set2 = SET_PACKED_UNUSED;
     
     //setting of new pointers
-    assert_ptr_not_equal(lightSet1, &set1);
-    assert_ptr_not_equal(lightSet2, &set2);
-    assert_int_equal(SET_assignLights(&set1, &set2, 0), ERR_success);
-    assert_ptr_equal(lightSet1, &set1);
-    assert_ptr_equal(lightSet2, &set2);
+    assert_ptr_not_equal(sets.set1, &set1);
+    assert_ptr_not_equal(sets.set2, &set2);
+    assert_int_equal(SET_assignLights(&sets, &set1, &set2, 0), ERR_success);
+    assert_ptr_equal(sets.set1, &set1);
+    assert_ptr_equal(sets.set2, &set2);
     
     //null pointer tests
-    assert_int_equal(SET_assignLights(NULL, &set2, 0), ERR_nullPtr);
-    assert_int_equal(SET_assignLights(&set1, NULL, 0), ERR_nullPtr);
-    assert_int_equal(SET_assignLights(NULL, NULL, 0), ERR_nullPtr);
+    assert_int_equal(SET_assignLights(&sets, NULL, &set2, 0), ERR_nullPtr);
+    assert_int_equal(SET_assignLights(&sets, &set1, NULL, 0), ERR_nullPtr);
+    assert_int_equal(SET_assignLights(&sets, NULL, NULL, 0), ERR_nullPtr);
     
     //updating cycle start times
-    set1.cycleStartTime = 0;
-    set2.cycleStartTime = 0;
-    assert_int_equal(SET_assignLights(&set1, &set2, 13), ERR_success);
-    assert_int_equal(set1.cycleStartTime, 13);
-    assert_int_equal(set2.cycleStartTime, 13);
+    sets.cycleStartTime = 0;
+    set1.stepStart = 100;
+    set2.stepStart = 100;
+    assert_int_equal(SET_assignLights(&sets, &set1, &set2, 13), ERR_success);
+    assert_int_equal(sets.cycleStartTime, 13);
+    assert_int_equal(set1.stepStart, 0);
+    assert_int_equal(set2.stepStart, 0);
+    
+    //finished sets go back to the lead-in, others keep their step
+    loadPacked(TEST_CFG1_PATH);
+    packed[ID_north].currentStep = packed[ID_north].pattern->count - 1;
+    packed[ID_south].currentStep = 0;
+    assert_int_equal(SET_getStepState(packed[ID_north].pattern, packed[ID_north].currentStep), LSS_end);
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 13), ERR_success);
+    assert_int_equal(packed[ID_north].currentStep, packed[ID_north].pattern->count);
+    assert_int_equal(packed[ID_south].currentStep, 0);
 }
 
 
-//lightSetState_t SET_stateMachine(uint64_t millis)
+//lightSetState_t SET_stateMachine(activeLightSets_t* active, uint64_t millis)
 static void test_SET_stateMachine(void **state)
 {
     (void)state;
     
     //setup system config
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success);
+    loadPacked(TEST_CFG1_PATH);
     
     //clocking of both state machines
-    assert_int_equal(SET_assignLights(&lightConfigs[ID_north], &lightConfigs[ID_south], 0), ERR_success);
-    lightSet1->currentStep = 0;  //LPSR
-    lightSet2->currentStep = 0;  //LPSR
-    assert_int_equal(SET_stateMachine(2000), LSS_LUSR); //set 1&2, step 0 ends @ 2000mS
-    assert_int_equal(lightSet1->currentStep, 1); //LUSR
-    assert_int_equal(lightSet2->currentStep, 1); //LUSR
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 0), ERR_success);
+    sets.set1->currentStep = 0;  //LPSR
+    sets.set2->currentStep = 0;  //LPSR
+    assert_int_equal(SET_stateMachine(&sets, 2000), LSS_LUSR); //set 1&2, step 0 ends @ 2000mS
+    assert_int_equal(sets.set1->currentStep, 1); //LUSR
+    assert_int_equal(sets.set2->currentStep, 1); //LUSR
     
     //get overall state from set 1
-    assert_int_equal(SET_stateMachine(3000), LSS_LUSG); //set 1, step 1 ends @ 3000mS
-    assert_int_equal(lightSet1->currentStep, 2); //LUSG < LUSR
-    assert_int_equal(lightSet2->currentStep, 1); //LUSR
+    assert_int_equal(SET_stateMachine(&sets, 3000), LSS_LUSG); //set 1, step 1 ends @ 3000mS
+    assert_int_equal(sets.set1->currentStep, 2); //LUSG < LUSR
+    assert_int_equal(sets.set2->currentStep, 1); //LUSR
     
     //set overall state from set 2
-    assert_int_equal(SET_stateMachine(4000), LSS_LUSG); //set 2, step 1 ends @ 4000mS
-    assert_int_equal(lightSet1->currentStep, 2); //LUSG
-    assert_int_equal(lightSet2->currentStep, 2); //LUSG
-    assert_int_equal(SET_stateMachine(4500), LSS_LUSG); //set 1, step 2 ends @ 4500mS
-    assert_int_equal(lightSet1->currentStep, 3); //LYSY > LUSG
-    assert_int_equal(lightSet2->currentStep, 2); //LUSG
+    assert_int_equal(SET_stateMachine(&sets, 4000), LSS_LUSG); //set 2, step 1 ends @ 4000mS
+    assert_int_equal(sets.set1->currentStep, 2); //LUSG
+    assert_int_equal(sets.set2->currentStep, 2); //LUSG
+    assert_int_equal(SET_stateMachine(&sets, 4500), LSS_LUSG); //set 1, step 2 ends @ 4500mS
+    assert_int_equal(sets.set1->currentStep, 3); //LYSY > LUSG
+    assert_int_equal(sets.set2->currentStep, 2); //LUSG
     
     //both states @ end
-    assert_int_equal(SET_stateMachine(5000), LSS_LYSY); //set 2, step 2 ends @ 5000mS
-    assert_int_equal(lightSet1->currentStep, 3); //LYSY
-    assert_int_equal(lightSet2->currentStep, 3); //LYSY
-    assert_int_equal(SET_stateMachine(6000), LSS_LRSR); //set 1&2, step 3 ends @ 6000mS
-    assert_int_equal(lightSet1->currentStep, 4); //LRSR
-    assert_int_equal(lightSet2->currentStep, 4); //LRSR
-    assert_int_equal(SET_stateMachine(7000), LSS_end); //sets 1&2 end @ 7000mS
-    assert_int_equal(lightSet1->currentStep, 5); //end
-    assert_int_equal(lightSet2->currentStep, 5); //end
+    assert_int_equal(SET_stateMachine(&sets, 5000), LSS_LYSY); //set 2, step 2 ends @ 5000mS
+    assert_int_equal(sets.set1->currentStep, 3); //LYSY
+    assert_int_equal(sets.set2->currentStep, 3); //LYSY
+    assert_int_equal(SET_stateMachine(&sets, 6000), LSS_LRSR); //set 1&2, step 3 ends @ 6000mS
+    assert_int_equal(sets.set1->currentStep, 4); //LRSR
+    assert_int_equal(sets.set2->currentStep, 4); //LRSR
+    assert_int_equal(SET_stateMachine(&sets, 7000), LSS_end); //sets 1&2 end @ 7000mS
+    assert_int_equal(sets.set1->currentStep, 5); //end
+    assert_int_equal(sets.set2->currentStep, 5); //end
+}
+
+//uint64_t SET_nextDeadline(void)
+static void test_SET_nextDeadline(void **state)
+{
+    (void)state;
+    
+    //setup system config
+    loadPacked(TEST_CFG1_PATH);
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 100), ERR_success);
+    sets.set1->currentStep = 2;  //LUSG, ends @ 4500mS
+    sets.set2->currentStep = 1;  //LUSR, ends @ 4000mS
+    
+    //earliest of both sets
+    assert_int_equal(SET_nextDeadline(&sets), 4100);
+    sets.set2->currentStep = 2;  //LUSG, ends @ 5000mS
+    assert_int_equal(SET_nextDeadline(&sets), 4600);
+    
+    //clocking before the deadline does nothing, clocking at it changes step
+    assert_int_equal(SET_stateMachine(&sets, 4599), LSS_LUSG);
+    assert_int_equal(sets.set1->currentStep, 2);
+    assert_int_equal(SET_stateMachine(&sets, 4600), LSS_LUSG);
+    assert_int_equal(sets.set1->currentStep, 3);
+    assert_int_equal(SET_nextDeadline(&sets), 5100);
+    
+    //unused sets have no deadline
+    sets.set1->pattern = &SET_unusedPattern;
+    assert_int_equal(SET_nextDeadline(&sets), 5100);
+    sets.set2->pattern = &SET_unusedPattern;
+    assert_int_equal(SET_nextDeadline(&sets), SET_NO_DEADLINE);
+}
+
+//lightState_t SET_getLightState(const light_t* light, lightSetState_t setState)
+static void test_SET_getLightState(void **state)
+{
+    (void)state;
+    light_t arrow = LIGHT_ADV_GRN;
+    light_t solid = LIGHT_SOLID_GRN;
+    light_t unused = LIGHT_UNUSED;
+    
+    //matches the state set by incrementLightSetStep for each light type
+    assert_int_equal(SET_getLightState(&arrow, LSS_LUSG), LS_yellowArrow);
+    assert_int_equal(SET_getLightState(&solid, LSS_LUSG), LS_green);
+    assert_int_equal(SET_getLightState(&arrow, LSS_end), LS_red);
+    assert_int_equal(SET_getLightState(&solid, LSS_end), LS_red);
+    assert_int_equal(SET_getLightState(&solid, LSS_disable), LS_off);
+    assert_int_equal(SET_getLightState(&unused, LSS_LPSG), LS_off);
+}
+
+//uint64_t SET_endTime(const activeLightSets_t* active)
+static void test_SET_endTime(void **state)
+{
+    (void)state;
+    
+    loadPacked(TEST_CFG1_PATH);
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 100), ERR_success);
+    assert_int_equal(SET_endTime(&sets), 100);
+    
+    //later of the two scheduled step starts
+    sets.set1->stepStart = 7000;
+    sets.set2->stepStart = 6900;
+    assert_int_equal(SET_endTime(&sets), 7100);
+    
+    //unused sets have no schedule
+    sets.set1->pattern = &SET_unusedPattern;
+    assert_int_equal(SET_endTime(&sets), 7000);
+    sets.set2->pattern = &SET_unusedPattern;
+    assert_int_equal(SET_endTime(&sets), SET_NO_DEADLINE);
 }
 
-//lightSetState_t clockLightSetStateMachine(lightSet_t* set, uint64_t millis);
+//void SET_updateBoard(uint64_t* board, const packedSet_t* set)
+//uint64_t SET_getBoardArrows(const packedSet_t* set)
+static void test_SET_updateBoard(void **state)
+{
+    (void)state;
+    lightSet_t set = {.lights = {{LDT_arrow, LS_green}, {LDT_solid, LS_yellow}, {LDT_arrow, LS_yellowArrow},
+                                 {LDT_solid, LS_red}, {LDT_unused, LS_red}},
+                      .pattern = &SET_unusedPattern};
+    packedSet_t small;
+    uint64_t board = 0;
+    
+    //one colour bit per lit lamp, yellow arrows in the green position too; unused lights are dark
+    SET_pack(&small, &set);
+    small.lane = 2;
+    SET_updateBoard(&board, &small);
+    assert_true(board == ((uint64_t)(SET_BOARD_GREEN | (SET_BOARD_YELLOW << 3) | ((SET_BOARD_YELLOW | SET_BOARD_GREEN) << 6) |
+                                     (SET_BOARD_RED << 9)) << 32));
+    assert_int_equal(SET_getBoardLamp(board, 2, 0), LS_green);
+    assert_int_equal(SET_getBoardLamp(board, 2, 1), LS_yellow);
+    assert_int_equal(SET_getBoardLamp(board, 2, 2), LS_yellowArrow);
+    assert_int_equal(SET_getBoardLamp(board, 2, 3), LS_red);
+    assert_int_equal(SET_getBoardLamp(board, 2, 4), LS_off);
+    assert_int_equal(SET_getBoardLamp(board, 1, 0), LS_off);
+    
+    //planes of each colour
+    assert_true((board & SET_BOARD_GREENS) == ((uint64_t)(SET_BOARD_GREEN | (SET_BOARD_GREEN << 6)) << 32));
+    assert_true((board & SET_BOARD_REDS) == ((uint64_t)SET_BOARD_RED << 41));
+    
+    //arrow mask tells the green arrow from a solid green of the same colour bits
+    assert_true(SET_getBoardArrows(&small) == ((uint64_t)(SET_BOARD_LAMP_MASK | (SET_BOARD_LAMP_MASK << 6)) << 32));
+    assert_int_equal(board & ~SET_getBoardArrows(&small) & SET_BOARD_GREENS, 0);
+    
+    //replacing a lane leaves the others alone
+    board |= SET_BOARD_LANE(0) | SET_BOARD_LANE(3);
+    set.lights[0].state = LS_red;
+    set.lights[2].state = LS_off;
+    SET_pack(&small, &set);
+    small.lane = 2;
+    SET_updateBoard(&board, &small);
+    assert_int_equal(SET_getBoardLamp(board, 2, 0), LS_red);
+    assert_int_equal(SET_getBoardLamp(board, 2, 2), LS_off);
+    assert_true((board & SET_BOARD_LANE(0)) == SET_BOARD_LANE(0));
+    assert_true((board & SET_BOARD_LANE(3)) == SET_BOARD_LANE(3));
+    
+    //invalid colour combinations read as off
+    assert_int_equal(SET_getBoardLamp(SET_BOARD_LAMP_MASK, 0, 0), LS_off);
+}
+
+//lightSetState_t clockLightSetStateMachine(packedSet_t* set, uint64_t cycleStartTime, uint64_t millis, histogram_t* lateness, histogram_t* ownLateness, uint64_t* board);
 static void test_clockLightSetStateMachine(void **state)
 {
     (void)state;
+    uint64_t board;
     
     //setup system config
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success);
-    assert_int_equal(SET_assignLights(&lightConfigs[ID_north], &lightConfigs[ID_south], 0), ERR_success);
-    lightSet1->currentStep = 0;
-    lightSet2->currentStep = 0;
+    loadPacked(TEST_CFG1_PATH);
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 0), ERR_success);
+    sets.set1->currentStep = 0;
+    sets.set2->currentStep = 0;
     
     //invalid ptr check
-    assert_int_equal(clockLightSetStateMachine(NULL, 0), LSS_end);
+    assert_int_equal(clockLightSetStateMachine(NULL, 0, 0, NULL, NULL, NULL), LSS_end);
     
     //unused set check
-    assert_int_not_equal(clockLightSetStateMachine(lightSet1, 0), LSS_end);
-    lightSet1->steps[0].state = LSS_unused;
-    assert_int_equal(clockLightSetStateMachine(lightSet1, 0), LSS_end);
+    assert_int_not_equal(clockLightSetStateMachine(sets.set1, 0, 0, NULL, NULL, NULL), LSS_end);
+    sets.set1->pattern = &SET_unusedPattern;
+    assert_int_equal(clockLightSetStateMachine(sets.set1, 0, 0, NULL, NULL, NULL), LSS_end);
     
     //state not yet expired
-    assert_int_equal(lightSet2->currentStep, 0);
-    assert_int_equal(lightSet2->steps[0].state, LSS_LPSR);
-    assert_int_equal(lightSet2->steps[0].expirationOffset, 2000);
-    assert_int_equal(clockLightSetStateMachine(lightSet2, 0), LSS_LPSR);
-    assert_int_equal(clockLightSetStateMachine(lightSet2, 1000), LSS_LPSR);
-    assert_int_equal(clockLightSetStateMachine(lightSet2, 1999), LSS_LPSR);
-    assert_int_equal(lightSet2->currentStep, 0);
+    assert_int_equal(sets.set2->currentStep, 0);
+    assert_int_equal(sets.set2->pattern->states[0], LSS_LPSR);
+    assert_int_equal(SET_getOffset(sets.set2->pattern, 0), 2000);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 0, NULL, NULL, NULL), LSS_LPSR);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 1000, NULL, NULL, NULL), LSS_LPSR);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 1999, NULL, NULL, NULL), LSS_LPSR);
+    assert_int_equal(sets.set2->currentStep, 0);
     
     //state just expired
-    assert_int_equal(lightSet2->steps[1].state, LSS_LUSR);
-    assert_int_equal(clockLightSetStateMachine(lightSet2, 2000), LSS_LUSR);
-    assert_int_equal(lightSet2->currentStep, 1);
-    
-    //state long past expired
-    assert_int_equal(lightSet2->steps[2].state, LSS_LUSG);
-    assert_int_equal(lightSet2->steps[1].expirationOffset, 4000);
-    assert_int_equal(clockLightSetStateMachine(lightSet2, 9000), LSS_LUSG);
-    assert_int_equal(lightSet2->currentStep, 2);
+    assert_int_equal(sets.set2->pattern->states[1], LSS_LUSR);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 2000, NULL, NULL, NULL), LSS_LUSR);
+    assert_int_equal(sets.set2->currentStep, 1);
+    assert_int_equal(sets.set2->stepStart, 2000);
+    
+    //state long past expired; step start is still the scheduled time
+    assert_int_equal(sets.set2->pattern->states[2], LSS_LUSG);
+    assert_int_equal(SET_getOffset(sets.set2->pattern, 1), 4000);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 9000, NULL, NULL, NULL), LSS_LUSG);
+    assert_int_equal(sets.set2->currentStep, 2);
+    assert_int_equal(sets.set2->stepStart, 4000);
+    
+    //lateness of scheduled step changes recorded, in both histograms if two are attached
+    HIST_reset(&lateness);
+    HIST_reset(&ownLateness);
+    assert_int_equal(SET_getOffset(sets.set2->pattern, 2), 5000);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 5000, &lateness, NULL, NULL), sets.set2->pattern->states[3]);
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, 6003, &lateness, &ownLateness, NULL), sets.set2->pattern->states[4]);
+    assert_int_equal(lateness.total, 2);
+    assert_int_equal(lateness.counts[0], 1);
+    assert_int_equal(lateness.max, 3);
+    assert_int_equal(ownLateness.total, 1);
+    assert_int_equal(ownLateness.max, 3);
+    
+    //end step held however long it is clocked
+    sets.set2->currentStep = TEST_CFG1_OFF_STEP;
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 0, UINT64_MAX - 1, &lateness, NULL, NULL), LSS_end);
+    assert_int_equal(sets.set2->currentStep, TEST_CFG1_OFF_STEP);
+    
+    //immediate change out of the lead-in not recorded
+    sets.set2->currentStep = sets.set2->pattern->count;
+    sets.set2->stepStart = 0;
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 20000, 20000, &lateness, NULL, NULL), sets.set2->pattern->states[0]);
+    assert_int_equal(lateness.total, 2);
+    
+    //step changes update the set's lane of the lamp board, and only that lane
+    board = SET_BOARD_LANE(ID_north);
+    sets.set2->lane = ID_south;
+    sets.set2->currentStep = sets.set2->pattern->count;
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 20000, 20000, NULL, NULL, &board), sets.set2->pattern->states[0]);
+    assert_int_equal(board & SET_BOARD_LANE(ID_north), SET_BOARD_LANE(ID_north));
+    assert_int_not_equal(board & SET_BOARD_LANE(ID_south), 0);
+    for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+    {
+        if(SET_getLampType(sets.set2, i) != LDT_unused)
+        {
+            assert_int_equal(SET_getBoardLamp(board, ID_south, i), SET_getLamp(sets.set2, i));
+        }
+    }
+    
+    //no step change leaves the board alone
+    board = 0;
+    assert_int_equal(clockLightSetStateMachine(sets.set2, 20000, 20000, NULL, NULL, &board), sets.set2->pattern->states[0]);
+    assert_int_equal(board, 0);
+}
+
+//uint64_t getLightSetDeadline(const packedSet_t* set, uint64_t cycleStartTime)
+static void test_getLightSetDeadline(void **state)
+{
+    (void)state;
+    
+    //setup system config
+    loadPacked(TEST_CFG1_PATH);
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 10), ERR_success);
+    sets.set1->currentStep = 0;
+    
+    //invalid ptr check
+    assert_int_equal(getLightSetDeadline(NULL, 10), SET_NO_DEADLINE);
+    
+    //expiration relative to cycle start
+    assert_int_equal(getLightSetDeadline(sets.set1, 10), 2010);
+    sets.set1->currentStep = 4;
+    assert_int_equal(getLightSetDeadline(sets.set1, 10), 7010);
+    
+    //unused set check
+    sets.set1->pattern = &SET_unusedPattern;
+    assert_int_equal(getLightSetDeadline(sets.set1, 10), SET_NO_DEADLINE);
 }
 
 //lightSetState_t incrementLightSetStep(lightSet_t* set);
@@ -158,47 +446,45 @@ static void test_incrementLightSetStep(void **state)
     (void)state;
     
     //setup system config
-    assert_int_equal(CFG_init(TEST_CFG1_PATH), ERR_success);
-    assert_int_equal(SET_assignLights(&lightConfigs[ID_north], &lightConfigs[ID_south], 0), ERR_success);
-    lightSet1->currentStep = MAX_STEPS_IN_PATTERN - 1;
-    lightSet2->currentStep = 0;
-    
-    //increment step number (wrap-around and not)
-    assert_int_equal(lightSet1->steps[0].state, LSS_LPSR);
-    assert_int_equal(incrementLightSetStep(lightSet1), LSS_LPSR);
-    assert_int_equal(lightSet1->currentStep, 0);
-    assert_int_equal(lightSet1->steps[1].state, LSS_LUSR);
-    assert_int_equal(incrementLightSetStep(lightSet1), LSS_LUSR);
-    assert_int_equal(lightSet1->currentStep, 1);
-    
-    //skip unused steps
-    lightSet1->currentStep = 5;
-    assert_int_equal(lightSet1->steps[6].state, LSS_unused);
-    assert_int_equal(lightSet1->steps[7].state, LSS_unused);
-    assert_int_equal(lightSet1->steps[8].state, LSS_unused);
-    assert_int_equal(lightSet1->steps[9].state, LSS_unused);
-    assert_int_equal(MAX_STEPS_IN_PATTERN, 10);
-    assert_int_equal(incrementLightSetStep(lightSet1), LSS_LPSR);
-    assert_int_equal(lightSet1->currentStep, 0);
+    loadPacked(TEST_CFG1_PATH);
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_north], &packed[ID_south], 0), ERR_success);
+    sets.set1->currentStep = sets.set1->pattern->count;
+    sets.set2->currentStep = 0;
+    
+    //increment step number (from the lead-in and not)
+    assert_int_equal(sets.set1->pattern->states[0], LSS_LPSR);
+    assert_int_equal(incrementLightSetStep(sets.set1), LSS_LPSR);
+    assert_int_equal(sets.set1->currentStep, 0);
+    assert_int_equal(sets.set1->pattern->states[1], LSS_LUSR);
+    assert_int_equal(incrementLightSetStep(sets.set1), LSS_LUSR);
+    assert_int_equal(sets.set1->currentStep, 1);
+    
+    //wrap around after the last step
+    sets.set1->currentStep = 5;
+    assert_int_equal(sets.set1->pattern->count, 6);
+    assert_int_equal(incrementLightSetStep(sets.set1), LSS_LPSR);
+    assert_int_equal(sets.set1->currentStep, 0);
     
     //setting appropriate states for different light types and skipping all lights after an unused one
-    assert_int_equal(SET_assignLights(&lightConfigs[ID_east], &lightConfigs[ID_west], 0), ERR_success);
-    lightSet1->currentStep = 2;
-    lightSet2->currentStep = 2;
-    assert_int_equal(lightSet1->steps[3].state, LSS_LUSY);  //state with different values for different light types
-    assert_int_equal(lightSet1->lights[0].type, LDT_arrow); //arrow light
-    lightSet1->lights[0].state = LS_off;
-    assert_int_equal(lightSet1->lights[1].type, LDT_solid); //solid light
-    lightSet1->lights[1].state = LS_off;
-    lightSet1->lights[2].type = LDT_unused; //set as unused light
-    lightSet1->lights[2].state = LS_off;
-    lightSet1->lights[3].type = LDT_solid;  //set a dummy light other than unused which should be skipped
-    lightSet1->lights[3].state = LS_off;
-    assert_int_equal(incrementLightSetStep(lightSet1), LSS_LUSY);   //switched to expected state
-    assert_int_equal(lightSet1->lights[0].state, LS_yellowArrow);   //arrow light
-    assert_int_equal(lightSet1->lights[1].state, LS_yellow);        //arrow light
-    assert_int_equal(lightSet1->lights[2].state, LS_off);           //unused light
-    assert_int_equal(lightSet1->lights[3].state, LS_off);           //skipped arrow light
+    assert_int_equal(SET_assignLights(&sets, &packed[ID_east], &packed[ID_west], 0), ERR_success);
+    sets.set1->currentStep = 2;
+    sets.set2->currentStep = 2;
+    assert_int_equal(sets.set1->pattern->states[3], LSS_LUSY);  //state with different values for different light types
+    assert_int_equal(config.lightSets[ID_east].lights[0].type, LDT_arrow); //arrow light
+    config.lightSets[ID_east].lights[0].state = LS_off;
+    assert_int_equal(config.lightSets[ID_east].lights[1].type, LDT_solid); //solid light
+    config.lightSets[ID_east].lights[1].state = LS_off;
+    config.lightSets[ID_east].lights[2].type = LDT_unused; //set as unused light
+    config.lightSets[ID_east].lights[2].state = LS_off;
+    config.lightSets[ID_east].lights[3].type = LDT_solid;  //set a dummy light other than unused which should be skipped
+    config.lightSets[ID_east].lights[3].state = LS_off;
+    SET_pack(sets.set1, &config.lightSets[ID_east]);
+    sets.set1->currentStep = 2;
+    assert_int_equal(incrementLightSetStep(sets.set1), LSS_LUSY);   //switched to expected state
+    assert_int_equal(SET_getLamp(sets.set1, 0), LS_yellowArrow);    //arrow light
+    assert_int_equal(SET_getLamp(sets.set1, 1), LS_yellow);         //arrow light
+    assert_int_equal(SET_getLamp(sets.set1, 2), LS_off);            //unused light
+    assert_int_equal(SET_getLamp(sets.set1, 3), LS_off);            //skipped arrow light
 }
 
 //lightState_t getArrowState(lightSetState_t setState);
@@ -252,3 +538,16 @@ static void test_getSolidGreenState(void **state)
     assert_int_equal(getSolidGreenState(LSS_unused), LS_off);
 }
 
+//uint64_t widenOffset(uint32_t offset)
+static void test_widenOffset(void **state)
+{
+    (void)state;
+    
+    assert_int_equal(widenOffset(0), 0);
+    assert_int_equal(widenOffset(7000), 7000);
+    assert_int_equal(widenOffset(INT32_MAX), INT32_MAX);
+    
+    //negative config times and the end step's never expiring offset
+    assert_int_equal(widenOffset((uint32_t)-5), (uint64_t)-5);
+    assert_int_equal(widenOffset(UINT32_MAX), (uint64_t)-1);
+}
@@ -20,7 +20,6 @@
 #include "main.h"
 
 #define SIZE_LIGHT_ARRAY        (sizeof(light_t) * MAX_LIGHTS_IN_SET)
-#define SIZE_STEP_ARRAY         (sizeof(lightSetStep_t) * MAX_STEPS_IN_PATTERN)
 
 #define TEST_CFG1_PATH          "test/test_config1.json"
 #define TEST_CFG1_OFF_STEP      5
@@ -45,5 +44,8 @@
 #define TEST_CFG_INV13_PATH     "test/test_config_invalid13.json"
 #define TEST_CFG_INV14_PATH     "test/test_config_invalid14.json"
 
+#define TEST_CFG_FLEET_PATH     "test/test_config_fleet.json"
+#define TEST_CFG_FLEET_COUNT    3
+
 
 #endif //_TEST_MAIN_H_
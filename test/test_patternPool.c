@@ -0,0 +1,208 @@
+/***************************************************************************************
+ * @file    test_patternPool.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "test_main.h"
+#include "test_patternPool.h"
+#include "patternPool.h"
+#include "config.h"
+
+#define TEST_POOL_THREADS       4
+
+//from patternPool.c
+extern void* (*patternAlloc_ptr)(size_t, size_t);  //function ptr for mocking
+
+static patternPool_t pool = PATTERN_POOL_INIT;
+
+static void test_PAT_intern(void **state);
+static void test_PAT_internThreads(void **state);
+static void test_PAT_release(void **state);
+static void test_PAT_getDefault(void **state);
+
+static void* MOCK_patternAlloc(size_t alignment, size_t size)
+{
+    (void)alignment;
+    (void)size;
+    return NULL;
+}
+
+//intern a copy of another pool's pattern
+static const setPattern_t* internCopy(const setPattern_t* pattern)
+{
+    lightSetStep_t steps[MAX_STEPS_IN_PATTERN];
+    
+    for(uint8_t i = 0; i < pattern->count; i++)
+    {
+        steps[i].state = SET_getStepState(pattern, i);
+        steps[i].expirationOffset = SET_getOffset(pattern, i);
+    }
+    
+    return PAT_intern(&pool, steps, pattern->count);
+}
+
+static void* internConfig(void* arg)
+{
+    intConfig_t* config = arg;
+    
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        if(!internCopy(config->lightSets[dir].pattern))
+        {
+            return arg;
+        }
+    }
+    
+    return NULL;
+}
+
+int test_patternPool(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_PAT_intern),
+        cmocka_unit_test(test_PAT_internThreads),
+        cmocka_unit_test(test_PAT_release),
+        cmocka_unit_test(test_PAT_getDefault),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//const setPattern_t* PAT_intern(patternPool_t* pool, const lightSetStep_t* steps, uint8_t count)
+static void test_PAT_intern(void **state)
+{
+    (void)state;
+    lightSetStep_t steps[] = {{LSS_LPSR, 3000}, {LSS_LYSR, 5000}, {LSS_LUSG, 7000},
+                              {LSS_LYSY, 9000}, {LSS_LRSR, 11000}, {LSS_end, (uint64_t)-1}};
+    const setPattern_t* pattern;
+    
+    //first copy is added, packed into its own cache line with exactly its steps
+    pattern = PAT_intern(&pool, steps, 6);
+    assert_non_null(pattern);
+    assert_int_equal((uintptr_t)pattern % SET_CACHE_LINE, 0);
+    assert_int_equal(pool.count, 1);
+    assert_int_equal(pattern->count, 6);
+    for(uint8_t i = 0; i < 6; i++)
+    {
+        assert_int_equal(pattern->states[i], steps[i].state);
+        assert_int_equal(pattern->offsets[i], (uint32_t)steps[i].expirationOffset);
+    }
+    
+    //identical steps share it
+    assert_ptr_equal(PAT_intern(&pool, steps, 6), pattern);
+    assert_int_equal(pool.count, 1);
+    assert_int_equal(pool.requests, 2);
+    
+    //any difference in state, time or length is a new pattern
+    steps[3].expirationOffset++;
+    assert_ptr_not_equal(PAT_intern(&pool, steps, 6), pattern);
+    steps[3].expirationOffset--;
+    steps[5].state = LSS_disable;
+    assert_ptr_not_equal(PAT_intern(&pool, steps, 6), pattern);
+    steps[5].state = LSS_end;
+    assert_ptr_not_equal(PAT_intern(&pool, steps, 5), pattern);
+    assert_int_equal(pool.count, 4);
+    
+    //no steps is the unused pattern, which the pool does not hold
+    assert_ptr_equal(PAT_intern(&pool, steps, 0), &SET_unusedPattern);
+    assert_int_equal(pool.count, 4);
+    
+    //out of memory leaves the pool as it was
+    steps[0].state = LSS_LRSR;
+    patternAlloc_ptr = MOCK_patternAlloc;
+    assert_null(PAT_intern(&pool, steps, 6));
+    patternAlloc_ptr = aligned_alloc;
+    assert_int_equal(pool.count, 4);
+    
+    PAT_release(&pool);
+}
+
+//concurrent interning, as from the fleet config loading threads
+static void test_PAT_internThreads(void **state)
+{
+    (void)state;
+    intConfig_t configs[TEST_POOL_THREADS];
+    pthread_t threads[TEST_POOL_THREADS];
+    uint32_t used = 0;
+    void* result;
+    
+    for(uint8_t i = 0; i < TEST_POOL_THREADS; i++)
+    {
+        configs[i] = (intConfig_t){.lightSets = UNUSED_CONFIG};
+        assert_int_equal(CFG_init(&configs[i], (i % 2) ? TEST_CFG3_PATH : TEST_CFG1_PATH), ERR_success);
+    }
+    for(uint8_t i = 0; i < TEST_POOL_THREADS; i++)
+    {
+        assert_int_equal(pthread_create(&threads[i], NULL, internConfig, &configs[i]), 0);
+    }
+    for(uint8_t i = 0; i < TEST_POOL_THREADS; i++)
+    {
+        assert_int_equal(pthread_join(threads[i], &result), 0);
+        assert_null(result);
+    }
+    
+    //one copy of each distinct pattern of the two configs, unused sets are not pooled
+    for(uint8_t i = 0; i < TEST_POOL_THREADS; i++)
+    {
+        for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+        {
+            used += configs[i].lightSets[dir].pattern->count ? 1 : 0;
+        }
+    }
+    assert_int_equal(pool.requests, used);
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        assert_ptr_equal(internCopy(configs[0].lightSets[dir].pattern), internCopy(configs[2].lightSets[dir].pattern));
+        assert_ptr_equal(internCopy(configs[1].lightSets[dir].pattern), internCopy(configs[3].lightSets[dir].pattern));
+    }
+    assert_true(pool.count < 2 * INT_DIRECTIONS);
+    
+    PAT_release(&pool);
+}
+
+//void PAT_release(patternPool_t* pool)
+static void test_PAT_release(void **state)
+{
+    (void)state;
+    const lightSetStep_t steps[] = {{LSS_disable, 1000}, {LSS_end, (uint64_t)-1}};
+    
+    assert_non_null(PAT_intern(&pool, steps, 2));
+    PAT_release(&pool);
+    assert_int_equal(pool.count, 0);
+    assert_int_equal(pool.requests, 0);
+    for(uint32_t bucket = 0; bucket < PAT_BUCKETS; bucket++)
+    {
+        assert_null(pool.buckets[bucket]);
+    }
+    
+    //usable again
+    assert_non_null(PAT_intern(&pool, steps, 2));
+    assert_int_equal(pool.count, 1);
+    PAT_release(&pool);
+}
+
+//patternPool_t* PAT_getDefault(void)
+static void test_PAT_getDefault(void **state)
+{
+    (void)state;
+    intConfig_t configs[2];
+    
+    //parsed configs share the patterns of the default pool
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        configs[i] = (intConfig_t){.lightSets = UNUSED_CONFIG};
+        assert_int_equal(CFG_init(&configs[i], TEST_CFG1_PATH), ERR_success);
+    }
+    for(uint8_t dir = 0; dir < INT_DIRECTIONS; dir++)
+    {
+        assert_ptr_equal(configs[0].lightSets[dir].pattern, configs[1].lightSets[dir].pattern);
+    }
+    assert_non_null(PAT_getDefault());
+    assert_true(PAT_getDefault()->count >= 2);
+    assert_int_equal((uintptr_t)configs[0].lightSets[ID_north].pattern % SET_CACHE_LINE, 0);
+}
@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_patternPool.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_PATTERNPOOL_H_
+#define _TEST_PATTERNPOOL_H_
+
+int test_patternPool(void);
+
+
+#endif //_TEST_PATTERNPOOL_H_
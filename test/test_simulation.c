@@ -0,0 +1,177 @@
+/***************************************************************************************
+ * @file    test_simulation.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <string.h>
+
+#include "test_main.h"
+#include "test_simulation.h"
+#include "simulation.h"
+#include "intersection.h"
+#include "fleet.h"
+#include "sweep.h"
+
+#define TEST_SIM_DURATION       20000
+#define TEST_SIM_MAX_CHANGES    64
+#define TEST_SIM_FLEET_SIZE     70
+
+//observable light state of an intersection
+typedef struct testsnapshot
+{
+    uint64_t lamps;
+    intState_t state;
+    uint8_t step1;
+    uint8_t step2;
+} testSnapshot_t;
+
+//light changes seen by a handler
+typedef struct testchanges
+{
+    testSnapshot_t last;
+    uint64_t times[TEST_SIM_MAX_CHANGES];
+    uint32_t count;
+} testChanges_t;
+
+static intersection_t intersection;
+
+static void test_SIM_run(void **state);
+static void test_SIM_polling(void **state);
+static void test_SIM_runSweep(void **state);
+
+static testSnapshot_t getSnapshot(const intersection_t* intersection)
+{
+    testSnapshot_t snapshot = {.lamps = INT_getLampsCtx(intersection), .state = intersection->state, .step1 = 0xFF, .step2 = 0xFF};
+    
+    if(intersection->sets.set1)
+    {
+        snapshot.step1 = intersection->sets.set1->currentStep;
+    }
+    if(intersection->sets.set2)
+    {
+        snapshot.step2 = intersection->sets.set2->currentStep;
+    }
+    
+    return snapshot;
+}
+
+static void MOCK_simHandler(const intersection_t* intersection, uint64_t millis, void* arg)
+{
+    testChanges_t* changes = arg;
+    testSnapshot_t snapshot = getSnapshot(intersection);
+    
+    bool changed = (snapshot.lamps != changes->last.lamps) || (snapshot.state != changes->last.state) ||
+                   (snapshot.step1 != changes->last.step1) || (snapshot.step2 != changes->last.step2);
+    
+    if(changed && (changes->count < TEST_SIM_MAX_CHANGES))
+    {
+        changes->times[changes->count++] = millis;
+    }
+    changes->last = snapshot;
+}
+
+int test_simulation(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_SIM_run),
+        cmocka_unit_test(test_SIM_polling),
+        cmocka_unit_test(test_SIM_runSweep),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t SIM_run(intersection_t* intersection, uint64_t start, uint64_t duration, simHandler_t handler, void* arg, simStats_t* stats)
+static void test_SIM_run(void **state)
+{
+    (void)state;
+    simStats_t stats;
+    
+    //invalid arguments
+    assert_int_equal(SIM_run(NULL, 0, 1000, NULL, NULL, &stats), ERR_nullPtr);
+    assert_int_equal(SIM_run(&intersection, 0, 1000, NULL, NULL, NULL), ERR_nullPtr);
+    assert_int_equal(SIM_run(&intersection, 1, UINT64_MAX, NULL, NULL, &stats), ERR_value);
+    
+    //direction change and first step in the same mS, then 3 more steps per 4 second cycle;
+    //the clock that turns the intersection on changes no step
+    intersection = (intersection_t)INTERSECTION_INIT;
+    assert_int_equal(INT_initCtx(&intersection, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(SIM_run(&intersection, 1000, 12000, NULL, NULL, &stats), ERR_success);
+    assert_int_equal(stats.millis, 13000);
+    assert_int_equal(stats.toggles, 3);
+    assert_int_equal(stats.changes, 13);
+    assert_int_equal(stats.clocks, 14);
+    assert_int_equal(intersection.state, IS_ew);
+}
+
+//virtual clock produces exactly the light changes of a polling loop
+static void test_SIM_polling(void **state)
+{
+    (void)state;
+    const char* paths[] = {TEST_CFG1_PATH, TEST_CFG3_PATH};
+    testChanges_t polled;
+    testChanges_t simulated;
+    simStats_t stats;
+    
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        memset(&polled, 0, sizeof(polled));
+        memset(&simulated, 0, sizeof(simulated));
+        
+        intersection = (intersection_t)INTERSECTION_INIT;
+        assert_int_equal(INT_initCtx(&intersection, (char*)paths[i]), ERR_success);
+        polled.last = getSnapshot(&intersection);
+        for(uint64_t millis = 0; millis <= TEST_SIM_DURATION; millis++)
+        {
+            //a polling loop clocks many times per mS
+            for(uint8_t clocks = 0; clocks < FLT_MAX_CLOCKS_PER_TICK; clocks++)
+            {
+                INT_clockCtx(&intersection, millis);
+                MOCK_simHandler(&intersection, millis, &polled);
+            }
+        }
+        
+        intersection = (intersection_t)INTERSECTION_INIT;
+        assert_int_equal(INT_initCtx(&intersection, (char*)paths[i]), ERR_success);
+        simulated.last = getSnapshot(&intersection);
+        assert_int_equal(SIM_run(&intersection, 0, TEST_SIM_DURATION, MOCK_simHandler, &simulated, &stats), ERR_success);
+        
+        assert_true(polled.count > 4);
+        assert_int_equal(simulated.count, polled.count);
+        assert_memory_equal(simulated.times, polled.times, polled.count * sizeof(uint64_t));
+    }
+}
+
+//error_t SIM_runSweep(sweepFleet_t* fleet, uint64_t start, uint64_t duration, simStats_t* stats)
+static void test_SIM_runSweep(void **state)
+{
+    (void)state;
+    const char* paths[] = {TEST_CFG1_PATH, TEST_CFG3_PATH};
+    sweepFleet_t fleet;
+    simStats_t expected;
+    simStats_t stats;
+    
+    //invalid arguments
+    assert_int_equal(SIM_runSweep(NULL, 0, 1000, &stats), ERR_nullPtr);
+    assert_int_equal(SIM_runSweep(&fleet, 0, 1000, NULL), ERR_nullPtr);
+    assert_int_equal(SIM_runSweep(&fleet, 1, UINT64_MAX, &stats), ERR_value);
+    
+    //every intersection in the fleet changes exactly as a lone intersection does
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        intersection = (intersection_t)INTERSECTION_INIT;
+        assert_int_equal(INT_initCtx(&intersection, (char*)paths[i]), ERR_success);
+        assert_int_equal(SWP_init(&fleet, &intersection.config, TEST_SIM_FLEET_SIZE, 1000), ERR_success);
+        assert_int_equal(SIM_run(&intersection, 1000, TEST_SIM_DURATION, NULL, NULL, &expected), ERR_success);
+        assert_int_equal(SIM_runSweep(&fleet, 1000, TEST_SIM_DURATION, &stats), ERR_success);
+        
+        assert_int_equal(stats.millis, 1000 + TEST_SIM_DURATION);
+        assert_int_equal(stats.changes, expected.changes * TEST_SIM_FLEET_SIZE);
+        assert_int_equal(stats.clocks, expected.clocks * TEST_SIM_FLEET_SIZE);
+        assert_int_equal(stats.toggles, expected.toggles * TEST_SIM_FLEET_SIZE);
+        assert_int_equal(fleet.direction[TEST_SIM_FLEET_SIZE - 1], intersection.state);
+        SWP_close(&fleet);
+    }
+}
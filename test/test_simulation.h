@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_simulation.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_SIMULATION_H_
+#define _TEST_SIMULATION_H_
+
+int test_simulation(void);
+
+
+#endif //_TEST_SIMULATION_H_
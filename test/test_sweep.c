@@ -0,0 +1,258 @@
+/***************************************************************************************
+ * @file    test_sweep.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "test_main.h"
+#include "test_sweep.h"
+#include "sweep.h"
+#include "fleet.h"
+#include "intersection.h"
+
+#define TEST_SWEEP_SIZE         3
+#define TEST_SWEEP_DURATION     40000
+#define TEST_MASK_MAX           200
+
+extern void* (*sweepCalloc_ptr)(size_t, size_t);   //function ptr for mocking
+uint64_t dueMaskScalar(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+#ifdef SWP_X86_KERNELS
+uint64_t dueMaskSse42(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+uint64_t dueMaskAvx2(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask);
+#endif
+
+static sweepFleet_t fleet;
+static intersection_t intersection;
+static histogram_t stepLateness;
+static histogram_t ownLateness[TEST_SWEEP_SIZE];
+
+static void test_SWP_init(void **state);
+static void test_SWP_tick(void **state);
+static void test_SWP_dueMask(void **state);
+static void test_SWP_getSetState(void **state);
+
+static void* MOCK_calloc(size_t num, size_t size)
+{
+    (void)num;
+    (void)size;
+    
+    return NULL;
+}
+
+static void checkKernel(swpKernel_t kernel)
+{
+    uint64_t expiry[TEST_MASK_MAX];
+    uint64_t mask[SWP_MASK_WORDS(TEST_MASK_MAX) + 1];
+    uint64_t earliest;
+    uint64_t expected;
+    uint64_t now = 1000;
+    
+    //values either side of now and of the sign bit
+    for(uint32_t i = 0; i < TEST_MASK_MAX; i++)
+    {
+        switch(i % 7)
+        {
+            case 0: expiry[i] = 0; break;
+            case 1: expiry[i] = now; break;
+            case 2: expiry[i] = now + 1 + i; break;
+            case 3: expiry[i] = UINT64_MAX; break;
+            case 4: expiry[i] = (UINT64_C(1) << 63) + i; break;
+            case 5: expiry[i] = now - 1; break;
+            default: expiry[i] = now + 5000 - i; break;
+        }
+    }
+    
+    for(uint32_t count = 0; count <= TEST_MASK_MAX; count++)
+    {
+        memset(mask, 0xFF, sizeof(mask));
+        earliest = kernel(expiry, count, now, mask);
+        
+        expected = UINT64_MAX;
+        for(uint32_t i = 0; i < SWP_MASK_WORDS(count) * SWP_WORD_BITS; i++)
+        {
+            assert_int_equal((mask[i / SWP_WORD_BITS] >> (i % SWP_WORD_BITS)) & 1, (i < count) && (expiry[i] <= now));
+            if((i < count) && (expiry[i] > now) && (expiry[i] < expected))
+            {
+                expected = expiry[i];
+            }
+        }
+        assert_int_equal(earliest, expected);
+        
+        //words past the column are untouched
+        assert_int_equal(mask[SWP_MASK_WORDS(count)], UINT64_MAX);
+    }
+}
+
+int test_sweep(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_SWP_init),
+        cmocka_unit_test(test_SWP_tick),
+        cmocka_unit_test(test_SWP_dueMask),
+        cmocka_unit_test(test_SWP_getSetState),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t SWP_init(sweepFleet_t* fleet, const intConfig_t* config, uint32_t count, uint64_t now)
+static void test_SWP_init(void **state)
+{
+    (void)state;
+    intConfig_t unused = {.lightSets = UNUSED_CONFIG};
+    
+    intersection = (intersection_t)INTERSECTION_INIT;
+    assert_int_equal(INT_initCtx(&intersection, TEST_CFG1_PATH), ERR_success);
+    
+    //invalid arguments
+    assert_int_equal(SWP_init(NULL, &intersection.config, TEST_SWEEP_SIZE, 0), ERR_nullPtr);
+    assert_int_equal(SWP_init(&fleet, NULL, TEST_SWEEP_SIZE, 0), ERR_nullPtr);
+    assert_int_equal(SWP_init(&fleet, &unused, TEST_SWEEP_SIZE, 0), ERR_value);
+    
+    //allocation failure
+    sweepCalloc_ptr = MOCK_calloc;
+    assert_int_equal(SWP_init(&fleet, &intersection.config, TEST_SWEEP_SIZE, 0), ERR_mem);
+    sweepCalloc_ptr = calloc;
+    assert_null(fleet.nextExpiry);
+    assert_null(fleet.steps[ID_north]);
+    assert_int_equal(fleet.count, 0);
+    
+    //every intersection off and due, from the lead-in before the first steps
+    assert_int_equal(SWP_init(&fleet, &intersection.config, TEST_SWEEP_SIZE, 1000), ERR_success);
+    assert_int_equal(fleet.count, TEST_SWEEP_SIZE);
+    assert_int_equal(fleet.earliest, 1000);
+    for(uint32_t i = 0; i < TEST_SWEEP_SIZE; i++)
+    {
+        assert_int_equal(fleet.direction[i], IS_off);
+        assert_int_equal(fleet.nextExpiry[i], 0);
+        assert_int_equal(fleet.steps[ID_east][i], intersection.config.lightSets[ID_east].pattern->count);
+    }
+    SWP_close(&fleet);
+    assert_null(fleet.nextExpiry);
+    
+    //empty fleet
+    assert_int_equal(SWP_init(&fleet, &intersection.config, 0, 0), ERR_success);
+    assert_int_equal(SWP_tick(&fleet, 0), 0);
+    assert_int_equal(fleet.earliest, UINT64_MAX);
+    SWP_close(&fleet);
+}
+
+//uint32_t SWP_tick(sweepFleet_t* fleet, uint64_t millis)
+static void test_SWP_tick(void **state)
+{
+    (void)state;
+    const char* paths[] = {TEST_CFG1_PATH, TEST_CFG3_PATH};
+    uint64_t deadline;
+    uint64_t millis;
+    uint32_t clocked;
+    
+    for(uint8_t p = 0; p < 2; p++)
+    {
+        intersection = (intersection_t)INTERSECTION_INIT;
+        HIST_reset(&stepLateness);
+        intersection.sets.lateness = &stepLateness;
+        assert_int_equal(INT_initCtx(&intersection, (char*)paths[p]), ERR_success);
+        assert_int_equal(SWP_init(&fleet, &intersection.config, TEST_SWEEP_SIZE, 0), ERR_success);
+        SWP_attachLateness(&fleet, ownLateness);
+        deadline = INT_nextDeadlineCtx(&intersection);
+        
+        //irregular ticks with one gap long enough to resync, clock every intersection as a fleet_t would
+        for(millis = 0; millis <= TEST_SWEEP_DURATION; millis += (millis == 10000) ? 12000 : 1 + millis % 3)
+        {
+            clocked = SWP_tick(&fleet, millis);
+            if(deadline <= millis)
+            {
+                deadline = FLT_clockDue(&intersection, millis);
+                assert_int_equal(clocked, TEST_SWEEP_SIZE);
+            }
+            else
+            {
+                assert_int_equal(clocked, 0);
+            }
+            
+            for(uint32_t i = 0; i < TEST_SWEEP_SIZE; i++)
+            {
+                assert_int_equal(fleet.direction[i], intersection.state);
+                assert_int_equal(fleet.nextExpiry[i], deadline);
+                assert_int_equal(fleet.cycleStart[i], intersection.sets.cycleStartTime);
+                for(intDirection_t dir = 0; dir < ID_numDirections; dir++)
+                {
+                    assert_int_equal(fleet.steps[dir][i], intersection.lightSets[dir].currentStep);
+                }
+            }
+            assert_int_equal(fleet.earliest, deadline);
+        }
+        
+        assert_true(fleet.toggles >= 2 * TEST_SWEEP_SIZE);
+        assert_true(intersection.resyncs > 0);
+        assert_int_equal(fleet.resyncs, intersection.resyncs * TEST_SWEEP_SIZE);
+        assert_int_equal(fleet.lateness.total, stepLateness.total * TEST_SWEEP_SIZE);
+        assert_int_equal(fleet.lateness.max, stepLateness.max);
+        for(uint32_t i = 0; i < TEST_SWEEP_SIZE; i++)
+        {
+            assert_int_equal(ownLateness[i].total, stepLateness.total);
+            assert_int_equal(ownLateness[i].max, stepLateness.max);
+        }
+        SWP_close(&fleet);
+    }
+    
+    //only the due intersection is clocked
+    intersection = (intersection_t)INTERSECTION_INIT;
+    assert_int_equal(INT_initCtx(&intersection, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(SWP_init(&fleet, &intersection.config, TEST_SWEEP_SIZE, 1000), ERR_success);
+    assert_int_equal(SWP_tick(&fleet, 1000), TEST_SWEEP_SIZE);
+    assert_int_equal(fleet.earliest, 3000);
+    fleet.cycleStart[1] = 1500;
+    fleet.nextExpiry[1] = 3500;
+    assert_int_equal(SWP_tick(&fleet, 3000), TEST_SWEEP_SIZE - 1);
+    assert_int_equal(fleet.steps[ID_north][0], 1);
+    assert_int_equal(fleet.steps[ID_north][1], 0);
+    assert_int_equal(fleet.earliest, 3500);
+    assert_int_equal(SWP_tick(&fleet, 3500), 1);
+    assert_int_equal(fleet.steps[ID_north][1], 1);
+    SWP_close(&fleet);
+}
+
+//uint64_t SWP_dueMask(const uint64_t* expiry, uint32_t count, uint64_t now, uint64_t* mask)
+static void test_SWP_dueMask(void **state)
+{
+    (void)state;
+    
+    //every kernel the CPU can run agrees with the definition
+    checkKernel(SWP_dueMask);
+    checkKernel(dueMaskScalar);
+#ifdef SWP_X86_KERNELS
+    if(__builtin_cpu_supports("sse4.2"))
+    {
+        checkKernel(dueMaskSse42);
+    }
+    if(__builtin_cpu_supports("avx2"))
+    {
+        checkKernel(dueMaskAvx2);
+    }
+#endif
+}
+
+//lightSetState_t SWP_getSetState(const sweepFleet_t* fleet, uint32_t intersection, intDirection_t dir)
+static void test_SWP_getSetState(void **state)
+{
+    (void)state;
+    
+    intersection = (intersection_t)INTERSECTION_INIT;
+    assert_int_equal(INT_initCtx(&intersection, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(SWP_init(&fleet, &intersection.config, TEST_SWEEP_SIZE, 0), ERR_success);
+    
+    //lead-in before the first step, then the first step of the active direction
+    assert_int_equal(SWP_getSetState(&fleet, 0, ID_north), LSS_unused);
+    assert_int_equal(SWP_tick(&fleet, 0), TEST_SWEEP_SIZE);
+    assert_int_equal(SWP_getSetState(&fleet, 0, ID_north), LSS_LUSG);
+    assert_int_equal(SWP_getSetState(&fleet, 2, ID_north), LSS_LUSG);
+    assert_int_equal(SWP_getSetState(&fleet, 0, ID_east), LSS_unused);
+    assert_int_equal(SWP_tick(&fleet, 2000), TEST_SWEEP_SIZE);
+    assert_int_equal(SWP_getSetState(&fleet, 1, ID_north), LSS_LYSY);
+    SWP_close(&fleet);
+}
@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_sweep.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_SWEEP_H_
+#define _TEST_SWEEP_H_
+
+int test_sweep(void);
+
+
+#endif //_TEST_SWEEP_H_
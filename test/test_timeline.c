@@ -0,0 +1,144 @@
+/***************************************************************************************
+ * @file    test_timeline.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include "test_main.h"
+#include "test_timeline.h"
+#include "timeline.h"
+#include "intersection.h"
+#include "fleet.h"
+
+#define TEST_TL_CYCLES      3   //cycles compared against the state machine
+
+static timeline_t timeline;
+static intersection_t intersection;
+
+static void test_TL_compile(void **state);
+static void test_TL_lookup(void **state);
+static void test_stateMachine(void **state);
+
+int test_timeline(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_TL_compile),
+        cmocka_unit_test(test_TL_lookup),
+        cmocka_unit_test(test_stateMachine),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t TL_compile(timeline_t* timeline, const intConfig_t* config)
+static void test_TL_compile(void **state)
+{
+    (void)state;
+    intConfig_t config = {.lightSets = UNUSED_CONFIG};
+    const uint64_t offsets[] = {0, 2000, 3000, 4000, 6000, 7000};
+    const setPattern_t endless = {.offsets = (const uint32_t[]){2000}, .states = (const uint8_t[]){LSS_LRSR}, .count = 1};
+    
+    //invalid arguments
+    assert_int_equal(TL_compile(NULL, &config), ERR_nullPtr);
+    assert_int_equal(TL_compile(&timeline, NULL), ERR_nullPtr);
+    
+    //nothing to compile
+    assert_int_equal(TL_compile(&timeline, &config), ERR_value);
+    
+    //pattern without an end step
+    config.lightSets[ID_north].pattern = &endless;
+    assert_int_equal(TL_compile(&timeline, &config), ERR_format);
+    
+    //one used set per direction
+    assert_int_equal(CFG_init(&config, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(TL_compile(&timeline, &config), ERR_success);
+    assert_int_equal(timeline.cycleLength, 8000);
+    assert_int_equal(timeline.count, 6);
+    assert_memory_equal(timeline.offsets, offsets, sizeof(offsets));
+    assert_int_equal(timeline.entries[0].state, IS_ns);
+    assert_int_equal(timeline.entries[0].setStates[ID_north], LSS_LUSG);
+    assert_int_equal(timeline.entries[0].setStates[ID_south], LSS_end);
+    assert_int_equal(timeline.entries[0].setStates[ID_east], LSS_end);
+    assert_int_equal(timeline.entries[0].lamps[ID_north][0], LS_yellowArrow);
+    assert_int_equal(timeline.entries[0].lamps[ID_east][0], LS_red);
+    assert_int_equal(timeline.entries[0].lamps[ID_south][0], LS_off);
+    assert_int_equal(timeline.entries[3].state, IS_ew);
+    assert_int_equal(timeline.entries[3].setStates[ID_east], LSS_LUSG);
+    assert_int_equal(timeline.entries[3].setStates[ID_north], LSS_end);
+    
+    //sets with different end times hold their end state until the later one
+    assert_int_equal(CFG_init(&config, TEST_CFG1_PATH), ERR_success);
+    assert_int_equal(TL_compile(&timeline, &config), ERR_success);
+    assert_int_equal(timeline.cycleLength, 7000 + 7890);
+    assert_int_equal(timeline.offsets[timeline.count - 1], 7000 + 7777);
+    assert_int_equal(timeline.entries[timeline.count - 1].setStates[ID_east], LSS_end);
+    assert_int_not_equal(timeline.entries[timeline.count - 1].setStates[ID_west], LSS_end);
+}
+
+//const tlEntry_t* TL_lookup(const timeline_t* timeline, uint64_t origin, uint64_t millis)
+static void test_TL_lookup(void **state)
+{
+    (void)state;
+    intConfig_t config = {.lightSets = UNUSED_CONFIG};
+    
+    //invalid arguments
+    assert_null(TL_lookup(NULL, 0, 0));
+    timeline.count = 0;
+    assert_null(TL_lookup(&timeline, 0, 0));
+    
+    assert_int_equal(CFG_init(&config, TEST_CFG3_PATH), ERR_success);
+    assert_int_equal(TL_compile(&timeline, &config), ERR_success);
+    
+    //entry boundaries
+    assert_ptr_equal(TL_lookup(&timeline, 1000, 1000), &timeline.entries[0]);
+    assert_ptr_equal(TL_lookup(&timeline, 1000, 2999), &timeline.entries[0]);
+    assert_ptr_equal(TL_lookup(&timeline, 1000, 3000), &timeline.entries[1]);
+    assert_ptr_equal(TL_lookup(&timeline, 1000, 8999), &timeline.entries[5]);
+    
+    //later cycles and times before the origin
+    assert_ptr_equal(TL_lookup(&timeline, 1000, 1000 + (1000000 * 8000ULL) + 4000), &timeline.entries[3]);
+    assert_ptr_equal(TL_lookup(&timeline, 1000, 0), &timeline.entries[0]);
+}
+
+//timeline matches the intersection state machine at every mS
+static void test_stateMachine(void **state)
+{
+    (void)state;
+    char* paths[] = {NULL, TEST_CFG1_PATH, TEST_CFG3_PATH};
+    const tlEntry_t* entry;
+    const packedSet_t* set;
+    
+    for(uint8_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+    {
+        intersection = (intersection_t)INTERSECTION_INIT;
+        assert_int_equal(INT_initCtx(&intersection, paths[i]), ERR_success);
+        assert_int_equal(TL_compile(&timeline, &intersection.config), ERR_success);
+        
+        for(uint64_t millis = 0; millis < TEST_TL_CYCLES * timeline.cycleLength; millis++)
+        {
+            //a polling loop clocks many times per mS
+            for(uint8_t clocks = 0; clocks < FLT_MAX_CLOCKS_PER_TICK; clocks++)
+            {
+                INT_clockCtx(&intersection, millis);
+            }
+            
+            entry = TL_lookup(&timeline, 0, millis);
+            assert_int_equal(entry->state, intersection.state);
+            assert_false(INT_lampsConflict(INT_getLampsCtx(&intersection)));
+            for(uint8_t direction = 0; direction < INT_DIRECTIONS; direction++)
+            {
+                set = &intersection.lightSets[direction];
+                if(((set == intersection.sets.set1) || (set == intersection.sets.set2)) && set->pattern->count)
+                {
+                    assert_int_equal(entry->setStates[direction], SET_getStepState(set->pattern, set->currentStep));
+                }
+                for(uint8_t light = 0; (light < MAX_LIGHTS_IN_SET) && (SET_getLampType(set, light) != LDT_unused); light++)
+                {
+                    assert_int_equal(entry->lamps[direction][light], SET_getLamp(set, light));
+                    assert_int_equal(SET_getBoardLamp(INT_getLampsCtx(&intersection), direction, light), SET_getLamp(set, light));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_timeline.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_TIMELINE_H_
+#define _TEST_TIMELINE_H_
+
+int test_timeline(void);
+
+
+#endif //_TEST_TIMELINE_H_
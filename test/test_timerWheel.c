@@ -0,0 +1,202 @@
+/***************************************************************************************
+ * @file    test_timerWheel.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include "test_main.h"
+#include "test_timerWheel.h"
+#include "timerWheel.h"
+
+static timerWheel_t wheel;
+static uint64_t expiredAt[4];
+static uint8_t expiredCount = 0;
+static bool reschedule = false;
+
+static void test_TW_init(void **state);
+static void test_TW_schedule(void **state);
+static void test_TW_cancel(void **state);
+static void test_TW_advance(void **state);
+static void test_cascade(void **state);
+
+static void MOCK_expireHandler(twNode_t* node, uint64_t millis, void* arg)
+{
+    (void)arg;
+    
+    if(expiredCount < 4)
+    {
+        expiredAt[expiredCount] = millis;
+    }
+    expiredCount++;
+    
+    //reschedule into the past once
+    if(reschedule)
+    {
+        reschedule = false;
+        TW_schedule(&wheel, node, 0);
+    }
+}
+
+int test_timerWheel(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_TW_init),
+        cmocka_unit_test(test_TW_schedule),
+        cmocka_unit_test(test_TW_cancel),
+        cmocka_unit_test(test_TW_advance),
+        cmocka_unit_test(test_cascade),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//void TW_init(timerWheel_t* wheel, uint64_t now)
+static void test_TW_init(void **state)
+{
+    (void)state;
+    
+    TW_init(&wheel, 1234);
+    assert_int_equal(wheel.now, 1234);
+    assert_int_equal(wheel.count, 0);
+    for(uint8_t level = 0; level < TW_LEVELS; level++)
+    {
+        assert_ptr_equal(wheel.slots[level][0].next, &wheel.slots[level][0]);
+        assert_ptr_equal(wheel.slots[level][TW_SLOT_MASK].prev, &wheel.slots[level][TW_SLOT_MASK]);
+    }
+}
+
+//void TW_schedule(timerWheel_t* wheel, twNode_t* node, uint64_t expiry)
+static void test_TW_schedule(void **state)
+{
+    (void)state;
+    twNode_t node1 = {0};
+    twNode_t node2 = {0};
+    
+    TW_init(&wheel, 1000);
+    assert_false(TW_isScheduled(&node1));
+    
+    //level chosen by distance from now
+    TW_schedule(&wheel, &node1, 1000 + 10);
+    assert_true(TW_isScheduled(&node1));
+    assert_int_equal(wheel.count, 1);
+    assert_ptr_equal(wheel.slots[0][(1000 + 10) & TW_SLOT_MASK].next, &node1);
+    TW_schedule(&wheel, &node2, 1000 + 70000);
+    assert_int_equal(wheel.count, 2);
+    assert_ptr_equal(wheel.slots[2][((1000 + 70000) >> 16) & TW_SLOT_MASK].next, &node2);
+    
+    //rescheduling moves the timer
+    TW_schedule(&wheel, &node1, 1000 + 300);
+    assert_int_equal(wheel.count, 2);
+    assert_ptr_equal(wheel.slots[0][(1000 + 10) & TW_SLOT_MASK].next, &wheel.slots[0][(1000 + 10) & TW_SLOT_MASK]);
+    assert_ptr_equal(wheel.slots[1][((1000 + 300) >> 8) & TW_SLOT_MASK].next, &node1);
+    assert_int_equal(node1.expiry, 1000 + 300);
+    
+    //overdue timers go in the current slot
+    TW_schedule(&wheel, &node1, 5);
+    assert_ptr_equal(wheel.slots[0][1000 & TW_SLOT_MASK].next, &node1);
+    assert_int_equal(node1.expiry, 5);
+    
+    //timers beyond the wheel's span are parked in the top level
+    TW_schedule(&wheel, &node2, 1000 + TW_MAX_DELTA + 12345);
+    assert_ptr_equal(wheel.slots[TW_LEVELS - 1][((1000 + TW_MAX_DELTA) >> 24) & TW_SLOT_MASK].next, &node2);
+    assert_int_equal(node2.expiry, 1000 + TW_MAX_DELTA + 12345);
+}
+
+//void TW_cancel(timerWheel_t* wheel, twNode_t* node)
+static void test_TW_cancel(void **state)
+{
+    (void)state;
+    twNode_t node1 = {0};
+    twNode_t node2 = {0};
+    
+    TW_init(&wheel, 0);
+    TW_schedule(&wheel, &node1, 10);
+    TW_schedule(&wheel, &node2, 10);
+    
+    //cancelled timer is unlinked
+    TW_cancel(&wheel, &node1);
+    assert_false(TW_isScheduled(&node1));
+    assert_int_equal(wheel.count, 1);
+    assert_ptr_equal(wheel.slots[0][10].next, &node2);
+    assert_ptr_equal(wheel.slots[0][10].prev, &node2);
+    
+    //cancelling twice does nothing
+    TW_cancel(&wheel, &node1);
+    assert_int_equal(wheel.count, 1);
+    
+    //cancelled timer does not expire
+    expiredCount = 0;
+    TW_cancel(&wheel, &node2);
+    assert_int_equal(TW_advance(&wheel, 20, MOCK_expireHandler, NULL), 0);
+    assert_int_equal(expiredCount, 0);
+}
+
+//uint32_t TW_advance(timerWheel_t* wheel, uint64_t millis, twExpireHandler_t handler, void* arg)
+static void test_TW_advance(void **state)
+{
+    (void)state;
+    twNode_t node1 = {0};
+    twNode_t node2 = {0};
+    
+    TW_init(&wheel, 100);
+    TW_schedule(&wheel, &node1, 150);
+    TW_schedule(&wheel, &node2, 150);
+    expiredCount = 0;
+    
+    //not yet expired
+    assert_int_equal(TW_advance(&wheel, 149, MOCK_expireHandler, NULL), 0);
+    assert_int_equal(wheel.now, 150);
+    assert_int_equal(wheel.count, 2);
+    
+    //both expire in the same mS
+    assert_int_equal(TW_advance(&wheel, 150, MOCK_expireHandler, NULL), 2);
+    assert_int_equal(expiredAt[0], 150);
+    assert_int_equal(expiredAt[1], 150);
+    assert_false(TW_isScheduled(&node1));
+    assert_int_equal(wheel.count, 0);
+    
+    //empty wheel skips ahead
+    assert_int_equal(TW_advance(&wheel, 1000000, MOCK_expireHandler, NULL), 0);
+    assert_int_equal(wheel.now, 1000001);
+    
+    //rescheduling into the past fires in the next mS
+    expiredCount = 0;
+    reschedule = true;
+    TW_schedule(&wheel, &node1, 1000001);
+    assert_int_equal(TW_advance(&wheel, 1000001, MOCK_expireHandler, NULL), 1);
+    assert_true(TW_isScheduled(&node1));
+    assert_int_equal(TW_advance(&wheel, 1000002, MOCK_expireHandler, NULL), 1);
+    assert_int_equal(expiredAt[1], 1000002);
+    
+    //several mS processed in one advance
+    expiredCount = 0;
+    TW_schedule(&wheel, &node1, 1000010);
+    TW_schedule(&wheel, &node2, 1000020);
+    assert_int_equal(TW_advance(&wheel, 1000030, MOCK_expireHandler, NULL), 2);
+    assert_int_equal(expiredAt[0], 1000010);
+    assert_int_equal(expiredAt[1], 1000020);
+}
+
+//void cascade(timerWheel_t* wheel, uint8_t level)
+static void test_cascade(void **state)
+{
+    (void)state;
+    twNode_t nodes[3] = {{0}};
+    uint64_t expiries[3] = {250 + 300, 250 + 70000, 250 + 20000000};
+    
+    //timers in every level expire exactly on time, across level boundaries
+    TW_init(&wheel, 250);
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        TW_schedule(&wheel, &nodes[i], expiries[i]);
+    }
+    expiredCount = 0;
+    for(uint8_t i = 0; i < 3; i++)
+    {
+        assert_int_equal(TW_advance(&wheel, expiries[i] - 1, MOCK_expireHandler, NULL), 0);
+        assert_int_equal(TW_advance(&wheel, expiries[i], MOCK_expireHandler, NULL), 1);
+        assert_int_equal(expiredAt[i], expiries[i]);
+    }
+    assert_int_equal(wheel.count, 0);
+}
@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_timerWheel.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_TIMERWHEEL_H_
+#define _TEST_TIMERWHEEL_H_
+
+int test_timerWheel(void);
+
+
+#endif //_TEST_TIMERWHEEL_H_
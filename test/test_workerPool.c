@@ -0,0 +1,207 @@
+/***************************************************************************************
+ * @file    test_workerPool.c
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+#include "test_main.h"
+#include "test_workerPool.h"
+#include "workerPool.h"
+#include "intersection.h"
+
+#define TEST_POOL_SIZE      4
+
+extern void* (*calloc_ptr)(size_t, size_t);     //function ptr for mocking
+intersection_t* takeDue(worker_t* worker);
+intersection_t* stealDue(worker_t* worker);
+
+static workerPool_t pool;
+static intersection_t intersections[TEST_POOL_SIZE];
+
+static void test_WRK_init(void **state);
+static void test_WRK_tick(void **state);
+static void test_WRK_getStats(void **state);
+static void test_WRK_getLateness(void **state);
+static void test_stealDue(void **state);
+
+static void* MOCK_calloc(size_t num, size_t size)
+{
+    (void)num;
+    (void)size;
+    
+    return NULL;
+}
+
+static void initIntersections(void)
+{
+    for(uint8_t i = 0; i < TEST_POOL_SIZE; i++)
+    {
+        intersections[i] = (intersection_t)INTERSECTION_INIT;
+        assert_int_equal(INT_initCtx(&intersections[i], (i % 2) ? TEST_CFG3_PATH : TEST_CFG1_PATH), ERR_success);
+    }
+}
+
+int test_workerPool(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_WRK_init),
+        cmocka_unit_test(test_WRK_tick),
+        cmocka_unit_test(test_WRK_getStats),
+        cmocka_unit_test(test_WRK_getLateness),
+        cmocka_unit_test(test_stealDue),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+//error_t WRK_init(workerPool_t* pool, intersection_t* intersections, uint32_t count, uint8_t numWorkers, uint64_t now)
+static void test_WRK_init(void **state)
+{
+    (void)state;
+    
+    initIntersections();
+    
+    //invalid arguments
+    assert_int_equal(WRK_init(NULL, intersections, TEST_POOL_SIZE, 2, 0), ERR_nullPtr);
+    assert_int_equal(WRK_init(&pool, NULL, TEST_POOL_SIZE, 2, 0), ERR_nullPtr);
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 0, 0), ERR_value);
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, WRK_MAX_WORKERS + 1, 0), ERR_value);
+    
+    //allocation failure
+    calloc_ptr = MOCK_calloc;
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 2, 0), ERR_mem);
+    calloc_ptr = calloc;
+    assert_null(pool.workers);
+    
+    //intersections shared out between workers
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 2, 1000), ERR_success);
+    assert_int_equal(pool.workers[0].wheel.count, 2);
+    assert_int_equal(pool.workers[1].wheel.count, 2);
+    WRK_close(&pool);
+    assert_null(pool.workers);
+    
+    //more workers than intersections
+    assert_int_equal(WRK_init(&pool, intersections, 1, 3, 1000), ERR_success);
+    assert_int_equal(pool.workers[0].wheel.count, 1);
+    assert_int_equal(pool.workers[2].wheel.count, 0);
+    WRK_close(&pool);
+}
+
+//uint32_t WRK_tick(workerPool_t* pool, uint64_t millis)
+static void test_WRK_tick(void **state)
+{
+    (void)state;
+    
+    initIntersections();
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 3, 1000), ERR_success);
+    
+    //off intersections start and enter their first step in the first tick
+    assert_int_equal(WRK_tick(&pool, 1000), TEST_POOL_SIZE);
+    for(uint8_t i = 0; i < TEST_POOL_SIZE; i++)
+    {
+        assert_int_equal(intersections[i].state, IS_ns);
+        assert_int_equal(intersections[i].sets.set1->currentStep, 0);
+        assert_int_equal(intersections[i].timer.expiry, 3000);
+    }
+    
+    //nothing due
+    assert_int_equal(WRK_tick(&pool, 2999), 0);
+    
+    //every intersection rescheduled into its owner's wheel
+    assert_int_equal(WRK_tick(&pool, 3000), TEST_POOL_SIZE);
+    assert_int_equal(pool.workers[0].wheel.count, 2);
+    assert_int_equal(pool.workers[1].wheel.count, 1);
+    assert_int_equal(pool.workers[2].wheel.count, 1);
+    for(uint8_t i = 0; i < TEST_POOL_SIZE; i++)
+    {
+        assert_int_equal(intersections[i].sets.set1->currentStep, 1);
+        assert_true(intersections[i].timer.expiry > 3000);
+    }
+    
+    WRK_close(&pool);
+}
+
+//error_t WRK_getStats(workerPool_t* pool, uint8_t worker, wrkStats_t* stats)
+static void test_WRK_getStats(void **state)
+{
+    (void)state;
+    wrkStats_t stats;
+    uint64_t clocks = 0;
+    
+    initIntersections();
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 2, 1000), ERR_success);
+    assert_int_equal(WRK_tick(&pool, 1000), TEST_POOL_SIZE);
+    assert_int_equal(WRK_tick(&pool, 3000), TEST_POOL_SIZE);
+    
+    //invalid arguments
+    assert_int_equal(WRK_getStats(NULL, 0, &stats), ERR_nullPtr);
+    assert_int_equal(WRK_getStats(&pool, 0, NULL), ERR_nullPtr);
+    assert_int_equal(WRK_getStats(&pool, 2, &stats), ERR_value);
+    
+    //every clock accounted for, whichever worker ran it
+    for(uint8_t i = 0; i < 2; i++)
+    {
+        assert_int_equal(WRK_getStats(&pool, i, &stats), ERR_success);
+        assert_true(stats.busyNs <= stats.totalNs);
+        assert_true(stats.steals <= stats.clocks);
+        clocks += stats.clocks;
+    }
+    assert_int_equal(clocks, 2 * TEST_POOL_SIZE);
+    
+    WRK_close(&pool);
+    assert_int_equal(WRK_getStats(&pool, 0, &stats), ERR_nullPtr);
+}
+
+//void WRK_getLateness(workerPool_t* pool, histogram_t* lateness)
+static void test_WRK_getLateness(void **state)
+{
+    (void)state;
+    histogram_t lateness;
+    histogram_t own[TEST_POOL_SIZE];
+    
+    initIntersections();
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 2, 1000), ERR_success);
+    WRK_attachLateness(&pool, own);
+    assert_int_equal(WRK_tick(&pool, 1000), TEST_POOL_SIZE);
+    assert_int_equal(WRK_tick(&pool, 3004), TEST_POOL_SIZE);
+    
+    //two step changes for each cfg1 intersection, one for each cfg3 intersection
+    WRK_getLateness(&pool, &lateness);
+    assert_int_equal(lateness.total, 6);
+    assert_int_equal(lateness.counts[4], 6);
+    assert_int_equal(lateness.max, 4);
+    for(uint32_t i = 0; i < TEST_POOL_SIZE; i++)
+    {
+        assert_int_equal(own[i].total, (i % 2) ? 1 : 2);
+        assert_int_equal(own[i].max, 4);
+    }
+    
+    //no intersection is left pointing at a worker's histogram
+    WRK_close(&pool);
+    for(uint32_t i = 0; i < TEST_POOL_SIZE; i++)
+    {
+        assert_null(intersections[i].sets.lateness);
+    }
+}
+
+//intersection_t* stealDue(worker_t* worker)
+static void test_stealDue(void **state)
+{
+    (void)state;
+    
+    initIntersections();
+    assert_int_equal(WRK_init(&pool, intersections, TEST_POOL_SIZE, 2, 1000), ERR_success);
+    
+    //owner takes from the tail, thieves from the head
+    pool.workers[0].due[0] = &intersections[0];
+    pool.workers[0].due[1] = &intersections[2];
+    pool.workers[0].dueHead = 0;
+    pool.workers[0].dueTail = 2;
+    assert_ptr_equal(stealDue(&pool.workers[1]), &intersections[0]);
+    assert_ptr_equal(takeDue(&pool.workers[0]), &intersections[2]);
+    assert_null(takeDue(&pool.workers[0]));
+    assert_null(stealDue(&pool.workers[1]));
+    
+    WRK_close(&pool);
+}
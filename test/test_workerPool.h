@@ -0,0 +1,15 @@
+/***************************************************************************************
+ * @file    test_workerPool.h
+ * @date    October 18th 2026
+ *
+ * @brief   
+ *
+ ****************************************************************************************/
+
+#ifndef _TEST_WORKERPOOL_H_
+#define _TEST_WORKERPOOL_H_
+
+int test_workerPool(void);
+
+
+#endif //_TEST_WORKERPOOL_H_
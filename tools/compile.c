@@ -0,0 +1,97 @@
+/***************************************************************************************
+ * @file    compile.c
+ * @date    October 18th 2026
+ *
+ * @brief   Offline compiler from JSON intersection configs to a precompiled
+ *          intersection image
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for getopt
+
+#include <unistd.h>
+#include <stdlib.h>
+
+#include "main.h"
+
+#include "config.h"
+#include "image.h"
+
+ /*****************************************************************************
+ ** @brief Print usage
+ **
+ ** @param name: name of the binary
+ **
+ ** @return none
+******************************************************************************/
+static void printUsage(const char* name)
+{
+    printf("Usage: %s -o image config.json [config.json...]\n", name);
+    printf("    -o: image file to write; intersection n of the image is the nth config\n");
+}
+
+/*****************************************************************************
+ ** @brief main function
+ **     Parses every config and writes them to one image
+ **
+ ** @param arguments: image path and config files
+ **
+ ** @return 0 on success, 1 on failure
+******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const intConfig_t unusedConfig = {.lightSets = UNUSED_CONFIG};
+    char* output = NULL;
+    intConfig_t* configs;
+    uint32_t count;
+    int opt;
+    
+    while((opt = getopt(argc, argv, "o:")) != -1)
+    {
+        if(opt == 'o')
+        {
+            output = optarg;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if(!output || (optind >= argc))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    count = (uint32_t)(argc - optind);
+    configs = malloc(count * sizeof(intConfig_t));
+    if(!configs)
+    {
+        printf("Failed to allocate memory for %u configs\n", count);
+        return 1;
+    }
+    
+    //configs start out as they do in the controller, so the image loads to the same result
+    for(uint32_t i = 0; i < count; i++)
+    {
+        configs[i] = unusedConfig;
+        if(CFG_init(&configs[i], argv[optind + i]) != ERR_success)
+        {
+            printf("Failed to compile %s\n", argv[optind + i]);
+            free(configs);
+            return 1;
+        }
+    }
+    
+    if(IMG_write(output, configs, count) != ERR_success)
+    {
+        free(configs);
+        return 1;
+    }
+    
+    printf("Wrote %u intersections to %s (%zu bytes)\n", count, output, IMG_size(count, IMG_countSteps(configs, count)));
+    free(configs);
+    
+    return 0;
+}
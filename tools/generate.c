@@ -0,0 +1,203 @@
+/***************************************************************************************
+ * @file    generate.c
+ * @date    October 18th 2026
+ *
+ * @brief   Build time generator from a JSON intersection config to a C source
+ *          file defining CFG_staticConfig and its patterns, in the shape of
+ *          the DEFAULT_CONFIG and PATTERN_x macros in config.h
+ *
+ ****************************************************************************************/
+#define _POSIX_C_SOURCE 200809L     //necessary for getopt
+
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "main.h"
+
+#include "config.h"
+
+//enum names as written in the generated source, indexed by value
+static const char* const stepStateNames[] = {"LSS_LPSG", "LSS_LPSY", "LSS_LPSR", "LSS_LUSG", "LSS_LUSY", "LSS_LUSR",
+                                             "LSS_LYSG", "LSS_LYSY", "LSS_LYSR", "LSS_LRSG", "LSS_LRSY", "LSS_LRSR",
+                                             "LSS_disable", "LSS_end", "LSS_unused"};
+static const char* const lightMacros[] = {"LIGHT_UNUSED", "LIGHT_SOLID_GRN", "LIGHT_ADV_GRN"};
+static const char directionSuffixes[] = {'N', 'E', 'S', 'W'};
+
+_Static_assert(sizeof(stepStateNames) / sizeof(stepStateNames[0]) == LSS_unused + 1, "step state names out of date");
+_Static_assert(sizeof(lightMacros) / sizeof(lightMacros[0]) == LDT_numTypes, "light macros out of date");
+_Static_assert(sizeof(directionSuffixes) == ID_numDirections, "direction suffixes out of date");
+
+ /*****************************************************************************
+ ** @brief Print usage
+ **
+ ** @param name: name of the binary
+ **
+ ** @return none
+******************************************************************************/
+static void printUsage(const char* name)
+{
+    printf("Usage: %s -o source.c config.json\n", name);
+    printf("    -o: C source file to write\n");
+}
+
+ /*****************************************************************************
+ ** @brief Write pattern
+ **     Write the definition of a pattern as STATIC_PATTERN_x; sets without
+ **     steps share SET_unusedPattern, and sets with the same steps as an
+ **     earlier direction share its definition
+ **
+ ** @param file: generated source
+ ** @param pattern: pattern to write
+ ** @param suffix: direction suffix of the pattern's name
+ ** @param sharedSuffix: direction suffix of the first set with the same
+ **     pattern, suffix if there is none before it
+ **
+ ** @return none
+******************************************************************************/
+static void writePattern(FILE* file, const setPattern_t* pattern, char suffix, char sharedSuffix)
+{
+    if(!pattern->count)
+    {
+        fprintf(file, "#define STATIC_PATTERN_%c        SET_unusedPattern\n", suffix);
+        return;
+    }
+    
+    if(sharedSuffix != suffix)
+    {
+        fprintf(file, "#define STATIC_PATTERN_%c        staticPattern%c\n", suffix, sharedSuffix);
+        return;
+    }
+
+    fprintf(file, "static const setPattern_t staticPattern%c = {.offsets = (const uint32_t[]){", suffix);
+    for(uint8_t i = 0; i < pattern->count; i++)
+    {
+        if(pattern->offsets[i] == SET_OFFSET_END)
+        {
+            fprintf(file, "%sSET_OFFSET_END", i ? ", " : "");
+        }
+        else
+        {
+            fprintf(file, "%sUINT32_C(%" PRIu32 ")", i ? ", " : "", pattern->offsets[i]);
+        }
+    }
+    fprintf(file, "},\n");
+    fprintf(file, "                                          .states = (const uint8_t[]){");
+    for(uint8_t i = 0; i < pattern->count; i++)
+    {
+        fprintf(file, "%s%s", i ? ", " : "", stepStateNames[pattern->states[i]]);
+    }
+    fprintf(file, "},\n");
+    fprintf(file, "                                          .count = %u};\n", pattern->count);
+    fprintf(file, "#define STATIC_PATTERN_%c        staticPattern%c\n", suffix, suffix);
+}
+
+ /*****************************************************************************
+ ** @brief Write source
+ **     Write the generated C source for a config
+ **
+ ** @param file: generated source
+ ** @param config: parsed config
+ ** @param source: path of the JSON config, for the header
+ **
+ ** @return none
+******************************************************************************/
+static void writeSource(FILE* file, const intConfig_t* config, const char* source)
+{
+    const lightSet_t* set;
+    uint8_t shared;
+
+    fprintf(file, "/***************************************************************************************\n");
+    fprintf(file, " * @brief   Generated by njtraffic-generate from %s; do not edit\n", source);
+    fprintf(file, " *\n");
+    fprintf(file, " ****************************************************************************************/\n\n");
+    fprintf(file, "#include \"config.h\"\n\n");
+
+    for(uint8_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        set = &config->lightSets[dir];
+
+        //interning gives sets with the same steps the same pattern
+        shared = 0;
+        while(config->lightSets[shared].pattern != set->pattern)
+        {
+            shared++;
+        }
+        writePattern(file, set->pattern, directionSuffixes[dir], directionSuffixes[shared]);
+
+        fprintf(file, "#define STATIC_LIGHT_SET_%c      {.lights = {", directionSuffixes[dir]);
+        for(uint8_t i = 0; i < MAX_LIGHTS_IN_SET; i++)
+        {
+            fprintf(file, "%s%s", i ? ", " : "", lightMacros[set->lights[i].type]);
+        }
+        fprintf(file, "}, \\\n");
+        fprintf(file, "                                 .pattern = &STATIC_PATTERN_%c, \\\n", directionSuffixes[dir]);
+        fprintf(file, "                                 .currentStep = SET_LEAD_IN}\n\n");
+    }
+
+    fprintf(file, "const intConfig_t CFG_staticConfig = {.lightSets = {");
+    for(uint8_t dir = 0; dir < ID_numDirections; dir++)
+    {
+        fprintf(file, "%sSTATIC_LIGHT_SET_%c", dir ? ", " : "", directionSuffixes[dir]);
+    }
+    fprintf(file, "}};\n");
+}
+
+/*****************************************************************************
+ ** @brief main function
+ **     Parses and validates a config and writes it as C source
+ **
+ ** @param arguments: source path and config file
+ **
+ ** @return 0 on success, 1 on failure
+******************************************************************************/
+int main(int argc, char *argv[])
+{
+    intConfig_t config = {.lightSets = UNUSED_CONFIG};
+    char* output = NULL;
+    FILE* file;
+    int opt;
+
+    while((opt = getopt(argc, argv, "o:")) != -1)
+    {
+        if(opt == 'o')
+        {
+            output = optarg;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(!output || (optind != argc - 1))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    //the build fails rather than falling back to the defaults
+    if((CFG_load(&config, argv[optind]) != ERR_success) || (CFG_validate(&config) != ERR_success))
+    {
+        printf("Failed to generate a config from %s\n", argv[optind]);
+        return 1;
+    }
+
+    file = fopen(output, "w");
+    if(!file)
+    {
+        printf("Failed to open %s\n", output);
+        return 1;
+    }
+    writeSource(file, &config, argv[optind]);
+    if(ferror(file) | fclose(file))
+    {
+        printf("Failed to write %s\n", output);
+        remove(output);
+        return 1;
+    }
+
+    printf("Wrote %s from %s\n", output, argv[optind]);
+
+    return 0;
+}